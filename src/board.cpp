@@ -21,6 +21,7 @@
 #include "animation.h"
 #include "pointconverter.h"
 #include "entities/userentity.h"
+#include "latency.h"
 #include "mainanimation.h"
 #include "premove.h"
 #include "constrainedtext.h"
@@ -36,6 +37,7 @@ Board::Board(const AnimationSettings& animSettings, KGameCanvasAbstract* parent)
 , m_flipped(false)
 , m_square_size(0)
 , m_border_size(0)
+, m_approximate_sprites(false)
 , m_sprites(0,0)
 , m_hinting_pos(Point::invalid())
 , selection(Point::invalid())
@@ -45,6 +47,7 @@ Board::Board(const AnimationSettings& animSettings, KGameCanvasAbstract* parent)
 , m_anim_settings(animSettings) {
 
   m_main_animation = new MainAnimation( 1.0 );
+  m_loader.setRenderedNotifier(this, SLOT(onSpritesRendered()));
 
   m_tags = BoardTagsPtr(new BoardTags);
 
@@ -117,6 +120,7 @@ void Board::updateBackground() {
 
 void Board::enqueue(const shared_ptr<Animation>& anim) {
   m_main_animation->addAnimation(anim);
+  Latency::instance().mark(Latency::AnimationEnqueue);
 }
 
 void Board::adjustSprite(const Point& p, bool immediate) {
@@ -271,6 +275,14 @@ QPixmap Board::loadSprite(const QString& id) {
   return m_loader.piecePixmap(id, m_flipped);
 }
 
+QPixmap Board::loadSpriteAsync(const QString& id) {
+  bool exact;
+  QPixmap pix = m_loader.piecePixmapAsync(id, m_flipped, &exact);
+  if (!exact)
+    m_approximate_sprites = true;
+  return pix;
+}
+
 QRect Board::computeRect(Point p) const {
   QPoint realPoint = converter()->toReal(p);
   return squareRect(realPoint.x(), realPoint.y());
@@ -322,13 +334,15 @@ void Board::cancelPremove() {
 }
 
 void Board::updateSprites() {
+  m_approximate_sprites = false;
+
   // adjust piece positions
   for (Point i = m_sprites.first(); i <= m_sprites.last(); i = m_sprites.next(i)) {
     boost::shared_ptr<Sprite> p = m_sprites[i].sprite();
 
     if (p) {
       // drawing sprite
-      p->setPixmap(loadSprite(m_sprites[i].name()));
+      p->setPixmap(loadSpriteAsync(m_sprites[i].name()));
       adjustSprite(i, true);
     }
   }
@@ -541,12 +555,11 @@ void Board::onMouseMove(const QPoint& pos, int /*button*/) {
       m_drag_info->sprite->moveTo(pos - QPoint(m_square_size / 2, m_square_size / 2) );
 
     // highlight valid moves
-    NormalUserMove move = m_entity.lock()->createMove(m_drag_info->from,  point);
     bool valid = m_sprites.valid(point);
     if (valid) {
       InteractionType action = m_entity.lock()->validTurn(m_drag_info->from);
       if (action == Moving)
-        valid = m_entity.lock()->testMove(move);
+        valid = legalMove(m_drag_info->from, point);
     }
 
     if (valid)
@@ -560,27 +573,19 @@ void Board::onMouseMove(const QPoint& pos, int /*button*/) {
 
     AbstractPiece::Ptr hint;
 
-    if (m_sprites.valid(point)) {
-      if (AbstractMove::Ptr move = m_entity.lock()->testMove(
-                              m_entity.lock()->createMove(Point::invalid(), point))) {
-        // set move hint
-        hint = m_entity.lock()->moveHint(move);
-      }
-    }
+    if (m_sprites.valid(point))
+      hint = oneClickHint(point);
 
     updateHinting(point, hint);
   }
 }
 
 void Board::onPositionChanged() {
-  if (m_entity.lock() && m_entity.lock()->oneClickMoves() && m_sprites.valid(m_hinting_pos)) {
-    AbstractPiece::Ptr hint;
+  m_move_table.clear();
+  updateMoveTable();
 
-    if (AbstractMove::Ptr move = m_entity.lock()->testMove(
-                            m_entity.lock()->createMove(Point::invalid(), m_hinting_pos))) {
-      // set move hint
-      hint = m_entity.lock()->moveHint(move);
-    }
+  if (m_entity.lock() && m_entity.lock()->oneClickMoves() && m_sprites.valid(m_hinting_pos)) {
+    AbstractPiece::Ptr hint = oneClickHint(m_hinting_pos);
 
     updateHinting(m_hinting_pos, hint);
   }
@@ -642,7 +647,97 @@ void Board::updateHinting(Point pt, AbstractPiece::Ptr piece) {
   }
 }
 
+bool Board::updateMoveTable() {
+  boost::shared_ptr<UserEntity> entity = m_entity.lock();
+  if (!entity || !entity->position())
+    return false;
+
+  AbstractPosition::Ptr position = entity->position();
+  if (m_move_table.bound(position->hash(), gridSize()))
+    return true;
+  m_move_table.bind(position->hash(), gridSize());
+
+  std::vector<NormalUserMove> moves;
+  std::vector<DropUserMove> drops;
+  if (!entity->legalMoves(moves, drops))
+    return true; // sources will be filled one at a time
+
+  for (unsigned int i = 0; i < moves.size(); i++)
+    m_move_table.setLegal(m_move_table.source(moves[i].from), moves[i].to);
+
+  for (unsigned int i = 0; i < drops.size(); i++) {
+    const DropUserMove& drop = drops[i];
+    m_move_table.setLegal(MoveTable::dropSource(drop.pool, drop.piece_index), drop.to);
+
+    // identical pieces of a pool are listed once
+    AbstractPool::Ptr pool = position->pool(drop.pool);
+    if (!pool)
+      continue;
+    AbstractPiece::Ptr piece = pool->get(drop.piece_index);
+    for (int j = drop.piece_index + 1; j < pool->size() && piece && piece->equals(pool->get(j)); j++)
+      m_move_table.setLegal(MoveTable::dropSource(drop.pool, j), drop.to);
+  }
+  m_move_table.setComplete();
+
+  if (entity->oneClickMoves()) {
+    MoveTable::Source source = m_move_table.source(Point::invalid());
+    for (Point p = m_sprites.first(); p <= m_sprites.last(); p = m_sprites.next(p)) {
+      if (!m_move_table.legal(source, p))
+        continue;
+      if (AbstractMove::Ptr move = entity->testMove(entity->createMove(Point::invalid(), p)))
+        m_move_table.setHint(p, entity->moveHint(move));
+    }
+  }
+
+  return true;
+}
+
+bool Board::legalMove(const Point& from, const Point& to) {
+  if (!updateMoveTable())
+    return false;
+
+  MoveTable::Source source = m_move_table.source(from);
+  if (!m_move_table.contains(source)) {
+    // try all targets at once, so that further queries are lookups
+    boost::shared_ptr<UserEntity> entity = m_entity.lock();
+    m_move_table.addSource(source);
+    for (Point p = m_sprites.first(); p <= m_sprites.last(); p = m_sprites.next(p)) {
+      if (AbstractMove::Ptr move = entity->testMove(entity->createMove(from, p))) {
+        m_move_table.setLegal(source, p);
+        if (from == Point::invalid())
+          m_move_table.setHint(p, entity->moveHint(move));
+      }
+    }
+  }
+
+  return m_move_table.legal(source, to);
+}
+
+AbstractPiece::Ptr Board::oneClickHint(const Point& to) {
+  if (!legalMove(Point::invalid(), to))
+    return AbstractPiece::Ptr();
+  return m_move_table.hint(to);
+}
+
+bool Board::legalDrop(int pool, int index, const Point& to) {
+  if (!updateMoveTable())
+    return false;
+
+  MoveTable::Source source = MoveTable::dropSource(pool, index);
+  if (!m_move_table.contains(source)) {
+    boost::shared_ptr<UserEntity> entity = m_entity.lock();
+    m_move_table.addSource(source);
+    for (Point p = m_sprites.first(); p <= m_sprites.last(); p = m_sprites.next(p)) {
+      if (entity->testMove(entity->createDrop(pool, index, p)))
+        m_move_table.setLegal(source, p);
+    }
+  }
+
+  return m_move_table.legal(source, to);
+}
+
 void Board::reset() {
+  m_move_table.clear();
   clearTags();
   cancelSelection();
   cancelPremove();
@@ -653,12 +748,13 @@ void Board::flip(bool flipped)
 {
   if (m_flipped != flipped) {
     m_flipped = flipped;
+    m_approximate_sprites = false;
 
     // update sprite positions
     for (Point i = m_sprites.first(); i <= m_sprites.last(); i = m_sprites.next(i)) {
       SpritePtr p = m_sprites[i].sprite();
       if (p) {
-        p->setPixmap(loadSprite(m_sprites[i].name()));
+        p->setPixmap(loadSpriteAsync(m_sprites[i].name()));
         adjustSprite(i, true);
       }
     }
@@ -668,20 +764,30 @@ void Board::flip(bool flipped)
   }
 }
 
+void Board::onSpritesRendered() {
+  if (!m_approximate_sprites)
+    return;
+  m_approximate_sprites = false;
+
+  // only the pixmaps change, positions are already right
+  for (Point i = m_sprites.first(); i <= m_sprites.last(); i = m_sprites.next(i)) {
+    SpritePtr p = m_sprites[i].sprite();
+    if (p)
+      p->setPixmap(loadSpriteAsync(m_sprites[i].name()));
+  }
+}
+
 void Board::draggingOn(int pool, int index, const QPoint& point) {
   Point to = converter()->toLogical(point);
 
   if (m_sprites.valid(to))
   switch(m_entity.lock()->validTurn(pool)) {
-    case Moving: {
-      DropUserMove m = m_entity.lock()->createDrop(pool, index, to);
-      AbstractMove::Ptr mv = m_entity.lock()->testMove(m);
-      if (mv) {
+    case Moving:
+      if (legalDrop(pool, index, to)) {
         setTags("validmove", to);
         return;
       }
       break;
-    }
 
     case Premoving:
       setTags("validmove", to);
@@ -21,6 +21,7 @@
 #include "entities/userentity.h"
 #include "common.h"
 #include "grid.h"
+#include "movetable.h"
 #include "usermove.h"
 #include "mainanimation.h"
 #include "pointconverter.h"
@@ -97,6 +98,9 @@ private:
   /** loader class, to load pieces */
   PixmapLoader m_loader;
 
+  /** whether some sprites show scaled pixmaps, waiting for the exact ones */
+  bool m_approximate_sprites;
+
   /** main animation structure */
   MainAnimation* m_main_animation;
 
@@ -106,6 +110,9 @@ private:
   /** displayed m_sprites */
   PieceGrid   m_sprites;
 
+  /** legal targets and hints in the displayed position, used for drag feedback */
+  MoveTable   m_move_table;
+
   /** the visual move hint */
   NamedSprite m_hinting;
   Point m_hinting_pos;
@@ -172,6 +179,9 @@ private:
   /** this internal function updates the sprites after the board has been resized  */
   void updateSprites();
 
+  /** load a sprite without waiting for the theme, remembering if it is approximate */
+  QPixmap loadSpriteAsync(const QString& id);
+
   /** this internal function updates the tags after the board has been resized  */
   void updateTags();
 
@@ -188,6 +198,18 @@ private:
   /** this function tries to notify the move to the entity */
   bool doMove(const NormalUserMove&);
 
+  /** fills the move table for the displayed position if needed, returns false if there is none */
+  bool updateMoveTable();
+
+  /** returns true if moving from @a from to @a to is legal, @a from can be invalid for one-click moves */
+  bool legalMove(const Point& from, const Point& to);
+
+  /** returns true if dropping the piece @a index of @a pool on @a to is legal */
+  bool legalDrop(int pool, int index, const Point& to);
+
+  /** returns the piece hinting the one-click move to @a to, or a null pointer */
+  AbstractPiece::Ptr oneClickHint(const Point& to);
+
 public:
   /** constructor, requires the canvas parent */
   Board(const AnimationSettings& animSettings, KGameCanvasAbstract* parent);
@@ -267,7 +289,10 @@ public:
   void adjustSprite(const Point& p, bool immediate = false);
 
   /** sets the controlling entity */
-  inline void setEntity(const boost::shared_ptr<UserEntity>& entity) { m_entity = entity; }
+  inline void setEntity(const boost::shared_ptr<UserEntity>& entity) {
+    m_entity = entity;
+    m_move_table.clear();
+  }
 
 
   /** Notifies to the board that a certain piece is being dragged over the board */
@@ -301,6 +326,10 @@ public:
   /** resets all tags and stops all animations */
   void reset();
 
+private Q_SLOTS:
+  /** replaces approximate sprites with the pieces rendered in background */
+  void onSpritesRendered();
+
 Q_SIGNALS:
   void error(ErrorCode code);
 };
@@ -9,36 +9,127 @@
 */
 
 #include "connection.h"
+#include <string.h>
 #include <QHostInfo>
 #include <QTextStream>
 #include <QTcpSocket>
-#include <QTextStream>
 #include <QFile>
+#include <QMutex>
+#include <QThread>
+#include <QTime>
+#include <QWaitCondition>
 #include <KDebug>
 #include <KProcess>
 #include "common.h"
-#include "settings.h"
+#include "latency.h"
+#include "mastersettings.h"
+#include "replaydevice.h"
+
+/**
+  * A log file written by a thread of its own, so that
+  * the connection never waits for the disk.
+  */
+class Connection::Log : public QThread {
+  QFile m_file;
+  QMutex m_mutex;
+  QWaitCondition m_wait;
+  QByteArray m_pending;
+  bool m_quit;
+  QTime m_clock;
+public:
+  Log(const QString& file_name)
+  : m_file(file_name)
+  , m_quit(false) { }
+
+  /** \return The milliseconds elapsed since the log was opened */
+  int elapsed() const { return m_clock.elapsed(); }
+
+  /** stop the thread, after all queued data has been written */
+  ~Log();
+
+  bool open();
+
+  /** queue @a data for writing */
+  void write(const QByteArray& data);
+
+  virtual void run();
+};
+
+Connection::Log::~Log() {
+  {
+    QMutexLocker lock(&m_mutex);
+    m_quit = true;
+    m_wait.wakeAll();
+  }
+  wait();
+  m_file.close();
+}
+
+bool Connection::Log::open() {
+  if (!m_file.open(QIODevice::WriteOnly))
+    return false;
+  m_clock.start();
+  start(QThread::LowPriority);
+  return true;
+}
+
+void Connection::Log::write(const QByteArray& data) {
+  QMutexLocker lock(&m_mutex);
+  m_pending += data;
+  m_wait.wakeOne();
+}
+
+void Connection::Log::run() {
+  QByteArray data;
+  forever {
+    {
+      QMutexLocker lock(&m_mutex);
+      while (!m_quit && m_pending.isEmpty())
+        m_wait.wait(&m_mutex);
+      if (m_pending.isEmpty())
+        return;
+      data = m_pending;
+      m_pending.clear();
+    }
+
+    m_file.write(data);
+    m_file.flush();
+  }
+}
+
+namespace {
+
+/** \return The text between @a begin and @a end, without carriage returns */
+QString decode(const char* begin, const char* end) {
+  QString res = QString::fromAscii(begin, end - begin);
+  if (memchr(begin, '\r', end - begin))
+    res.remove('\r');
+  return res;
+}
+
+}
 
 Connection::Connection()
 : m_device(NULL)
+, m_log(NULL)
 , m_connected(false)
 , m_initialized(false) {
-  QString logFileName;
+  QString logFileName = settings().group("ics")["logFile"] | "";
   if (!logFileName.isEmpty()) {
-    logFile = new QFile(logFileName);
-    logFile->open(QIODevice::WriteOnly);
-    logStream = 0; //= new QTextStream(logFile);
+    m_log = new Log(logFileName);
+    if (!m_log->open()) {
+      kError() << "Cannot open connection log" << logFileName;
+      delete m_log;
+      m_log = NULL;
+    }
   }
-  else
-    logStream = 0;
 }
 
 Connection::~Connection() {
-  if (logStream) {
-    delete logStream;
-    logFile->close();
-    delete logFile;
-  }
+  if (Latency::instance().histogram(Latency::SocketRead).count())
+    kDebug() << "ICS latency:\n" << Latency::instance().report();
+
+  delete m_log;
   if (m_device) {
     KProcess* p = qobject_cast<KProcess*>(m_device);
     if (p)
@@ -61,6 +152,19 @@ void Connection::establish(const char* host, quint16 port,
   m_helper = helper;
   m_helper_cmd = helper_cmd;
 
+  // play a recorded session back instead, to test without a server
+  QString replay = settings().group("ics")["replayLog"] | "";
+  if (!replay.isEmpty()) {
+    m_device = NULL;
+    ReplayDevice* device = new ReplayDevice(ReplayDevice::RecordedSpeed, this);
+    if (device->load(replay)) {
+      establish(device);
+      device->start();
+      return;
+    }
+    delete device;
+  }
+
   if (helper.isEmpty()) {
     QTcpSocket *s = new QTcpSocket(this);
     s->setObjectName("IcsSocket");
@@ -89,6 +193,20 @@ void Connection::establish(const char* host, quint16 port,
   connect(m_device, SIGNAL(readyRead()), this, SLOT(processLine()));
 }
 
+void Connection::establish(QIODevice* device) {
+  if (m_device) {
+    KProcess* p = qobject_cast<KProcess*>(m_device);
+    if (p)
+      p->kill();
+    delete m_device;
+  }
+
+  m_device = device;
+  m_connected = true;
+  connect(m_device, SIGNAL(readyRead()), this, SLOT(processLine()));
+  established();
+}
+
 void Connection::lookedUp(const QHostInfo &hi) {
   KProcess* p = m_device ? qobject_cast<KProcess*>(m_device) : NULL;
   if (p) {
@@ -106,8 +224,8 @@ void Connection::lookedUp(const QHostInfo &hi) {
       QTextStream os(m_device);
       os << m_unsent_text;
   
-      if (logStream)
-        (*logStream) << "> " << m_unsent_text;
+      if (m_log)
+        m_log->write("> " + m_unsent_text.toAscii());
       m_unsent_text = QString();
     }
   }
@@ -119,26 +237,52 @@ void Connection::processLine() {
     return;
   }
 
-  while (m_device->canReadLine()) {
-    QString line = m_device->readLine();
-    line = buffer + line.replace("\r", "");
-    receivedLine(line, buffer.length());
-    if (logStream)
-      (*logStream) << "< " << line << "\n";
-    buffer = "";
+  qint64 size = m_device->bytesAvailable();
+  if (size <= 0)
+    return;
+
+  Latency& latency = Latency::instance();
+  latency.arrive();
+
+  // read everything at once, in a buffer that only grows
+  if (m_input.size() < size)
+    m_input.resize(size);
+  size = m_device->read(m_input.data(), size);
+  if (size <= 0) {
+    latency.done();
+    return;
   }
+  latency.mark(Latency::SocketRead);
 
-  int size;
-  if ((size = m_device->bytesAvailable()) > 0) {
-    char* data = new char[size + 1];
-    m_device->read(data, size);
-    data[size] = '\0';
-    int offset = buffer.length();
-    buffer += QString(data).replace("\r", "");
-    delete[] data;
+  const char* data = m_input.constData();
+  const char* end = data + size;
+
+  QStringList lines;
+  int offset = buffer.length();
+  while (const char* newline = static_cast<const char*>(memchr(data, '\n', end - data))) {
+    lines << buffer + decode(data, newline + 1);
+    buffer.clear();
+    data = newline + 1;
+  }
+  latency.mark(Latency::LineFraming);
+
+  if (!lines.isEmpty()) {
+    receivedLines(lines, offset);
+    if (m_log) {
+      QByteArray log = "@ " + QByteArray::number(m_log->elapsed()) + "\n";
+      for (int i = 0; i < lines.size(); i++)
+        log += "< " + lines[i].toAscii() + "\n";
+      m_log->write(log);
+    }
+    offset = 0;
+  }
 
+  if (data < end) {
+    buffer += decode(data, end);
     receivedText(buffer, offset);
   }
+
+  latency.done();
 }
 
 void Connection::sendText(const QString& text) {
@@ -156,8 +300,25 @@ void Connection::sendText(const QString& text) {
   QTextStream os(m_device);
   os << text << "\n";
 
-  if (logStream)
-    (*logStream) << "> " << text << "\n";
+  if (m_log)
+    m_log->write("> " + text.toAscii() + "\n");
+}
+
+bool Connection::sendTextNow(const QString& text) {
+  if (!m_connected || !m_device)
+    return false;
+
+  m_device->write(text.toAscii() + "\n");
+
+  // sockets and processes would otherwise write only when back in the event loop
+  if (QAbstractSocket* socket = qobject_cast<QAbstractSocket*>(m_device))
+    socket->flush();
+  else if (KProcess* process = qobject_cast<KProcess*>(m_device))
+    process->waitForBytesWritten(0);
+
+  if (m_log)
+    m_log->write("> " + text.toAscii() + "\n");
+  return true;
 }
 
 
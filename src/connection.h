@@ -11,27 +11,33 @@
 #ifndef CONNECTION_H
 #define CONNECTION_H
 
+#include <QByteArray>
 #include <QObject>
+#include <QStringList>
 
-class QTextStream;
 class QIODevice;
-class QFile;
 class QHostInfo;
 
 /**
   * @brief Manage a connection with a remote server.
   *
   * This class can be used to manage a connection with a chess server. Once connected,
-  * it emits the signal @ref receivedLine whenever a new whole line is received.
+  * it emits the signal @ref receivedLines with all the whole lines received at once.
   * Partial lines are kept in an internal buffer.
   * The Connection class supports the use of a helper such as timeseal.
   */
 class Connection : public QObject {
 Q_OBJECT
+  class Log;
+
   QIODevice* m_device;
   QString buffer;
-  QFile* logFile;
-  QTextStream* logStream;
+
+  /** raw data read from the device, reused across reads */
+  QByteArray m_input;
+
+  /** written in a thread of its own, NULL if logging is disabled */
+  Log* m_log;
   bool m_connected;
   bool m_initialized;
   QString m_unsent_text;
@@ -65,6 +71,12 @@ public:
   void establish(const char* host, quint16 port,
                   const QString& helper, const QString& args);
 
+  /**
+    * Use @a device, such as a ReplayDevice, in place of a connection
+    * to a server. The connection takes ownership of @a device.
+    */
+  void establish(QIODevice* device);
+
   /**
     * Whether the connection has been initialized.
     */
@@ -83,6 +95,14 @@ public Q_SLOTS:
   void sendText(const QString&);
   void lookedUp(const QHostInfo &host);
 
+protected:
+  /**
+    * Write @a text and a newline to the server right away, without reading
+    * pending data first, and push it out of the device buffers.
+    * \return Whether the text could be written.
+    */
+  bool sendTextNow(const QString& text);
+
 protected Q_SLOTS:
   /**
     * Read data from the socket and appropriate signals.
@@ -106,14 +126,15 @@ Q_SIGNALS:
   void receivedText(QString text, int newDataOffset);
 
   /**
-    * Emitted when a full line is received.
+    * Emitted when one or more full lines are received.
     *
-    * @param line Received line.
-    * @param newDataOffset Offset where new data starts.
+    * @param lines Received lines, in order.
+    * @param newDataOffset Offset where new data starts in the first line.
+    *        The other lines are entirely new.
     *
     * @sa receivedText
     */
-  void receivedLine(QString line, int newDataOffset);
+  void receivedLines(QStringList lines, int newDataOffset);
 };
 
 #endif // CONNECTION_H
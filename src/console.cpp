@@ -280,6 +280,11 @@ void Console::displayText(QString text, int offset) {
   }
 }
 
+void Console::displayLines(QStringList lines, int offset) {
+  for (int i = 0; i < lines.size(); i++)
+    displayText(lines[i], i == 0 ? offset : 0);
+}
+
 void Console::clear() {
   display->clear();
 }
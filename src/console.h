@@ -13,6 +13,7 @@
 
 #include <QWidget>
 #include <QRegExp>
+#include <QStringList>
 #include <boost/shared_ptr.hpp>
 #include "histlineedit.h"
 #include "console_p.h"
@@ -36,6 +37,7 @@ public:
   void setNotifier(const boost::shared_ptr<TextNotifier>& notifier) { m_notifier = notifier; }
 public Q_SLOTS:
   void displayText(QString, int offset);
+  void displayLines(QStringList, int offset);
   void echo(const QString&);
 protected Q_SLOTS:
   void input(const QString&);
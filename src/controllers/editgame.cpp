@@ -195,6 +195,7 @@ void EditGameController::removeEntity(const EntityToken& token) {
 bool EditGameController::addICSPlayer(int side, int game_number, const shared_ptr<ICSConnection>& connection) {
   Q_ASSERT(side == 0 || side == 1);
   if (m_players[side]->canDetach()) {
+    m_game->setServerDriven();
     shared_ptr<ICSEntity> entity(new ICSEntity(m_variant, m_game,
                                 side, game_number, connection, &m_agents));
 
@@ -204,6 +205,8 @@ bool EditGameController::addICSPlayer(int side, int game_number, const shared_pt
 
       m_players[side] = entity;
       connection->setListener(game_number, entity);
+      if (shared_ptr<GameEntity> game_entity = dynamic_pointer_cast<GameEntity>(m_entity))
+        game_entity->setPremoveConnection(connection, game_number);
 
       entity->setupTurnTest(m_entity->turnTest());
       m_view->flip(m_players[1] == m_entity); // flip if we're black!
@@ -227,6 +230,7 @@ bool EditGameController::setExaminationMode(int game_number, const shared_ptr<IC
   kDebug() << "[controller " << this << "] setting examination mode";
   if (m_players[0]->canDetach() &&
       m_players[1]->canDetach()) {
+    m_game->setServerDriven();
     shared_ptr<ExaminationEntity> entity(new ExaminationEntity(m_variant, m_game,
                                               game_number, connection, &m_agents));
     if (entity->attach()) {
@@ -254,6 +258,7 @@ bool EditGameController::setExaminationMode(int game_number, const shared_ptr<IC
 bool EditGameController::setObserveMode(int game_number, const shared_ptr<ICSConnection>& connection) {
   if (m_players[0]->canDetach() &&
       m_players[1]->canDetach()) {
+    m_game->setServerDriven();
     shared_ptr<ICSEntity> entity(new ObservingEntity(m_variant, m_game,
                                     game_number, connection, &m_agents));
 
@@ -44,6 +44,9 @@ AbstractMove::Ptr ExaminationEntity::testMove(const NormalUserMove&) const {
 AbstractMove::Ptr ExaminationEntity::testMove(const DropUserMove&) const {
   return AbstractMove::Ptr();
 }
+bool ExaminationEntity::legalMoves(std::vector<NormalUserMove>&, std::vector<DropUserMove>&) const {
+  return true; // no move is accepted
+}
 
 bool ExaminationEntity::testPremove(const NormalUserMove&) const { return false; }
 bool ExaminationEntity::testPremove(const DropUserMove&) const { return false; }
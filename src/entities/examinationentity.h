@@ -37,6 +37,7 @@ public:
 
   virtual AbstractMove::Ptr testMove(const NormalUserMove&) const;
   virtual AbstractMove::Ptr testMove(const DropUserMove&) const;
+  virtual bool legalMoves(std::vector<NormalUserMove>&, std::vector<DropUserMove>&) const;
   virtual bool testPremove(const NormalUserMove&) const;
   virtual bool testPremove(const DropUserMove&) const;
   virtual void executeMove(boost::shared_ptr<AbstractMove>);
@@ -13,6 +13,8 @@
 #include "game.h"
 #include "board.h"
 #include "pgnparser.h"
+#include "icsconnection.h"
+#include "latency.h"
 
 using namespace boost;
 
@@ -21,7 +23,8 @@ GameEntity::GameEntity(const VariantPtr& variant, const boost::shared_ptr<Game>&
 : UserEntity(game)
 , m_variant(variant)
 , m_chessboard(chessboard)
-, m_dispatcher(group, this) {
+, m_dispatcher(group, this)
+, m_premove_game_number(-1) {
 }
 
 QString GameEntity::save() const {
@@ -48,30 +51,48 @@ void GameEntity::executeMove(AbstractMove::Ptr move) {
   m_dispatcher.move(m_game->index());
 }
 
+void GameEntity::setPremoveConnection(const shared_ptr<ICSConnection>& connection, int gameNumber) {
+  m_premove_connection = connection;
+  m_premove_game_number = gameNumber;
+}
+
 void GameEntity::addPremove(const NormalUserMove& m) {
   m_premoveQueue = shared_ptr<Premove>(new Premove(m_variant->createNormalMove(m)));
+  if (shared_ptr<ICSConnection> connection = m_premove_connection.lock())
+    connection->setPremove(m_premove_game_number, m_premoveQueue);
 }
 
 void GameEntity::addPremove(const DropUserMove& m) {
   m_premoveQueue = shared_ptr<Premove>(new Premove(m_variant->createDropMove(m)));
+  if (shared_ptr<ICSConnection> connection = m_premove_connection.lock())
+    connection->setPremove(m_premove_game_number, m_premoveQueue);
 }
 
 void GameEntity::cancelPremove() {
   m_premoveQueue.reset();
+  if (shared_ptr<ICSConnection> connection = m_premove_connection.lock())
+    connection->setPremove(m_premove_game_number, shared_ptr<Premove>());
   m_chessboard->cancelPremove();
 }
 
 void GameEntity::notifyMove(const Index&) {
   // the other player moved: execute premove
+  // (on a server, the connection has sent it already)
   if (m_premoveQueue) {
     AbstractMove::Ptr move = m_premoveQueue->execute(m_game->position());
-    if (move)
+    if (move) {
       executeMove(move);
+      Latency::instance().mark(Latency::PremoveReconcile);
+    }
   }
   cancelPremove();
 }
 
-void GameEntity::notifyBack() { }
+void GameEntity::notifyBack() {
+  // the premove was meant for a position that has been taken back
+  cancelPremove();
+}
+
 void GameEntity::notifyForward() { }
 void GameEntity::notifyGotoFirst() { }
 void GameEntity::notifyGotoLast() { }
@@ -98,6 +119,10 @@ AbstractMove::Ptr GameEntity::testMove(const DropUserMove& move) const {
     return AbstractMove::Ptr ();
 }
 
+bool GameEntity::legalMoves(std::vector<NormalUserMove>& moves, std::vector<DropUserMove>& drops) const {
+  return position()->legalMoves(moves, drops);
+}
+
 AbstractPiece::Ptr GameEntity::moveHint(AbstractMove::Ptr move) const {
   return position()->moveHint(move);
 }
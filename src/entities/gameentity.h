@@ -11,12 +11,14 @@
 #ifndef GAMEENTITY_H
 #define GAMEENTITY_H
 
+#include <boost/weak_ptr.hpp>
 #include "userentity.h"
 #include "agent.h"
 #include "agentgroup.h"
 #include "fwd.h"
 
 class Board;
+class ICSConnection;
 
 class GameEntity : public UserEntity {
   VariantPtr m_variant;
@@ -24,6 +26,10 @@ class GameEntity : public UserEntity {
   AgentGroupDispatcher m_dispatcher;
   boost::shared_ptr<class Premove> m_premoveQueue;
 
+  /** the connection sending our premoves, if playing on a server */
+  boost::weak_ptr<ICSConnection> m_premove_connection;
+  int m_premove_game_number;
+
   AbstractPosition::Ptr doMove(AbstractMove::Ptr move) const;
 public:
   GameEntity(const VariantPtr& variant, const boost::shared_ptr<Game>& game,
@@ -39,6 +45,12 @@ public:
     */
   virtual void loadPGN(const PGN& pgn);
 
+  /**
+    * Let @a connection send premoves for game @a gameNumber as soon
+    * as they are allowed, without waiting for this entity.
+    */
+  void setPremoveConnection(const boost::shared_ptr<ICSConnection>& connection, int gameNumber);
+
   virtual void executeMove(AbstractMove::Ptr move);
   virtual void addPremove(const NormalUserMove& m);
   virtual void addPremove(const DropUserMove& m);
@@ -54,6 +66,7 @@ public:
   virtual NormalUserMove createMove(const Point& from, const Point& to) const;
   virtual AbstractMove::Ptr testMove(const NormalUserMove&) const;
   virtual AbstractMove::Ptr testMove(const DropUserMove&) const;
+  virtual bool legalMoves(std::vector<NormalUserMove>&, std::vector<DropUserMove>&) const;
   virtual AbstractPiece::Ptr moveHint(AbstractMove::Ptr move) const;
   virtual bool testPremove(const NormalUserMove&) const;
   virtual bool testPremove(const DropUserMove&) const;
@@ -15,6 +15,7 @@
 #include "positioninfo.h"
 #include "poolinfo.h"
 #include "icsapi.h"
+#include "latency.h"
 
 using namespace boost;
 
@@ -88,11 +89,14 @@ void ICSEntity::updateGame(const Index& index, AbstractMove::Ptr icsMove,
     }
   }
   
-  if (m_game->lastMainlineIndex() > index)
+  bool back = m_game->lastMainlineIndex() > index;
+  if (back)
     m_game->truncate(index);
 
   m_game->insert(icsMove, icsPos, index);
   m_game->goTo(index);
+  if (back)
+    m_dispatcher.back();
   m_dispatcher.move(index);
 }
 
@@ -136,7 +140,11 @@ void ICSEntity::notifyStyle12(const PositionInfo& style12, bool is_starting) {
         && (!m_game->containsIndex(style12.index() - 1) || !m_game->position(style12.index() - 1)) )
     requestMoves();
 
+  // the user entity plays the premove while the game is updated
+  m_sent_premove = style12.sentPremove;
   updateGame(style12.index(), last_move, style12.position);
+  m_sent_premove.reset();
+  Latency::instance().mark(Latency::EntityUpdate);
 }
 
 void ICSEntity::notifyPool(const PoolInfo& pi) {
@@ -190,6 +198,14 @@ bool ICSEntity::attach() {
 }
 
 void ICSEntity::notifyMove(const Index& index) {
+  if (m_sent_premove) {
+    AbstractMove::Ptr move = m_game->move(index);
+    if (move && move->equals(m_sent_premove)) {
+      m_sent_premove.reset();
+      return;
+    }
+  }
+
   if (!canEdit()) {
     m_connection->sendText(m_game->move(index)->toString(
       "simple", m_game->position(index.prev())));
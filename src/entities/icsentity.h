@@ -33,6 +33,9 @@ protected:
   bool m_editing_mode;
   AgentGroupDispatcher m_dispatcher;
 
+  /** a premove the connection already sent, not to be sent again */
+  AbstractMove::Ptr m_sent_premove;
+
   void updateGame(const Index& index, AbstractMove::Ptr icsMove,
                                  AbstractPosition::Ptr icsPos);
 
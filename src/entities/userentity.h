@@ -48,6 +48,13 @@ public:
   
   virtual AbstractMove::Ptr testMove(const NormalUserMove& m) const = 0;
   virtual AbstractMove::Ptr testMove(const DropUserMove& m) const = 0;
+
+  /**
+    * Collect the moves and drops testMove would accept.
+    * \return false if they cannot be listed, so that they
+    *         have to be tested one at a time.
+    */
+  virtual bool legalMoves(std::vector<NormalUserMove>&, std::vector<DropUserMove>&) const { return false; }
   
   virtual bool testPremove(const NormalUserMove& m) const = 0;
   virtual bool testPremove(const DropUserMove&) const = 0;
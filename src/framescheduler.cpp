@@ -0,0 +1,111 @@
+/*
+  Copyright (c) 2006 Paolo Capriotti <p.capriotti@gmail.com>
+            (c) 2006 Maurizio Monge <maurizio.monge@kdemail.net>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#include "framescheduler.h"
+#include <algorithm>
+#include "mainanimation.h"
+
+FrameScheduler::FrameScheduler()
+: m_interval(1000000 / 60)
+, m_next_frame(0)
+, m_frames(0)
+, m_dropped_frames(0) {
+  m_timer.setSingleShot(true);
+  connect(&m_timer, SIGNAL(timeout()), this, SLOT(frame()));
+}
+
+FrameScheduler& FrameScheduler::instance() {
+  static FrameScheduler scheduler;
+  return scheduler;
+}
+
+void FrameScheduler::attach(MainAnimation* animation) {
+  if (std::find(m_clients.begin(), m_clients.end(), animation) != m_clients.end())
+    return;
+  m_clients.push_back(animation);
+
+  if (m_next_frame == 0) {
+    // waking up: start a new frame sequence, but let the event loop
+    // handle what is pending first, so that it ends up in the same frame
+    m_next_frame = Latency::now();
+    m_timer.start(0);
+  }
+}
+
+void FrameScheduler::detach(MainAnimation* animation) {
+  std::vector<MainAnimation*>::iterator it =
+    std::find(m_clients.begin(), m_clients.end(), animation);
+  if (it != m_clients.end())
+    m_clients.erase(it);
+
+  if (m_clients.empty()) {
+    m_timer.stop();
+    m_next_frame = 0;
+  }
+}
+
+void FrameScheduler::setFrameInterval(double msec) {
+  m_interval = qMax<qint64>(1000, qint64(msec * 1000));
+}
+
+void FrameScheduler::schedule(qint64 now) {
+  qint64 wait = m_next_frame - now;
+  m_timer.start(wait > 0 ? int((wait + 999) / 1000) : 0);
+}
+
+void FrameScheduler::frame() {
+  if (m_clients.empty()) {
+    m_next_frame = 0;
+    return;
+  }
+
+  qint64 start = Latency::now();
+
+  // a late frame takes the last slot it overlaps, the ones before are lost
+  if (start - m_next_frame >= m_interval) {
+    qint64 missed = (start - m_next_frame) / m_interval;
+    m_dropped_frames += missed;
+    m_next_frame += missed * m_interval;
+  }
+
+  // clients can come and go while advancing
+  std::vector<MainAnimation*> clients = m_clients;
+  for (unsigned int i = 0; i < clients.size(); i++) {
+    if (std::find(m_clients.begin(), m_clients.end(), clients[i]) == m_clients.end())
+      continue;
+    if (!clients[i]->frame(m_interval / 1000))
+      detach(clients[i]);
+  }
+
+  qint64 end = Latency::now();
+  m_frame_times.add(end - start);
+  m_frames++;
+
+  if (m_clients.empty())
+    return;
+
+  m_next_frame += m_interval;
+  schedule(end);
+}
+
+QString FrameScheduler::report() const {
+  return QString("%1 frames, %2 dropped, frame time mean %3 us, p99 %4 us, max %5 us")
+    .arg(m_frames)
+    .arg(m_dropped_frames)
+    .arg(m_frame_times.mean())
+    .arg(m_frame_times.quantile(0.99))
+    .arg(m_frame_times.max());
+}
+
+void FrameScheduler::clearStatistics() {
+  m_frames = 0;
+  m_dropped_frames = 0;
+  m_frame_times.clear();
+}
@@ -0,0 +1,81 @@
+/*
+  Copyright (c) 2006 Paolo Capriotti <p.capriotti@gmail.com>
+            (c) 2006 Maurizio Monge <maurizio.monge@kdemail.net>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+
+#include <vector>
+#include <QObject>
+#include <QTimer>
+#include "latency.h"
+
+class MainAnimation;
+
+/**
+  * @class FrameScheduler <framescheduler.h>
+  * @brief A single frame clock driving all running animations.
+  *
+  * Animations advance together, once per frame, so that all the canvas
+  * changes they make are repainted at once. Frames are aligned to a fixed
+  * interval: when a frame is late, the ones it overlaps are dropped
+  * instead of being run in a row. The timer only runs while some animation
+  * is active.
+  */
+class FrameScheduler : public QObject {
+Q_OBJECT
+  std::vector<MainAnimation*> m_clients;
+  QTimer m_timer;
+
+  /** frame length, in microseconds */
+  qint64 m_interval;
+  /** time of the next frame, 0 when idle */
+  qint64 m_next_frame;
+
+  quint64 m_frames;
+  quint64 m_dropped_frames;
+  Latency::Histogram m_frame_times;
+
+  void schedule(qint64 now);
+public:
+  FrameScheduler();
+
+  /**
+    * Advance @a animation at each frame, until it is empty.
+    * The first frame is run as soon as control returns to the event loop.
+    */
+  void attach(MainAnimation* animation);
+  void detach(MainAnimation* animation);
+
+  /** \return The frame length, in milliseconds */
+  double frameInterval() const { return m_interval / 1000.0; }
+
+  /** Set the frame length to @a msec milliseconds (default is 1000/60) */
+  void setFrameInterval(double msec);
+
+  /** \return The number of frames run */
+  quint64 frames() const { return m_frames; }
+
+  /** \return The number of frames skipped because the previous was late */
+  quint64 droppedFrames() const { return m_dropped_frames; }
+
+  /** \return The time taken by each frame to advance all animations, in microseconds */
+  const Latency::Histogram& frameTimes() const { return m_frame_times; }
+
+  /** \return A human readable summary of the frame statistics */
+  QString report() const;
+
+  void clearStatistics();
+
+  static FrameScheduler& instance();
+private Q_SLOTS:
+  void frame();
+};
+
+#endif // FRAMESCHEDULER_H
@@ -27,10 +27,59 @@
 
 using namespace GamePrivate;
 
+namespace {
+
+// the number of rebuilt positions to remember
+const unsigned int POSITION_CACHE_SIZE = 8;
+
+// the number of variation lines to remember
+const unsigned int LINE_CACHE_SIZE = 8;
+
+/**
+  * Move the entries of @a from, starting at @a begin, to the end of @a to.
+  * Entries are swapped into place, so their variations are never copied.
+  */
+void appendEntries(History& to, History& from, int begin) {
+  int n = (int)from.size() - begin;
+  if(n <= 0)
+    return;
+
+  if(to.capacity() < to.size() + n) {
+    // a reallocation would copy the entries already there
+    History res;
+    res.reserve(to.size() + n);
+    res.resize(to.size());
+    for(int i = 0; i < (int)to.size(); i++)
+      res[i].swap(to[i]);
+    to.swap(res);
+  }
+
+  int base = to.size();
+  to.resize(base + n);
+  for(int i = 0; i < n; i++)
+    to[base + i].swap(from[begin + i]);
+  from.erase(from.begin() + begin, from.end());
+}
+
+/**
+  * Exchange the line following entry @a at of @a vec with its variation @a v.
+  * Doing it twice restores the original tree.
+  */
+void flipVariation(History& vec, int at, int v) {
+  History tail;
+  appendEntries(tail, vec, at + 1);
+  History& var = vec[at].variations[v];
+  appendEntries(vec, var, 0);
+  var.swap(tail);
+}
+
+}
+
 
 Game::Game()
 : current(-1)
-, undo_pos(0) {
+, undo_pos(0)
+, checkpoint_interval(0) {
 }
 
 Game::~Game() {
@@ -76,22 +125,61 @@ const Entry* Game::fetch(const Index& ix) const {
 }
 
 History* Game::fetchRef(const Index& ix, int* idx) {
+  History* vec = &history;
+  int at = ix.num_moves;
+
+  if(!ix.nested.empty()) {
+    // all the positions of a variation line share its key
+    Index line = ix;
+    line.nested.back().num_moves = 0;
+
+    std::list<std::pair<Index, History*> >::iterator it = line_cache.begin();
+    while(it != line_cache.end() && it->first != line)
+      ++it;
+
+    if(it != line_cache.end()) {
+      line_cache.splice(line_cache.begin(), line_cache, it);
+      vec = it->second;
+    }
+    else {
+      vec = findLine(ix);
+      if(!vec)
+        return NULL;
+      line_cache.push_front(std::make_pair(line, vec));
+      if(line_cache.size() > LINE_CACHE_SIZE)
+        line_cache.pop_back();
+    }
+    at = ix.nested.back().num_moves;
+  }
+
+  if(at >= (int)vec->size() || at < 0)
+    return NULL;
+  if(idx) *idx = at;
+  return vec;
+}
+
+/**
+  * Walk the tree from the root to the variation line containing @a ix.
+  * The position itself may not exist yet.
+  */
+History* Game::findLine(const Index& ix) {
   if(ix.num_moves >= (int)history.size() || ix.num_moves < 0 )
     return NULL;
 
   History* aretv = &history;
   Entry* retv = &history[ix.num_moves];
-  if(idx) *idx = ix.num_moves;
 
   for(int i=0; i<(int)ix.nested.size();i++) {
     Variations::iterator it = retv->variations.find(ix.nested[i].variation);
-    if(it == retv->variations.end() || ix.nested[i].num_moves >= (int)it->second.size()
-                                || ix.nested[i].num_moves < 0 )
+    if(it == retv->variations.end())
       return NULL;
 
     aretv = &it->second;
+    if(i + 1 == (int)ix.nested.size())
+      break;
+    if(ix.nested[i].num_moves >= (int)it->second.size() || ix.nested[i].num_moves < 0 )
+      return NULL;
     retv = &it->second[ix.nested[i].num_moves];
-    if(idx) *idx = ix.nested[i].num_moves;
   }
   return aretv;
 }
@@ -102,12 +190,12 @@ const History* Game::fetchRef(const Index& ix, int* idx) const {
 
 void Game::testMove(const Index& ix) {
   if (ix != Index(0)) {
-    Entry *e1 = fetch(ix.prev());
-    Entry *e2 = fetch(ix);
-    if(!e1 || !e2 || !e1->position || !e2->move)
+    PositionPtr pos = entryPosition(ix.prev());
+    Entry *e = fetch(ix);
+    if(!pos || !e || !e->move)
       return;
 
-    if (!e1->position->testMove(e2->move))
+    if (!pos->testMove(e->move))
       kError() << "invalid move added to game history";
   }
 }
@@ -131,6 +219,104 @@ void Game::saveUndo(const UndoOp& op) {
 }
 
 
+bool Game::isCheckpoint(const Index& ix) const {
+  return checkpoint_interval <= 0 || ix.totalNumMoves() % checkpoint_interval == 0;
+}
+
+Entry Game::makeEntry(MovePtr m, PositionPtr pos, const Index& ix) const {
+  if(!m || isCheckpoint(ix))
+    return Entry(m, pos);
+
+  // the position can be rebuilt from the move, keep it in the cache only
+  cachePosition(ix, pos);
+  return Entry(m, PositionPtr());
+}
+
+PositionPtr Game::cachedPosition(const Index& ix) const {
+  for(std::list<std::pair<Index, PositionPtr> >::iterator it = position_cache.begin();
+        it != position_cache.end(); ++it) {
+    if(it->first == ix) {
+      position_cache.splice(position_cache.begin(), position_cache, it);
+      return it->second;
+    }
+  }
+  return PositionPtr();
+}
+
+void Game::cachePosition(const Index& ix, PositionPtr pos) const {
+  position_cache.push_front(std::make_pair(ix, pos));
+  if(position_cache.size() > POSITION_CACHE_SIZE)
+    position_cache.pop_back();
+}
+
+PositionPtr Game::entryPosition(const Index& ix) const {
+  const Entry *e = fetch(ix);
+  if(!e)
+    return PositionPtr();
+  if(e->position)
+    return e->position;
+  if(PositionPtr pos = cachedPosition(ix))
+    return pos;
+
+  // go back to the closest known position...
+  std::vector<MovePtr> moves;
+  PositionPtr pos;
+  for(Index i = ix; !pos; i = i.prev()) {
+    e = fetch(i);
+    if(!e)
+      return PositionPtr();
+    if(e->position)
+      pos = e->position;
+    else if(!(pos = cachedPosition(i))) {
+      if(!e->move || i == Index(0))
+        return PositionPtr(); // a gap in the history
+      moves.push_back(e->move);
+    }
+  }
+
+  // ...and play the moves from there
+  pos = pos->clone();
+  for(int i = (int)moves.size() - 1; i >= 0; i--)
+    pos->move(moves[i]);
+
+  cachePosition(ix, pos);
+  return pos;
+}
+
+void Game::applyCheckpoints(History& vec, const Index& first) {
+  Index ix = first;
+  for(int i = 0; i < (int)vec.size(); i++) {
+    Entry& e = vec[i];
+    if(!e.move || isCheckpoint(ix)) {
+      if(!e.position)
+        e.position = entryPosition(ix);
+    }
+    else if(e.position && entryPosition(ix.prev())) {
+      cachePosition(ix, e.position);
+      e.position = PositionPtr();
+    }
+
+    for(Variations::iterator it = e.variations.begin(); it != e.variations.end(); ++it)
+      applyCheckpoints(it->second, ix.next(it->first));
+    ix = ix.next();
+  }
+}
+
+void Game::setCheckpointInterval(int plies) {
+  if(plies < 0)
+    plies = 0;
+  if(plies == checkpoint_interval)
+    return;
+
+  checkpoint_interval = plies;
+  position_cache.clear();
+  applyCheckpoints(history, Index(0));
+}
+
+int Game::checkpointInterval() const {
+  return checkpoint_interval;
+}
+
 Index Game::index() const {
   return current;
 }
@@ -166,7 +352,7 @@ PositionPtr Game::position(const Index& index) const {
     kError() << "Index" << index << "out of range";
     return PositionPtr();
   }
-  return e->position;
+  return entryPosition(index);
 }
 
 QString Game::comment() const {
@@ -188,6 +374,8 @@ void Game::reset(PositionPtr pos) {
   undo_pos = 0;
   undo_history.clear();
   history.clear();
+  position_cache.clear();
+  line_cache.clear();
   history.push_back( Entry(MovePtr(), pos) );
   current = Index(0);
   onCurrentIndexChanged();
@@ -204,6 +392,7 @@ void Game::undo() {
 
   undo_pos--;
   UndoOp* op = &(undo_history[undo_pos]);
+  position_cache.clear();
 
   if(boost::get<UndoAdd>(op)) {
     UndoAdd *a = boost::get<UndoAdd>(op);
@@ -226,6 +415,7 @@ void Game::undo() {
 
       vec->pop_back();
     }
+    line_cache.clear();
 
     if(current == a->index) {
       current = current.prev();
@@ -242,15 +432,8 @@ void Game::undo() {
     Q_ASSERT(vec);
     Q_ASSERT((*vec)[at].variations.count(p->variation)==1);
 
-    History vold = (*vec)[at].variations[p->variation];
-    History vnew;
-    for(int i=at+1; i<(int)vec->size(); i++)
-      vnew.push_back((*vec)[i]);
-    while((int)vec->size()>at+1)
-      vec->pop_back();
-    for(int i=0; i<(int)vold.size(); i++)
-      vec->push_back(vold[i]);
-    (*vec)[at].variations[p->variation] = vnew;
+    flipVariation(*vec, at, p->variation);
+    line_cache.clear();
 
     current = current.flipVariation(p->index, p->variation);
     onPromoteVariation(p->index, p->variation);
@@ -265,23 +448,26 @@ void Game::undo() {
     Q_ASSERT((int)vec->size() == at+1);
     Q_ASSERT((*vec)[at].variations.empty());
 
-    for(int i=0;i<(int)t->history.size();i++)
-      vec->push_back(t->history[i]);
-    (*vec)[at].variations = t->variations;
-    (*vec)[at].vcomments = t->vcomments;
+    bool had_history = !t->history->empty();
+    appendEntries(*vec, *t->history, 0);
+    Entry *e = &(*vec)[at];
+    e->variations.swap(*t->variations);
+    e->vcomments.swap(t->vcomments);
+    line_cache.clear();
 
-    if(t->history.size())
+    if(had_history)
       onAdded(t->index.next());
-    for(Variations::iterator it = t->variations.begin(); it != t->variations.end(); ++it)
+    for(Variations::iterator it = e->variations.begin(); it != e->variations.end(); ++it)
       onAdded(t->index.next(it->first));
-    for(VComments::iterator it = t->vcomments.begin(); it != t->vcomments.end(); ++it)
+    for(VComments::iterator it = e->vcomments.begin(); it != e->vcomments.end(); ++it)
       onSetVComment(t->index, it->first, it->second);
   }
   else if(boost::get<UndoRemove>(op)) {
     UndoRemove *r = boost::get<UndoRemove>(op);
 
     Entry *e = fetch(r->index);
-    e->variations[r->variation] = r->history;
+    e->variations[r->variation].swap(*r->history);
+    line_cache.clear();
     onAdded(r->index.next(r->variation));
     if(!r->vcomment.isEmpty()) {
       e->vcomments[r->variation] = r->vcomment;
@@ -292,11 +478,13 @@ void Game::undo() {
     UndoClear *c = boost::get<UndoClear>(op);
 
     Entry *e = fetch(c->index);
-    e->variations = c->variations;
-    e->vcomments = c->vcomments;
-    for(Variations::iterator it = c->variations.begin(); it != c->variations.end(); ++it)
+    Q_ASSERT(e->variations.empty());
+    e->variations.swap(*c->variations);
+    e->vcomments.swap(c->vcomments);
+    line_cache.clear();
+    for(Variations::iterator it = e->variations.begin(); it != e->variations.end(); ++it)
       onAdded(c->index.next(it->first));
-    for(VComments::iterator it = c->vcomments.begin(); it != c->vcomments.end(); ++it)
+    for(VComments::iterator it = e->vcomments.begin(); it != e->vcomments.end(); ++it)
       onSetVComment(c->index, it->first, it->second);
   }
   else if(boost::get<UndoSetComment>(op)) {
@@ -336,6 +524,7 @@ void Game::redo() {
 
   UndoOp* op = &(undo_history[undo_pos]);
   undo_pos++;
+  position_cache.clear();
 
   if(boost::get<UndoAdd>(op)) {
     UndoAdd *a = boost::get<UndoAdd>(op);
@@ -359,6 +548,7 @@ void Game::redo() {
 
       vec->push_back(a->entry);
     }
+    line_cache.clear();
 
     onAdded(a->index);
     current = a->index;
@@ -372,15 +562,8 @@ void Game::redo() {
 
     Q_ASSERT(vec);
     Q_ASSERT((*vec)[at].variations.count(p->variation)==1);
-    History vold = (*vec)[at].variations[p->variation];
-    History vnew;
-    for(int i=at+1; i<(int)vec->size(); i++)
-      vnew.push_back((*vec)[i]);
-    while((int)vec->size()>at+1)
-      vec->pop_back();
-    for(int i=0; i<(int)vold.size(); i++)
-      vec->push_back(vold[i]);
-    (*vec)[at].variations[p->variation] = vnew;
+    flipVariation(*vec, at, p->variation);
+    line_cache.clear();
 
     current = current.flipVariation(p->index, p->variation);
     onPromoteVariation(p->index, p->variation);
@@ -392,38 +575,41 @@ void Game::redo() {
     int at;
     std::vector<Entry>* vec = fetchRef(t->index, &at);
     Q_ASSERT(vec);
-    Q_ASSERT((int)vec->size() == at+1+(int)t->history.size());
+    Q_ASSERT(t->history->empty() && t->variations->empty());
 
-    while((int)vec->size() > at+1)
-      vec->pop_back();
-    (*vec)[at].variations.clear();
-    (*vec)[at].vcomments.clear();
+    appendEntries(*t->history, *vec, at+1);
+    (*vec)[at].variations.swap(*t->variations);
+    (*vec)[at].vcomments.swap(t->vcomments);
+    line_cache.clear();
 
     if(current > t->index) {
       current = t->index;
       onCurrentIndexChanged();
     }
 
-    if(t->history.size())
+    if(!t->history->empty())
       onRemoved(t->index.next());
-    for(Variations::iterator it = t->variations.begin(); it != t->variations.end(); ++it)
+    for(Variations::iterator it = t->variations->begin(); it != t->variations->end(); ++it)
       onRemoved(t->index.next(it->first));
   }
   else if(boost::get<UndoRemove>(op)) {
     UndoRemove *r = boost::get<UndoRemove>(op);
 
     Entry *e = fetch(r->index);
+    r->history->swap(e->variations[r->variation]);
     e->variations.erase(r->variation);
     e->vcomments.erase(r->variation);
+    line_cache.clear();
     onRemoved(r->index.next(r->variation));
   }
   else if(boost::get<UndoClear>(op)) {
     UndoClear *c = boost::get<UndoClear>(op);
 
     Entry *e = fetch(c->index);
-    e->variations.clear();
-    e->vcomments.clear();
-    for(Variations::iterator it = c->variations.begin(); it != c->variations.end(); ++it)
+    c->variations->swap(e->variations);
+    c->vcomments.swap(e->vcomments);
+    line_cache.clear();
+    for(Variations::iterator it = c->variations->begin(); it != c->variations->end(); ++it)
       onRemoved(c->index.next(it->first));
   }
   else if(boost::get<UndoSetComment>(op)) {
@@ -510,15 +696,9 @@ void Game::promoteVariation(const Index& ix, int v) {
   Q_ASSERT(vec);
   Q_ASSERT((*vec)[at].variations.count(v)==1);
 
-  History vold = (*vec)[at].variations[v];
-  History vnew;
-  for(int i=at+1; i<(int)vec->size(); i++)
-    vnew.push_back((*vec)[i]);
-  while((int)vec->size()>at+1)
-    vec->pop_back();
-  for(int i=0; i<(int)vold.size(); i++)
-    vec->push_back(vold[i]);
-  (*vec)[at].variations[v] = vnew;
+  flipVariation(*vec, at, v);
+  position_cache.clear();
+  line_cache.clear();
 
   saveUndo(UndoPromote(ix, v));
   current = current.flipVariation(ix, v);
@@ -545,10 +725,13 @@ void Game::removeVariation(const Index& _ix) {
 void Game::removeVariation(const Index& ix, int v) {
   Entry* e = fetch(ix);
 
-  saveUndo(UndoRemove(ix, v, e->variations[v],
-                e->vcomments.count(v) ? e->vcomments[v] : QString() ));
+  UndoRemove ur(ix, v, e->vcomments.count(v) ? e->vcomments[v] : QString());
+  ur.history->swap(e->variations[v]);
+  saveUndo(ur);
   e->variations.erase(v);
   e->vcomments.erase(v);
+  position_cache.clear();
+  line_cache.clear();
 
   onRemoved(ix.next(v));
   if(current >= ix.next(v)) {
@@ -564,12 +747,14 @@ void Game::clearVariations() {
 void Game::clearVariations(const Index& ix) {
   Entry* e = fetch(ix);
 
-  UndoClear uc(ix, e->variations, e->vcomments);
+  UndoClear uc(ix);
+  uc.variations->swap(e->variations);
+  uc.vcomments.swap(e->vcomments);
   saveUndo(uc);
-  e->variations.clear();
-  e->vcomments.clear();
+  position_cache.clear();
+  line_cache.clear();
 
-  for(Variations::iterator it = uc.variations.begin(); it != uc.variations.end(); ++it)
+  for(Variations::iterator it = uc.variations->begin(); it != uc.variations->end(); ++it)
     onRemoved(ix.next(it->first));
   if(current > ix && !(current >= ix.next())) {
     current = ix;
@@ -591,20 +776,16 @@ void Game::truncate(const Index& ix) {
 
   Entry *e = &(*vec)[at];
   UndoTruncate undo(ix);
-  for(int i=at+1; i<(int)vec->size();i++)
-    undo.history.push_back((*vec)[i]);
-  while((int)vec->size()>at+1)
-    vec->pop_back();
-
-  undo.variations = e->variations;
-  undo.vcomments = e->vcomments;
+  appendEntries(*undo.history, *vec, at+1);
+  undo.variations->swap(e->variations);
+  undo.vcomments.swap(e->vcomments);
   saveUndo(undo);
-  e->variations.clear();
-  e->vcomments.clear();
+  position_cache.clear();
+  line_cache.clear();
 
-  if(undo.history.size())
+  if(!undo.history->empty())
     onRemoved(undo.index.next());
-  for(Variations::iterator it = undo.variations.begin(); it != undo.variations.end(); ++it)
+  for(Variations::iterator it = undo.variations->begin(); it != undo.variations->end(); ++it)
     onRemoved(undo.index.next(it->first));
 
   if(current > ix) {
@@ -624,15 +805,16 @@ void Game::add(MovePtr m, PositionPtr pos) {
   /* add the move on the mainline */
   if((int)vec->size() <= at+1 ) {
     Q_ASSERT((int)vec->size() == at+1);
-    vec->push_back(Entry(m, pos));
+    vec->push_back(makeEntry(m, pos, current.next()));
+    line_cache.clear();
     current = current.next();
     testMove();
-    saveUndo(UndoAdd(current, Entry(m, pos)));
+    saveUndo(UndoAdd(current, vec->back()));
     onAdded(current);
     onCurrentIndexChanged(old_c);
   }
   /* we are playing the move that is already next in the mainline */
-  else if( (*vec)[at+1].position && (*vec)[at+1].position->equals(pos)) {
+  else if( entryPosition(current.next()) && entryPosition(current.next())->equals(pos) ) {
     current = current.next();
     onCurrentIndexChanged(old_c);
     /* no need to test the move */
@@ -643,8 +825,8 @@ void Game::add(MovePtr m, PositionPtr pos) {
 
     /* check if a variations with this move already exists. */
     for(Variations::iterator it = e->variations.begin(); it != e->variations.end(); ++it)
-    if(it->second.size() > 0 && it->second[0].position
-        && it->second[0].position->equals(pos) ) {
+    if(it->second.size() > 0 && entryPosition(current.next(it->first))
+        && entryPosition(current.next(it->first))->equals(pos) ) {
       current = current.next(it->first);
       onCurrentIndexChanged(old_c);
 
@@ -652,10 +834,11 @@ void Game::add(MovePtr m, PositionPtr pos) {
     }
 
     int var_id = e->last_var_id++;
-    e->variations[var_id].push_back(Entry(m, pos));
+    e->variations[var_id].push_back(makeEntry(m, pos, current.next(var_id)));
+    line_cache.clear();
     current = current.next(var_id);
     testMove();
-    saveUndo(UndoAdd(current, Entry(m, pos)));
+    saveUndo(UndoAdd(current, e->variations[var_id].back()));
     onAdded(current);
     onCurrentIndexChanged(old_c);
   }
@@ -671,8 +854,10 @@ bool Game::insert(MovePtr m, PositionPtr pos, const Index& at) {
         undo_history.clear();
       }
       int hs = history.size();
+      position_cache.clear();
       history.resize(at.num_moves + 1);
       history[at.num_moves] = Entry(m, pos);
+      line_cache.clear();
       testMove(at);
       onAdded(Index(hs));
       return true;
@@ -687,7 +872,9 @@ bool Game::insert(MovePtr m, PositionPtr pos, const Index& at) {
     undo_pos = 0;
     undo_history.clear();
   }
-  bool res = e->position && e->position->equals(pos);
+  PositionPtr old_pos = entryPosition(at);
+  bool res = old_pos && old_pos->equals(pos);
+  position_cache.clear();
   e->move = m;
   e->position = pos;
   testMove(at);
@@ -708,8 +895,7 @@ bool Game::back() {
   Index old_c = current;
   Index new_c = current.prev();
 
-  Entry *e = fetch(new_c);
-  if(!e || e->position == 0) return false; // gap immediately before current
+  if(!entryPosition(new_c)) return false; // gap immediately before current
   current = new_c;
   onCurrentIndexChanged(old_c);
 
@@ -720,8 +906,7 @@ bool Game::forward() {
   Index old_c = current;
   Index new_c = current.next();
 
-  Entry *e = fetch(new_c);
-  if(!e || e->position == 0) {
+  if(!entryPosition(new_c)) {
      return false; // gap immediately before current
   }
   current = new_c;
@@ -765,10 +950,10 @@ QString Game::variationPgn(const History& vec, const Entry& e,
   QString res;
 
   for (int i = start; i < static_cast<int>(vec.size()); i++) {
-    const Entry& preve = (i > start) ? vec[i-1] : e;
+    PositionPtr prevpos = entryPosition(ix.prev());
 
-    QString mv = (vec[i].move && preve.position) ?
-              vec[i].move->toString("compact", preve.position ) : "???";
+    QString mv = (vec[i].move && prevpos) ?
+              vec[i].move->toString("compact", prevpos ) : "???";
 #if 0
     if (ix == current)
       mv = "[[" + mv + "]]";
@@ -840,6 +1025,7 @@ void Game::load(PositionPtr pos, const PGN& pgn) {
   current = Index(0);
   undo_history.clear();
   undo_pos = 0;
+  position_cache.clear();
 
   // setup an empty history, clear as needed
 
@@ -855,6 +1041,7 @@ void Game::load(PositionPtr pos, const PGN& pgn) {
       v_ids.push_back(it->first);
     fe->variations.clear();
     fe->vcomments.clear();
+    line_cache.clear();
 
     for(int i=0;i<(int)v_ids.size();i++)
       onRemoved(Index(0).next(v_ids[i]));
@@ -929,7 +1116,7 @@ void Game::load(PositionPtr pos, const PGN& pgn) {
       if(var_start) {
         Entry *e = &(*vec)[at];
         int var_id = e->last_var_id++;
-        e->variations[var_id].push_back(Entry(m, newPos));
+        e->variations[var_id].push_back(makeEntry(m, newPos, current.next(var_id)));
         if(!vcomment.isEmpty()) {
           e->vcomments[var_id] = vcomment;
           vcomment = QString();
@@ -937,18 +1124,19 @@ void Game::load(PositionPtr pos, const PGN& pgn) {
         /* this is a hack, but the mainline should NEVER
             be empty if there is a variation*/
         if((int)vec->size() - 1 == at)
-          vec->push_back(Entry(m, newPos));
+          vec->push_back(makeEntry(m, newPos, current.next()));
 
         current = current.next(var_id);
       }
       else {
         if((int)vec->size() - 1 == at)
-          vec->push_back(Entry(m, newPos));
+          vec->push_back(makeEntry(m, newPos, current.next()));
         else
-          (*vec)[at] = Entry(m, newPos);
+          (*vec)[at] = makeEntry(m, newPos, current);
 
         current = current.next();
       }
+      line_cache.clear();
 
       var_start = false;
     }
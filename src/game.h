@@ -13,6 +13,7 @@
 
 #include <boost/shared_ptr.hpp>
 #include <boost/variant/variant_fwd.hpp>
+#include <list>
 #include <vector>
 #include "fwd.h"
 #include "index.h"
@@ -36,6 +37,13 @@ typedef std::vector<UndoOp> UndoHistory;
     \brief A game with history and variations.
 
     This template class encapsulates an editable game with history and undo editing.
+
+    Positions can be stored only every few plies, see setCheckpointInterval.
+    The others are then rebuilt on demand by replaying moves, and the last
+    few rebuilt positions are kept in a small cache.
+
+    The variation lines visited last are remembered too, so that an index
+    in a known line is resolved without walking the tree from the root.
 */
 class Game {
 public:
@@ -45,15 +53,27 @@ public:
   GamePrivate::UndoHistory undo_history;
   int undo_pos;
 
+  int checkpoint_interval;
+  mutable std::list<std::pair<Index, PositionPtr> > position_cache;
+  mutable std::list<std::pair<Index, GamePrivate::History*> > line_cache;
+
   GamePrivate::Entry* fetch(const Index& ix);
   const GamePrivate::Entry* fetch(const Index& ix) const;
   GamePrivate::History* fetchRef(const Index& ix, int* idx);
   const GamePrivate::History* fetchRef(const Index& ix, int* idx) const;
+  GamePrivate::History* findLine(const Index& ix);
 
   void testMove();
   void testMove(const Index& ix);
   void saveUndo(const GamePrivate::UndoOp& op);
 
+  bool isCheckpoint(const Index& ix) const;
+  GamePrivate::Entry makeEntry(MovePtr move, PositionPtr pos, const Index& ix) const;
+  PositionPtr entryPosition(const Index& ix) const;
+  PositionPtr cachedPosition(const Index& ix) const;
+  void cachePosition(const Index& ix, PositionPtr pos) const;
+  void applyCheckpoints(GamePrivate::History& vec, const Index& first);
+
   QString variationPgn(const GamePrivate::History&, const GamePrivate::Entry&,
                           int start, const Index& _ix) const;
 
@@ -74,6 +94,14 @@ public:
   /** destructor */
   virtual ~Game();
 
+  /** keep a full position only every \a plies plies in the game tree,
+    rebuilding the other ones from the moves when needed.
+    0 keeps all positions, which is the default */
+  void setCheckpointInterval(int plies);
+
+  /** \return the number of plies between stored positions, 0 if all are stored */
+  int checkpointInterval() const;
+
   /** \return the index of the current position */
   Index index() const;
 
@@ -11,6 +11,7 @@
 #ifndef GAME_P_H
 #define GAME_P_H
 
+#include <algorithm>
 #include <map>
 #include <QString>
 #include "game.h"
@@ -19,9 +20,13 @@ namespace GamePrivate {
 
 typedef std::map<int, History> Variations;
 typedef std::map<int, QString> VComments;
+typedef boost::shared_ptr<History> HistoryPtr;
+typedef boost::shared_ptr<Variations> VariationsPtr;
 
 /**
-  * A class to store game entries
+  * A class to store game entries.
+  * The position is null in entries which are not checkpoints,
+  * see Game::setCheckpointInterval.
   */
 class Entry {
 public:
@@ -39,9 +44,23 @@ public:
   Entry()
     : last_var_id(0) { }
   ~Entry() { }
+
+  /** exchange the contents with @a other, without copying subtrees */
+  void swap(Entry& other) {
+    move.swap(other.move);
+    position.swap(other.position);
+    qSwap(comment, other.comment);
+    variations.swap(other.variations);
+    vcomments.swap(other.vcomments);
+    std::swap(last_var_id, other.last_var_id);
+  }
 };
 
-/* data and structs for undo */
+/* data and structs for undo.
+   Undo records own the subtrees detached from the game: they are moved
+   in and out of the history tree, so that undo and redo never copy them,
+   and records themselves are cheap to copy. */
+
 class UndoAdd {
 public:
   Index index;
@@ -61,32 +80,29 @@ public:
 class UndoTruncate {
 public:
   Index index;
-  History history;
-  Variations variations;
+  HistoryPtr history;
+  VariationsPtr variations;
   VComments vcomments;
   UndoTruncate(const Index& ix)
-    : index(ix) {}
-  UndoTruncate(const Index& ix, const History& h,
-          const Variations& v, const VComments& c)
-    : index(ix), history(h), variations(v), vcomments(c) {}
+    : index(ix), history(new History), variations(new Variations) {}
 };
 
 class UndoRemove {
 public:
   Index index;
   int variation;
-  History history;
+  HistoryPtr history;
   QString vcomment;
-  UndoRemove(const Index& ix, int v, const History& h, const QString& c)
-    : index(ix), variation(v), history(h), vcomment(c) {}
+  UndoRemove(const Index& ix, int v, const QString& c)
+    : index(ix), variation(v), history(new History), vcomment(c) {}
 };
 class UndoClear {
 public:
   Index index;
-  Variations variations;
+  VariationsPtr variations;
   VComments vcomments;
-  UndoClear(const Index& ix, const Variations& v, const VComments& c)
-    : index(ix), variations(v), vcomments(c) {}
+  UndoClear(const Index& ix)
+    : index(ix), variations(new Variations) {}
 };
 
 class UndoSetComment {
@@ -54,7 +54,8 @@ GraphicalGame::GraphicalGame(GraphicalSystem* graphical,
 : Game()
 , m_graphical(graphical)
 , m_movelist(m)
-, m_anim_sequence(false) {
+, m_anim_sequence(false)
+, m_server_driven(false) {
   m_action_state = 0;
   if(m_movelist) {
     m_movelist->reset();
@@ -78,6 +79,13 @@ void GraphicalGame::settingsChanged() {
   m_anim_sequence = settings().flag("animations", true)
                       && settings()("animations").flag("sequence", true);
   m_anim_sequence_max = settings()("animations")("sequence")[QString("max")] | 10;
+  setCheckpointInterval(m_server_driven ? 0 :
+    settings()("game")[QString("checkpoint-interval")] | 0);
+}
+
+void GraphicalGame::setServerDriven() {
+  m_server_driven = true;
+  setCheckpointInterval(0);
 }
 
 void GraphicalGame::onAdded(const Index& ix) {
@@ -105,7 +113,7 @@ void GraphicalGame::onAddedInternal(const Index& ix, bool confirm_promotion) {
     DecoratedMove mv( 
       (e->move && prev) ? 
       e->move->toString("decorated", prev) :
-      (e->position ? "(-)" : "???"));
+      (position(index) ? "(-)" : "???"));
       
     int turn = prev ? prev->turn() : (index.totalNumMoves()+1)%2;
     //mv += " " + QString::number(turn);
@@ -127,8 +135,9 @@ void GraphicalGame::onEntryChanged(const Index& at, int propagate) {
     Entry* e = fetch(at);
     if(!e)
       return;
-    if(at == current && e->position)
-      m_graphical->warp(e->move, e->position);
+    PositionPtr pos = position(at);
+    if(at == current && pos)
+      m_graphical->warp(e->move, pos);
     return;
   }
 
@@ -140,16 +149,17 @@ void GraphicalGame::onEntryChanged(const Index& at, int propagate) {
     Entry* pe = fetch(at.prev());
 
     AbstractPosition::Ptr last_pos;
-    if (pe) last_pos = pe->position;
+    if (pe) last_pos = position(at.prev());
+    AbstractPosition::Ptr pos = position(at);
 
     DecoratedMove mv(
       (e->move && last_pos) ? 
       e->move->toString("decorated", last_pos) :
-      (e->position ? "(-)" : "???"));
+      (pos ? "(-)" : "???"));
     int turn = last_pos ? last_pos->turn() : (at.totalNumMoves()+1)%2;
     m_movelist->setMove(at, turn, mv, e->comment);
-    if(at == current && e->position)
-      m_graphical->warp(e->move, e->position);
+    if(at == current && pos)
+      m_graphical->warp(e->move, pos);
 
     // when an entry changes, chances are that we get some more information about the
     // next ones as well
@@ -215,10 +225,10 @@ void GraphicalGame::onCurrentIndexChanged(const Index& old_c) {
   Entry *e = fetch(current);
   std::pair<int, int> steps = old_c.stepsTo(current);
 
-  if(!e || !e->position)
+  if(!e || !position(current))
     return;
 
-  if(!oe || !oe->position) {
+  if(!oe || !position(old_c)) {
     m_graphical->warp(move(), position());
     return;
   }
@@ -44,6 +44,7 @@ private:
   MoveList::Table*    m_movelist;
   bool                m_anim_sequence;
   int                 m_anim_sequence_max;
+  bool                m_server_driven;
 
   boost::shared_ptr<CtrlAction> m_ctrl;
   boost::weak_ptr<UserEntity> m_listener_entity;
@@ -82,6 +83,11 @@ public:
   virtual void createCtrlAction();
   virtual void destroyCtrlAction();
 
+  /** Keep every position of a game driven by a server, whatever the
+    game/checkpoint-interval setting says. Server positions can carry
+    state that replaying the moves would not reproduce. */
+  void setServerDriven();
+
   void setEntity(const boost::shared_ptr<UserEntity>& entity) { m_listener_entity = entity; }
   void detachEntity() { m_listener_entity.reset(); }
   void setActionStateObserver(const boost::shared_ptr<ActionStateObserver>& obs);
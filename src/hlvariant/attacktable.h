@@ -0,0 +1,168 @@
+/*
+  Copyright (c) 2007 Paolo Capriotti <p.capriotti@gmail.com>
+            (c) 2007 Maurizio Monge <maurizio.monge@kdemail.net>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#ifndef HLVARIANT__ATTACKTABLE_H
+#define HLVARIANT__ATTACKTABLE_H
+
+#include <vector>
+#include <QtGlobal>
+
+#include "point.h"
+
+namespace HLVariant {
+
+/**
+  * Facts about recently seen positions: the squares attacked by
+  * each side, where the royal pieces are, and whether the side to
+  * move is stalled.
+  *
+  * Legality checks fill a whole attack map of a position in a single
+  * pass over the board, the first time it is needed. Maps are bound to
+  * the Zobrist key of the position they describe, and the table keeps
+  * a few of them, so that playing a move on a state, looking at the
+  * new position and taking the move back does not lose the map of
+  * the original position.
+  */
+class AttackTable {
+public:
+  /**
+    * Returned for facts which have not been computed yet.
+    */
+  enum { Unknown = -1 };
+
+  class Map {
+    friend class AttackTable;
+
+    quint64 m_key;
+    bool m_filled;
+    int m_stalled;
+    int m_width;
+    std::vector<quint8> m_attacked;
+    Point m_royal[2];
+    unsigned int m_used;
+
+    void reset(quint64 key, const Point& size) {
+      m_key = key;
+      m_filled = false;
+      m_stalled = Unknown;
+      m_width = size.x;
+      m_attacked.assign(size.x * size.y, 0);
+      m_royal[0] = m_royal[1] = Point::invalid();
+    }
+  public:
+    Map()
+    : m_key(0)
+    , m_filled(false)
+    , m_stalled(Unknown)
+    , m_width(0)
+    , m_used(0) { }
+
+    /**
+      * \return Whether attacks and royal pieces have been filled in.
+      */
+    bool filled() const { return m_filled; }
+    void setFilled() { m_filled = true; }
+
+    /**
+      * \return Whether a piece of @a color can capture on @a p.
+      * \note @a p must be on the board.
+      */
+    bool attacked(const Point& p, int color) const {
+      return m_attacked[p.x + p.y * m_width] & (1 << color);
+    }
+
+    void setAttacked(const Point& p, int color) {
+      m_attacked[p.x + p.y * m_width] |= 1 << color;
+    }
+
+    /**
+      * \return The square of the royal piece of @a color,
+      *         or an invalid point if there is none.
+      */
+    Point royal(int color) const {
+      return color >= 0 && color < 2 ? m_royal[color] : Point::invalid();
+    }
+
+    void setRoyal(int color, const Point& p) {
+      if (color >= 0 && color < 2)
+        m_royal[color] = p;
+    }
+
+    /**
+      * \return Whether the side to move has no legal moves, or Unknown.
+      */
+    int stalled() const { return m_stalled; }
+    void setStalled(bool value) { m_stalled = value; }
+  };
+private:
+  enum { MapCount = 2 };
+
+  Map m_maps[MapCount];
+  unsigned int m_clock;
+public:
+  AttackTable()
+  : m_clock(0) { }
+
+  /**
+    * \return The map of the position whose Zobrist key is @a key.
+    *         If the table has no such map, the least recently used one
+    *         is emptied and bound to it, for a board of size @a size.
+    */
+  Map& map(quint64 key, const Point& size) {
+    Map* res = 0;
+    for (int i = 0; i < MapCount; i++) {
+      Map& m = m_maps[i];
+      if (m.m_used != 0 && m.m_key == key) {
+        res = &m;
+        break;
+      }
+      if (!res || m.m_used < res->m_used)
+        res = &m;
+    }
+
+    if (res->m_used == 0 || res->m_key != key)
+      res->reset(key, size);
+    res->m_used = ++m_clock;
+    return *res;
+  }
+};
+
+/**
+  * The attack table of a game state.
+  * It is allocated on first use, and not carried along when the state
+  * is copied, so that copying a state does not cost any more than before.
+  */
+class AttackTableHolder {
+  mutable AttackTable* m_table;
+public:
+  AttackTableHolder()
+  : m_table(0) { }
+
+  AttackTableHolder(const AttackTableHolder&)
+  : m_table(0) { }
+
+  ~AttackTableHolder() { delete m_table; }
+
+  /**
+    * Keep the current table: its maps are bound to positions, so
+    * they stay correct whatever the state is assigned.
+    */
+  AttackTableHolder& operator=(const AttackTableHolder&) { return *this; }
+
+  AttackTable& get() const {
+    if (!m_table)
+      m_table = new AttackTable;
+    return *m_table;
+  }
+};
+
+} // namespace HLVariant
+
+#endif // HLVARIANT__ATTACKTABLE_H
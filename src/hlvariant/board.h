@@ -16,6 +16,7 @@
 
 #include "point.h"
 #include "pathinfo.h"
+#include "zobrist.h"
 
 namespace HLVariant {
 
@@ -26,6 +27,7 @@ public:
 private:
   Point m_size;
   std::vector<Piece> m_data;
+  quint64 m_hash;
 public:
   /**
     * Create a new Board with the given size.
@@ -84,24 +86,32 @@ public:
     * Coordinates displayed at the board border.
     */
   QStringList borderCoords() const;
+  
+  /**
+    * \return A Zobrist key for the board contents.
+    *         It is updated incrementally by set().
+    */
+  quint64 hash() const;
 };
 
 // IMPLEMENTATION
 
 template <typename Piece>
 Board<Piece>::Board(const Point& size)
-: m_size(size) {
+: m_size(size)
+, m_hash(0) {
   m_data.resize(m_size.x * m_size.y);
 }
 
 template <typename Piece>
 Board<Piece>::Board(const Board<Piece>& other)
 : m_size(other.m_size)
-, m_data(other.m_data) { }
+, m_data(other.m_data)
+, m_hash(other.m_hash) { }
 
 template <typename Piece>
 bool Board<Piece>::operator==(const Board<Piece>& other) const {
-  if (m_size != other.m_size)
+  if (m_size != other.m_size || m_hash != other.m_hash)
     return false;
     
   const unsigned int total = m_data.size();
@@ -134,7 +144,10 @@ Piece Board<Piece>::get(const Point& p) const {
 template <typename Piece>
 void Board<Piece>::set(const Point& p, const Piece& piece) {
   if (valid(p)) {
-    m_data[p.x + p.y * m_size.x] = piece;
+    int index = p.x + p.y * m_size.x;
+    m_hash ^= Zobrist::square(Zobrist::code(m_data[index]), index) ^
+              Zobrist::square(Zobrist::code(piece), index);
+    m_data[index] = piece;
   }
 }
 
@@ -203,6 +216,9 @@ QStringList Board<Piece>::borderCoords() const {
   return retv + retv;
 }
 
+template <typename Piece>
+quint64 Board<Piece>::hash() const { return m_hash; }
+
 }
 
 #endif // HLVARIANT__BOARD_H
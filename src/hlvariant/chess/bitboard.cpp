@@ -0,0 +1,293 @@
+/*
+  Copyright (c) 2007 Paolo Capriotti <p.capriotti@gmail.com>
+            (c) 2007 Maurizio Monge <maurizio.monge@kdemail.net>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#include "bitboard.h"
+#include "piece.h"
+
+#ifdef __BMI2__
+  #include <immintrin.h>
+#endif
+
+namespace HLVariant {
+namespace Chess {
+
+namespace {
+
+struct Magic {
+  Bitboard mask;
+  Bitboard magic;
+  Bitboard* attacks;
+  unsigned int shift;
+
+  unsigned int index(Bitboard occupied) const {
+#ifdef __BMI2__
+    return static_cast<unsigned int>(_pext_u64(occupied, mask));
+#else
+    return static_cast<unsigned int>(((occupied & mask) * magic) >> shift);
+#endif
+  }
+};
+
+Magic s_rook_magics[64];
+Magic s_bishop_magics[64];
+Bitboard s_rook_table[0x19000];
+Bitboard s_bishop_table[0x1480];
+
+Bitboard s_knight[64];
+Bitboard s_king[64];
+Bitboard s_pawn[2][64];
+Bitboard s_between[64][64];
+Bitboard s_line[64][64];
+
+const int s_rook_directions[4][2] = { {1, 0}, {-1, 0}, {0, 1}, {0, -1} };
+const int s_bishop_directions[4][2] = { {1, 1}, {1, -1}, {-1, 1}, {-1, -1} };
+
+bool onBoard(int x, int y) {
+  return x >= 0 && x < 8 && y >= 0 && y < 8;
+}
+
+Bitboard slide(int sq, Bitboard occupied, const int directions[4][2]) {
+  Bitboard res = 0;
+  for (int d = 0; d < 4; d++) {
+    int x = sq & 7;
+    int y = sq >> 3;
+    for (;;) {
+      x += directions[d][0];
+      y += directions[d][1];
+      if (!onBoard(x, y))
+        break;
+      Bitboard b = Bitboards::bit(x + (y << 3));
+      res |= b;
+      if (occupied & b)
+        break;
+    }
+  }
+  return res;
+}
+
+Bitboard jumps(int sq, const int deltas[][2], int n) {
+  Bitboard res = 0;
+  for (int i = 0; i < n; i++) {
+    int x = (sq & 7) + deltas[i][0];
+    int y = (sq >> 3) + deltas[i][1];
+    if (onBoard(x, y))
+      res |= Bitboards::bit(x + (y << 3));
+  }
+  return res;
+}
+
+/**
+  * Xorshift64* generator, used to look for magic numbers.
+  * The seed is fixed, so that initialization is deterministic.
+  */
+class MagicRandom {
+  Bitboard m_state;
+public:
+  MagicRandom() : m_state(1070372ULL) { }
+
+  Bitboard next() {
+    m_state ^= m_state >> 12;
+    m_state ^= m_state << 25;
+    m_state ^= m_state >> 27;
+    return m_state * 2685821657736338717ULL;
+  }
+
+  Bitboard sparse() { return next() & next() & next(); }
+};
+
+void initMagics(Magic* magics, Bitboard* table, const int directions[4][2]) {
+  const Bitboard rank_edges = 0xff000000000000ffULL;
+  const Bitboard file_edges = 0x8181818181818181ULL;
+
+  Bitboard occupancy[4096];
+  Bitboard reference[4096];
+  int epoch[4096];
+  for (int i = 0; i < 4096; i++)
+    epoch[i] = 0;
+  int attempt = 0;
+
+  MagicRandom random;
+  Bitboard* attacks = table;
+
+  for (int sq = 0; sq < 64; sq++) {
+    Magic& m = magics[sq];
+    Bitboard rank = 0xffULL << ((sq >> 3) << 3);
+    Bitboard file = 0x0101010101010101ULL << (sq & 7);
+    Bitboard edges = (rank_edges & ~rank) | (file_edges & ~file);
+
+    m.mask = slide(sq, 0, directions) & ~edges;
+    m.shift = 64 - Bitboards::count(m.mask);
+    m.attacks = attacks;
+
+    // enumerate all subsets of the mask (Carry-Rippler trick)
+    int size = 0;
+    Bitboard b = 0;
+    do {
+      occupancy[size] = b;
+      reference[size] = slide(sq, b, directions);
+#ifdef __BMI2__
+      m.attacks[_pext_u64(b, m.mask)] = reference[size];
+#endif
+      size++;
+      b = (b - m.mask) & m.mask;
+    } while (b);
+    attacks += size;
+
+#ifndef __BMI2__
+    for (int i = 0; i < size; ) {
+      do {
+        m.magic = random.sparse();
+      } while (Bitboards::count((m.magic * m.mask) >> 56) < 6);
+
+      // a magic is good if it maps every occupancy to the
+      // right attack set, colliding only on identical sets
+      attempt++;
+      for (i = 0; i < size; i++) {
+        unsigned int index = m.index(occupancy[i]);
+        if (epoch[index] < attempt) {
+          epoch[index] = attempt;
+          m.attacks[index] = reference[i];
+        }
+        else if (m.attacks[index] != reference[i])
+          break;
+      }
+    }
+#endif
+  }
+}
+
+void initTables() {
+  static const int knight_deltas[8][2] = {
+    {1, 2}, {1, -2}, {-1, 2}, {-1, -2}, {2, 1}, {2, -1}, {-2, 1}, {-2, -1}
+  };
+  static const int king_deltas[8][2] = {
+    {1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}
+  };
+  static const int pawn_deltas[2][2][2] = {
+    { {1, -1}, {-1, -1} },
+    { {1, 1}, {-1, 1} }
+  };
+
+  for (int sq = 0; sq < 64; sq++) {
+    s_knight[sq] = jumps(sq, knight_deltas, 8);
+    s_king[sq] = jumps(sq, king_deltas, 8);
+    s_pawn[0][sq] = jumps(sq, pawn_deltas[0], 2);
+    s_pawn[1][sq] = jumps(sq, pawn_deltas[1], 2);
+  }
+
+  initMagics(s_rook_magics, s_rook_table, s_rook_directions);
+  initMagics(s_bishop_magics, s_bishop_table, s_bishop_directions);
+
+  for (int a = 0; a < 64; a++) {
+    for (int b = 0; b < 64; b++) {
+      s_between[a][b] = 0;
+      s_line[a][b] = 0;
+      if (a == b)
+        continue;
+
+      Bitboard ba = Bitboards::bit(a);
+      Bitboard bb = Bitboards::bit(b);
+      if (slide(a, 0, s_rook_directions) & bb) {
+        s_between[a][b] = slide(a, bb, s_rook_directions) &
+                          slide(b, ba, s_rook_directions);
+        s_line[a][b] = (slide(a, 0, s_rook_directions) &
+                        slide(b, 0, s_rook_directions)) | ba | bb;
+      }
+      else if (slide(a, 0, s_bishop_directions) & bb) {
+        s_between[a][b] = slide(a, bb, s_bishop_directions) &
+                          slide(b, ba, s_bishop_directions);
+        s_line[a][b] = (slide(a, 0, s_bishop_directions) &
+                        slide(b, 0, s_bishop_directions)) | ba | bb;
+      }
+    }
+  }
+}
+
+struct TableInitializer {
+  TableInitializer() { initTables(); }
+};
+
+TableInitializer s_initializer;
+
+} // anonymous namespace
+
+int Bitboards::first(Bitboard b) {
+#ifdef Q_CC_GNU
+  return __builtin_ctzll(b);
+#else
+  int res = 0;
+  while (!(b & 1)) {
+    b >>= 1;
+    res++;
+  }
+  return res;
+#endif
+}
+
+int Bitboards::popFirst(Bitboard& b) {
+  int res = first(b);
+  b &= b - 1;
+  return res;
+}
+
+int Bitboards::count(Bitboard b) {
+#ifdef Q_CC_GNU
+  return __builtin_popcountll(b);
+#else
+  int res = 0;
+  for (; b; b &= b - 1)
+    res++;
+  return res;
+#endif
+}
+
+Bitboard Bitboards::knightAttacks(int sq) { return s_knight[sq]; }
+
+Bitboard Bitboards::kingAttacks(int sq) { return s_king[sq]; }
+
+Bitboard Bitboards::pawnAttacks(int forward, int sq) {
+  return s_pawn[forward > 0 ? 1 : 0][sq];
+}
+
+Bitboard Bitboards::rookAttacks(int sq, Bitboard occupied) {
+  const Magic& m = s_rook_magics[sq];
+  return m.attacks[m.index(occupied)];
+}
+
+Bitboard Bitboards::bishopAttacks(int sq, Bitboard occupied) {
+  const Magic& m = s_bishop_magics[sq];
+  return m.attacks[m.index(occupied)];
+}
+
+Bitboard Bitboards::between(int a, int b) { return s_between[a][b]; }
+
+Bitboard Bitboards::line(int a, int b) { return s_line[a][b]; }
+
+BitboardPosition::BitboardPosition()
+: occupied(0) {
+  for (int c = 0; c < 2; c++) {
+    colors[c] = 0;
+    for (int t = 0; t < 6; t++)
+      pieces[c][t] = 0;
+  }
+}
+
+Bitboard BitboardPosition::attackers(int sq, int color, int forward, Bitboard occupied) const {
+  const Bitboard* p = pieces[color];
+  return (Bitboards::pawnAttacks(-forward, sq) & p[Piece::PAWN])
+       | (Bitboards::knightAttacks(sq) & p[Piece::KNIGHT])
+       | (Bitboards::kingAttacks(sq) & p[Piece::KING])
+       | (Bitboards::rookAttacks(sq, occupied) & (p[Piece::ROOK] | p[Piece::QUEEN]))
+       | (Bitboards::bishopAttacks(sq, occupied) & (p[Piece::BISHOP] | p[Piece::QUEEN]));
+}
+
+} // namespace Chess
+} // namespace HLVariant
+
@@ -0,0 +1,117 @@
+/*
+  Copyright (c) 2007 Paolo Capriotti <p.capriotti@gmail.com>
+            (c) 2007 Maurizio Monge <maurizio.monge@kdemail.net>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#ifndef HLVARIANT__CHESS__BITBOARD_H
+#define HLVARIANT__CHESS__BITBOARD_H
+
+#include <QtGlobal>
+#include "point.h"
+#include "export.h"
+
+namespace HLVariant {
+namespace Chess {
+
+/**
+  * A set of squares of an 8x8 board, one bit per square.
+  * Square @a x + 8 * @a y corresponds to Point(x, y).
+  */
+typedef quint64 Bitboard;
+
+/**
+  * Precomputed attack tables for the 8x8 chessboard.
+  * Slider attacks are looked up through magic multiplication,
+  * or through the PEXT instruction when compiling for BMI2.
+  */
+class TAGUA_EXPORT Bitboards {
+public:
+  static int square(const Point& p) { return p.x + (p.y << 3); }
+  static Point point(int sq) { return Point(sq & 7, sq >> 3); }
+  static Bitboard bit(int sq) { return Bitboard(1) << sq; }
+
+  /**
+    * \return The index of the least significant bit of @a b.
+    * \note @a b must not be empty.
+    */
+  static int first(Bitboard b);
+
+  /**
+    * Remove the least significant bit from @a b.
+    * \return Its index.
+    */
+  static int popFirst(Bitboard& b);
+
+  /**
+    * \return The number of squares in @a b.
+    */
+  static int count(Bitboard b);
+
+  /**
+    * \return Whether @a b contains more than one square.
+    */
+  static bool several(Bitboard b) { return b & (b - 1); }
+
+  static Bitboard knightAttacks(int sq);
+  static Bitboard kingAttacks(int sq);
+
+  /**
+    * \param forward Vertical direction of pawn movement (-1 or 1).
+    * \return Squares attacked by a pawn standing on @a sq.
+    */
+  static Bitboard pawnAttacks(int forward, int sq);
+
+  static Bitboard rookAttacks(int sq, Bitboard occupied);
+  static Bitboard bishopAttacks(int sq, Bitboard occupied);
+  static Bitboard queenAttacks(int sq, Bitboard occupied) {
+    return rookAttacks(sq, occupied) | bishopAttacks(sq, occupied);
+  }
+
+  /**
+    * \return Squares strictly between @a a and @a b, or an empty set
+    *         if they do not share a rank, file or diagonal.
+    */
+  static Bitboard between(int a, int b);
+
+  /**
+    * \return The whole line passing through @a a and @a b, or an empty
+    *         set if they do not share a rank, file or diagonal.
+    */
+  static Bitboard line(int a, int b);
+};
+
+/**
+  * A bitboard snapshot of a chess position, indexed by the
+  * color and type values of Chess::Piece.
+  */
+struct TAGUA_EXPORT BitboardPosition {
+  Bitboard pieces[2][6];
+  Bitboard colors[2];
+  Bitboard occupied;
+
+  BitboardPosition();
+
+  void add(int color, int type, int sq) {
+    Bitboard b = Bitboards::bit(sq);
+    pieces[color][type] |= b;
+    colors[color] |= b;
+    occupied |= b;
+  }
+
+  /**
+    * \return Pieces of @a color attacking @a sq, assuming @a occupied
+    *         as the set of blocking squares and @a forward as the
+    *         direction of pawns of @a color.
+    */
+  Bitboard attackers(int sq, int color, int forward, Bitboard occupied) const;
+};
+
+} // namespace Chess
+} // namespace HLVariant
+
+#endif // HLVARIANT__CHESS__BITBOARD_H
@@ -0,0 +1,342 @@
+/*
+  Copyright (c) 2007 Paolo Capriotti <p.capriotti@gmail.com>
+            (c) 2007 Maurizio Monge <maurizio.monge@kdemail.net>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#ifndef HLVARIANT__CHESS__BITBOARDMOVEGENERATOR_H
+#define HLVARIANT__CHESS__BITBOARDMOVEGENERATOR_H
+
+#include "movegenerator.h"
+#include "bitboard.h"
+
+namespace HLVariant {
+namespace Chess {
+
+/**
+  * A move generator for 8x8 chess boards, producing the same
+  * legal moves as MoveGenerator in a single pass over bitboards,
+  * without testing each candidate move on a copy of the state.
+  * Positions that cannot be represented (other board sizes, or
+  * not exactly one king for the side to move) are handled by
+  * the generic MoveGenerator.
+  */
+template <typename _LegalityCheck>
+class BitboardMoveGenerator : public MoveGenerator<_LegalityCheck> {
+  typedef MoveGenerator<_LegalityCheck> Base;
+public:
+  typedef typename Base::LegalityCheck LegalityCheck;
+  typedef typename Base::GameState GameState;
+  typedef typename Base::Move Move;
+  typedef typename Base::Piece Piece;
+  typedef typename Base::MoveCallback MoveCallback;
+protected:
+  using Base::m_state;
+
+  /**
+    * Fill @a pos with the pieces of the current state.
+    * \return Whether the state can be handled by this generator.
+    */
+  virtual bool load(BitboardPosition& pos) const;
+
+  /**
+    * Generate all legal board moves starting from a square in @a from.
+    * \return false if the callback asked to stop.
+    */
+  virtual bool generateMoves(const BitboardPosition& pos, Bitboard from,
+                             MoveCallback& callback) const;
+
+  /**
+    * Compute the set of empty squares where a piece can be dropped
+    * without leaving the king of the side to move in check.
+    * \return Whether the state can be handled by this generator.
+    */
+  virtual bool dropTargets(Bitboard& targets) const;
+
+  bool emit(int from, int to, typename Move::Type type,
+            MoveCallback& callback, int promotion = -1) const;
+  bool emitPawn(int from, int to, typename Move::Type type,
+                MoveCallback& callback) const;
+  bool safeCastling(const BitboardPosition& pos, int king, int to,
+                    int rook, int rookDestination) const;
+public:
+  BitboardMoveGenerator(const GameState& state);
+
+  virtual bool check(typename Piece::Color) const;
+  virtual void generate(MoveCallback&) const;
+  virtual bool generateFrom(const Point& p, MoveCallback&) const;
+};
+
+// IMPLEMENTATION
+
+template <typename LegalityCheck>
+BitboardMoveGenerator<LegalityCheck>::BitboardMoveGenerator(const GameState& state)
+: Base(state) { }
+
+template <typename LegalityCheck>
+bool BitboardMoveGenerator<LegalityCheck>::load(BitboardPosition& pos) const {
+  if (m_state.board().size() != Point(8, 8))
+    return false;
+
+  for (int sq = 0; sq < 64; sq++) {
+    Piece piece = m_state.board().get(Bitboards::point(sq));
+    if (piece.color() != Piece::INVALID_COLOR && piece.type() != Piece::INVALID_TYPE)
+      pos.add(piece.color(), piece.type(), sq);
+  }
+
+  Bitboard king = pos.pieces[m_state.turn()][Piece::KING];
+  return !Bitboards::several(king);
+}
+
+template <typename LegalityCheck>
+bool BitboardMoveGenerator<LegalityCheck>::check(typename Piece::Color turn) const {
+  BitboardPosition pos;
+  if (!load(pos) || Bitboards::several(pos.pieces[turn][Piece::KING]))
+    return Base::check(turn);
+
+  Bitboard king = pos.pieces[turn][Piece::KING];
+  if (!king) {
+    // a missing king is considered in check
+    return true;
+  }
+
+  typename Piece::Color them = Piece::oppositeColor(turn);
+  return pos.attackers(Bitboards::first(king), them,
+                       m_state.direction(them).y, pos.occupied);
+}
+
+template <typename LegalityCheck>
+void BitboardMoveGenerator<LegalityCheck>::generate(MoveCallback& callback) const {
+  BitboardPosition pos;
+  if (load(pos))
+    generateMoves(pos, ~Bitboard(0), callback);
+  else
+    Base::generate(callback);
+}
+
+template <typename LegalityCheck>
+bool BitboardMoveGenerator<LegalityCheck>::generateFrom(const Point& p, MoveCallback& callback) const {
+  if (!m_state.board().valid(p))
+    return true;
+
+  BitboardPosition pos;
+  if (load(pos))
+    return generateMoves(pos, Bitboards::bit(Bitboards::square(p)), callback);
+  else
+    return Base::generateFrom(p, callback);
+}
+
+template <typename LegalityCheck>
+bool BitboardMoveGenerator<LegalityCheck>::
+generateMoves(const BitboardPosition& pos, Bitboard from, MoveCallback& callback) const {
+  typename Piece::Color us = m_state.turn();
+  typename Piece::Color them = Piece::oppositeColor(us);
+  const Bitboard* mine = pos.pieces[us];
+  const Bitboard* theirs = pos.pieces[them];
+  const int forward = m_state.direction(us).y;
+  const int their_forward = m_state.direction(them).y;
+
+  // without a king, no move is legal
+  if (!mine[Piece::KING])
+    return true;
+
+  const int king = Bitboards::first(mine[Piece::KING]);
+  const Bitboard own = pos.colors[us];
+  const Bitboard checkers = pos.attackers(king, them, their_forward, pos.occupied);
+
+  // king moves: the king itself must not shield the target square
+  if (from & mine[Piece::KING]) {
+    Bitboard occupied = pos.occupied ^ Bitboards::bit(king);
+    Bitboard targets = Bitboards::kingAttacks(king) & ~own;
+    while (targets) {
+      int to = Bitboards::popFirst(targets);
+      if (!pos.attackers(to, them, their_forward, occupied) &&
+          !emit(king, to, Move::NORMAL, callback))
+        return false;
+    }
+  }
+
+  if (Bitboards::several(checkers))
+    return true;
+
+  // squares that block or capture a single checker
+  Bitboard check_mask = ~Bitboard(0);
+  if (checkers) {
+    int checker = Bitboards::first(checkers);
+    check_mask = checkers | Bitboards::between(king, checker);
+  }
+
+  // pieces pinned against the king
+  Bitboard pinned = 0;
+  Bitboard snipers =
+      (Bitboards::rookAttacks(king, 0) & (theirs[Piece::ROOK] | theirs[Piece::QUEEN]))
+    | (Bitboards::bishopAttacks(king, 0) & (theirs[Piece::BISHOP] | theirs[Piece::QUEEN]));
+  while (snipers) {
+    Bitboard blockers = Bitboards::between(king, Bitboards::popFirst(snipers)) & pos.occupied;
+    if (blockers && !Bitboards::several(blockers))
+      pinned |= blockers & own;
+  }
+
+  Bitboard pieces = own & ~mine[Piece::KING] & from;
+  while (pieces) {
+    int sq = Bitboards::popFirst(pieces);
+    Bitboard b = Bitboards::bit(sq);
+    Bitboard pin_mask = (pinned & b) ? Bitboards::line(king, sq) : ~Bitboard(0);
+    Bitboard targets;
+
+    if (b & mine[Piece::PAWN]) {
+      Point p = Bitboards::point(sq);
+      Point dir = m_state.direction(us);
+      Bitboard mask = check_mask & pin_mask;
+
+      // pushes
+      Point one = p + dir;
+      if (m_state.board().valid(one)) {
+        int to = Bitboards::square(one);
+        if (!(pos.occupied & Bitboards::bit(to))) {
+          if ((mask & Bitboards::bit(to)) &&
+              !emitPawn(sq, to, Move::NORMAL, callback))
+            return false;
+
+          Point two = one + dir;
+          if (p.y == m_state.startingRank(us) + dir.y && m_state.board().valid(two)) {
+            int to2 = Bitboards::square(two);
+            if (!(pos.occupied & Bitboards::bit(to2)) &&
+                (mask & Bitboards::bit(to2)) &&
+                !emit(sq, to2, Move::EN_PASSANT_TRIGGER, callback))
+              return false;
+          }
+        }
+      }
+
+      // captures
+      targets = Bitboards::pawnAttacks(forward, sq) & pos.colors[them] & mask;
+      while (targets) {
+        if (!emitPawn(sq, Bitboards::popFirst(targets), Move::NORMAL, callback))
+          return false;
+      }
+
+      // en passant, tested by removing both pawns from the board
+      Point ep = m_state.enPassant();
+      if (m_state.board().valid(ep)) {
+        int to = Bitboards::square(ep);
+        Bitboard ep_bit = Bitboards::bit(to);
+        if ((Bitboards::pawnAttacks(forward, sq) & ep_bit) &&
+            !(pos.occupied & ep_bit)) {
+          Bitboard captured = Bitboards::bit(Bitboards::square(Point(ep.x, p.y)));
+          Bitboard occupied = (pos.occupied & ~b & ~captured) | ep_bit;
+          if (!(pos.attackers(king, them, their_forward, occupied) & ~captured) &&
+              !emit(sq, to, Move::EN_PASSANT_CAPTURE, callback))
+            return false;
+        }
+      }
+      continue;
+    }
+    else if (b & mine[Piece::KNIGHT])
+      targets = Bitboards::knightAttacks(sq);
+    else if (b & mine[Piece::BISHOP])
+      targets = Bitboards::bishopAttacks(sq, pos.occupied);
+    else if (b & mine[Piece::ROOK])
+      targets = Bitboards::rookAttacks(sq, pos.occupied);
+    else
+      targets = Bitboards::queenAttacks(sq, pos.occupied);
+
+    targets &= ~own & check_mask & pin_mask;
+    while (targets) {
+      if (!emit(sq, Bitboards::popFirst(targets), Move::NORMAL, callback))
+        return false;
+    }
+  }
+
+  // castling
+  Point start = m_state.kingStartingPosition(us);
+  if (!checkers && (from & mine[Piece::KING]) &&
+      m_state.board().valid(start) && Bitboards::square(start) == king) {
+    if (m_state.kingCastling(us) && start.x + 3 < 8) {
+      Bitboard path = Bitboards::bit(king + 1) | Bitboards::bit(king + 2);
+      if ((mine[Piece::ROOK] & Bitboards::bit(king + 3)) &&
+          !(pos.occupied & path) &&
+          !pos.attackers(king + 1, them, their_forward, pos.occupied) &&
+          safeCastling(pos, king, king + 2, king + 3, king + 1) &&
+          !emit(king, king + 2, Move::KING_SIDE_CASTLING, callback))
+        return false;
+    }
+    if (m_state.queenCastling(us) && start.x - 4 >= 0) {
+      Bitboard path = Bitboards::bit(king - 1) | Bitboards::bit(king - 2)
+                    | Bitboards::bit(king - 3);
+      if ((mine[Piece::ROOK] & Bitboards::bit(king - 4)) &&
+          !(pos.occupied & path) &&
+          !pos.attackers(king - 1, them, their_forward, pos.occupied) &&
+          safeCastling(pos, king, king - 2, king - 4, king - 1) &&
+          !emit(king, king - 2, Move::QUEEN_SIDE_CASTLING, callback))
+        return false;
+    }
+  }
+
+  return true;
+}
+
+template <typename LegalityCheck>
+bool BitboardMoveGenerator<LegalityCheck>::
+safeCastling(const BitboardPosition& pos, int king, int to, int rook, int rookDestination) const {
+  Bitboard occupied = pos.occupied ^ Bitboards::bit(king) ^ Bitboards::bit(to)
+                    ^ Bitboards::bit(rook) ^ Bitboards::bit(rookDestination);
+
+  typename Piece::Color them = Piece::oppositeColor(m_state.turn());
+  return !pos.attackers(to, them, m_state.direction(them).y, occupied);
+}
+
+template <typename LegalityCheck>
+bool BitboardMoveGenerator<LegalityCheck>::
+emit(int from, int to, typename Move::Type type, MoveCallback& callback, int promotion) const {
+  Move move(Bitboards::point(from), Bitboards::point(to), promotion);
+  move.setType(type);
+  return callback(move);
+}
+
+template <typename LegalityCheck>
+bool BitboardMoveGenerator<LegalityCheck>::
+emitPawn(int from, int to, typename Move::Type type, MoveCallback& callback) const {
+  if (Bitboards::point(to).y != m_state.promotionRank(m_state.turn()))
+    return emit(from, to, type, callback);
+
+  return emit(from, to, Move::PROMOTION, callback, Piece::QUEEN) &&
+         emit(from, to, Move::PROMOTION, callback, Piece::ROOK) &&
+         emit(from, to, Move::PROMOTION, callback, Piece::KNIGHT) &&
+         emit(from, to, Move::PROMOTION, callback, Piece::BISHOP);
+}
+
+template <typename LegalityCheck>
+bool BitboardMoveGenerator<LegalityCheck>::dropTargets(Bitboard& targets) const {
+  BitboardPosition pos;
+  if (!load(pos))
+    return false;
+
+  typename Piece::Color us = m_state.turn();
+  typename Piece::Color them = Piece::oppositeColor(us);
+  Bitboard king = pos.pieces[us][Piece::KING];
+  if (!king) {
+    targets = 0;
+    return true;
+  }
+
+  int king_square = Bitboards::first(king);
+  Bitboard checkers = pos.attackers(king_square, them,
+                                    m_state.direction(them).y, pos.occupied);
+  targets = ~pos.occupied;
+  if (Bitboards::several(checkers))
+    targets = 0;
+  else if (checkers)
+    targets &= Bitboards::between(king_square, Bitboards::first(checkers));
+
+  return true;
+}
+
+} // namespace Chess
+} // namespace HLVariant
+
+#endif // HLVARIANT__CHESS__BITBOARDMOVEGENERATOR_H
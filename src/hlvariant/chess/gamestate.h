@@ -15,6 +15,8 @@
 #include "piece.h"
 #include "move.h"
 #include "nopool.h"
+#include "../zobrist.h"
+#include "../attacktable.h"
 #include "export.h"
 
 namespace HLVariant {
@@ -38,11 +40,24 @@ public:
   typedef _Move Move;
   typedef typename Board::Piece Piece;
   typedef NoPool Pool;
+  
+  /**
+    * The part of the state that a move destroys,
+    * saved so that the move can be taken back.
+    */
+  struct UndoInfo {
+    Piece moved;
+    Piece captured;
+    CastlingData castling;
+    Point enPassant;
+    typename Piece::Color turn;
+  };
 protected:
   Board m_board;
   CastlingData m_castling;
   Point m_en_passant;
   typename Piece::Color m_turn;
+  AttackTableHolder m_attacks;
 public:
   GameState();
   GameState(typename Piece::Color, bool, bool, bool, bool, const Point&);
@@ -55,6 +70,18 @@ public:
   
   virtual bool operator==(const GameState<Board, Move>& other) const;
   
+  /**
+    * \return A Zobrist key for this state, covering the board,
+    *         the turn, castling rights and the en passant square.
+    */
+  virtual quint64 hash() const;
+  
+  /**
+    * \return A cache of facts about the recent positions of this state, which
+    *         legality checks and move generators fill lazily.
+    */
+  virtual AttackTable& attackTable() const;
+  
   virtual Point enPassant() const;
   virtual bool kingCastling(typename Piece::Color color) const;
   virtual bool queenCastling(typename Piece::Color color) const;
@@ -64,6 +91,19 @@ public:
   virtual void handleCastling(const Piece& piece, const Move& m);
   virtual void captureOn(const Point& p);
   
+  /**
+    * \return The information needed to take back @a m.
+    * \note Call this before executing @a m.
+    */
+  virtual UndoInfo undoInfo(const Move& m) const;
+  
+  /**
+    * Take back a move, restoring the state as it was before calling move().
+    * This is much cheaper than copying the whole state to try a move.
+    * \param undo The information returned by undoInfo() before executing @a m.
+    */
+  virtual void unmove(const Move& m, const UndoInfo& undo);
+  
   virtual void setTurn(typename Piece::Color color);
   virtual typename Piece::Color previousTurn() const;
   virtual void switchTurn();
@@ -100,6 +140,9 @@ Board& GameState<Board, Move>::board() { return m_board; }
 template <typename Board, typename Move>
 const Board& GameState<Board, Move>::board() const { return m_board; }
 
+template <typename Board, typename Move>
+AttackTable& GameState<Board, Move>::attackTable() const { return m_attacks.get(); }
+
 template <typename Board, typename Move>
 Point GameState<Board, Move>::enPassant() const {
   return m_en_passant;
@@ -152,6 +195,25 @@ bool GameState<Board, Move>::operator==(const GameState<Board, Move>& other) con
          m_en_passant == other.m_en_passant;
 }
 
+template <typename Board, typename Move>
+quint64 GameState<Board, Move>::hash() const {
+  quint64 res = m_board.hash() ^ Zobrist::turn(m_turn);
+  
+  if (m_castling.wk)
+    res ^= Zobrist::castling(0);
+  if (m_castling.wq)
+    res ^= Zobrist::castling(1);
+  if (m_castling.bk)
+    res ^= Zobrist::castling(2);
+  if (m_castling.bq)
+    res ^= Zobrist::castling(3);
+  
+  if (m_en_passant.valid())
+    res ^= Zobrist::enPassant(m_en_passant.x + m_en_passant.y * m_board.size().x);
+    
+  return res;
+}
+
 template <typename Board, typename Move>
 void GameState<Board, Move>::captureOn(const Point& p) {
   m_board.set(p, Piece());
@@ -228,6 +290,36 @@ void GameState<Board, Move>::move(const Move& m) {
   switchTurn();
 }
 
+template <typename Board, typename Move>
+typename GameState<Board, Move>::UndoInfo
+GameState<Board, Move>::undoInfo(const Move& m) const {
+  UndoInfo undo;
+  undo.moved = m_board.get(m.from());
+  undo.captured = m_board.get(m.captureSquare());
+  undo.castling = m_castling;
+  undo.enPassant = m_en_passant;
+  undo.turn = m_turn;
+  return undo;
+}
+
+template <typename Board, typename Move>
+void GameState<Board, Move>::unmove(const Move& m, const UndoInfo& undo) {
+  if (undo.moved != Piece()) {
+    if (m.kingSideCastling())
+      basicMove(Move(m.from() + Point(1, 0), m.to() + Point(1, 0)));
+    else if (m.queenSideCastling())
+      basicMove(Move(m.from() - Point(1, 0), m.to() - Point(2, 0)));
+    
+    m_board.set(m.to(), Piece());
+    m_board.set(m.captureSquare(), undo.captured);
+    m_board.set(m.from(), undo.moved);
+  }
+  
+  m_castling = undo.castling;
+  m_en_passant = undo.enPassant;
+  m_turn = undo.turn;
+}
+
 template <typename Board, typename Move>
 typename Board::Piece::Color GameState<Board, Move>::turn() const {
   return m_turn;
@@ -9,16 +9,11 @@
 */
 
 #include "icsverbose.h"
+#include "../notation.h"
 
 namespace HLVariant {
 namespace Chess {
 
-//                               1          2           3            5
-QRegExp ICSVerbose::pattern("([PRNBKQ])/([a-zA-Z]\\d+|@@)-([a-zA-Z]\\d+)(=([PRNBKQ]))?");
-QRegExp ICSVerbose::kingCastlingPattern("[oO0]-[oO0]");
-QRegExp ICSVerbose::queenCastlingPattern("[oO0]-[oO0]-[oO0]");
-QRegExp ICSVerbose::nonePattern("none");
-
 ICSVerbose::ICSVerbose()
 : from(Point::invalid())
 , to(Point::invalid())
@@ -26,29 +21,53 @@ ICSVerbose::ICSVerbose()
 , castling(SAN::NoCastling) { }
 
 
+// piece/from-to[=promotion], where from is @@ for drops
+bool ICSVerbose::loadMove(const QString& str, int ysize) {
+  using namespace Notation;
+
+  if (!isOneOf(at(str, 0), "PRNBKQ") || at(str, 1) != '/')
+    return false;
+
+  const bool drop = matches(str, 2, "@@");
+  int from_end;
+  if (drop)
+    from_end = 4;
+  else if (isLetter(at(str, 2)) && isDigit(at(str, 3)))
+    from_end = skipDigits(str, 3);
+  else
+    return false;
+
+  const int to_begin = from_end + 1;
+  if (at(str, from_end) != '-' || !isLetter(at(str, to_begin)) || !isDigit(at(str, to_begin + 1)))
+    return false;
+  const int to_end = skipDigits(str, to_begin + 1);
+
+  from = drop ? Point::invalid() : point(str, 2, from_end, ysize);
+  to = point(str, to_begin, to_end, ysize);
+  type = SAN::getType(str[0]);
+  if (at(str, to_end) == '=' && isOneOf(at(str, to_end + 1), "PRNBKQ"))
+    promotion = SAN::getType(str[to_end + 1]);
+  else
+    promotion = -1;
+  castling = SAN::NoCastling;
+  return true;
+}
+
 void ICSVerbose::load(const QString& str, int ysize) {
-  if (nonePattern.indexIn(str) == 0) {
+  using namespace Notation;
+
+  if (matches(str, 0, "none")) {
     from = Point::invalid();
     to = Point::invalid();
   }
-  else if (pattern.indexIn(str) == 0) {
-    if (pattern.cap(2) == "@@")
-      from = Point::invalid();
-    else
-      from = Point(pattern.cap(2), ysize);
-
-    to = Point(pattern.cap(3), ysize);
-
-    type = SAN::getType(pattern.cap(1));
-    if (!pattern.cap(5).isEmpty())
-      promotion = SAN::getType(pattern.cap(6));
-    else
-      promotion = -1;
-    castling = SAN::NoCastling;
+  else if (loadMove(str, ysize)) {
   }
-  else if (queenCastlingPattern.indexIn(str) == 0)
+  else if (isOneOf(at(str, 0), "oO0") && at(str, 1) == '-' &&
+           isOneOf(at(str, 2), "oO0") && at(str, 3) == '-' &&
+           isOneOf(at(str, 4), "oO0"))
     castling = SAN::QueenSide;
-  else if (kingCastlingPattern.indexIn(str) == 0)
+  else if (isOneOf(at(str, 0), "oO0") && at(str, 1) == '-' &&
+           isOneOf(at(str, 2), "oO0"))
     castling = SAN::KingSide;
   else {
     from = Point::invalid();
@@ -16,12 +16,12 @@
 namespace HLVariant {
 namespace Chess {
 
+/**
+  * A move in the verbose notation of style12 lines, like P/e2-e4.
+  * Parsing keeps no state outside of the object being loaded.
+  */
 class ICSVerbose {
-  static QRegExp pattern;
-  static QRegExp kingCastlingPattern;
-  static QRegExp queenCastlingPattern;
-  static QRegExp nonePattern;
-
+  bool loadMove(const QString&, int ysize);
 public:
   ICSVerbose();
   void load(const QString&, int ysize);
@@ -11,6 +11,7 @@
 #ifndef HLVARIANT__CHESS__LEGALITYCHECK_H
 #define HLVARIANT__CHESS__LEGALITYCHECK_H
 
+#include <boost/shared_ptr.hpp>
 #include "gamestate.h"
 #include "interactiontype.h"
 #include "turnpolicy.h"
@@ -27,6 +28,46 @@ public:
   typedef typename GameState::Piece Piece;
 protected:
   const GameState& m_state;
+private:
+  mutable boost::shared_ptr<GameState> m_scratch;
+protected:
+  /**
+    * \return A copy of the state, where moves can be tried and taken back
+    *         without touching the state being checked. The copy is made
+    *         on first use, and reused as long as the state is unchanged.
+    */
+  GameState& scratch() const;
+
+  /**
+    * \return The attack map of the current position, filled on first use.
+    */
+  AttackTable::Map& attackMap() const;
+
+  /**
+    * Mark all squares where each side can capture, and the king squares,
+    * in a single pass over the board.
+    */
+  virtual void computeAttackMap(AttackTable::Map& map) const;
+
+  /**
+    * Look for pieces of @a color able to move to @a p, bypassing
+    * the attack table. Only the knight jumps around @a p and the first
+    * piece along each line through it are considered, so variants
+    * with other kinds of pieces need to override this.
+    */
+  virtual bool computeAttacks(
+            typename Piece::Color color,
+            const Point& p,
+            const Piece& target) const;
+private:
+  bool attacksFrom(typename Piece::Color color,
+                   const Point& from,
+                   const Point& to,
+                   const Piece& target) const;
+  void markSlide(AttackTable::Map& map,
+                 typename Piece::Color color,
+                 const Point& from,
+                 const Point& dir) const;
 public:
   LegalityCheck(const GameState& state);
   virtual ~LegalityCheck();
@@ -37,10 +78,23 @@ public:
             const Piece& target = Piece()) const;
   virtual bool pseudolegal(Move& move) const;
   virtual bool legal(Move& move) const;
+  
+  /**
+    * \return Whether a piece of @a color can capture @a target on @a p,
+    *         where an invalid target means the piece currently on @a p.
+    * \note Captures are looked up in the attack map of the position,
+    *       other queries are checked directly.
+    */
   virtual bool attacks(
             typename Piece::Color color, 
             const Point& p,
             const Piece& target = Piece()) const;
+  
+  /**
+    * \return The square of the king of @a color, or an invalid point.
+    * \note The result comes from the attack map of the position.
+    */
+  virtual Point kingPosition(typename Piece::Color color) const;
   virtual bool checkPromotion(typename Piece::Type type) const;
   
   virtual typename Piece::Color mover(const Move& move) const;
@@ -57,24 +111,37 @@ template <typename GameState>
 LegalityCheck<GameState>::LegalityCheck(const GameState& state)
 : m_state(state) { }
 
+template <typename GameState>
+GameState& LegalityCheck<GameState>::scratch() const {
+  if (!m_scratch)
+    m_scratch.reset(new GameState(m_state));
+  else if (m_scratch->hash() != m_state.hash())
+    *m_scratch = m_state;
+  return *m_scratch;
+}
+
 template <typename GameState>
 bool LegalityCheck<GameState>::legal(Move& move) const {
   if (pseudolegal(move)) {
     typename Piece::Color turn = mover(move);
-    
-    GameState tmp(m_state);
-    tmp.move(move);
-    
-    Point kingPos = tmp.board().find(Piece(turn, Piece::KING));
-    
-    if (kingPos == Point::invalid())
-      return false;
+    bool kingMoves = m_state.board().get(move.from()).type() == Piece::KING;
+    Point kingPos = kingMoves ? Point::invalid() : kingPosition(turn);
+
+    // try the move on a copy, and take it back afterwards
+    GameState& state = scratch();
+    typename GameState::UndoInfo undo = state.undoInfo(move);
+    state.move(move);
+
+    // the new position is only looked at once, so do not fill a map for it
+    if (kingMoves)
+      kingPos = state.board().find(Piece(turn, Piece::KING));
+    LegalityCheck<GameState> tmpLegality(state);
+    bool res = kingPos != Point::invalid() &&
+               !tmpLegality.computeAttacks(Piece::oppositeColor(turn),
+                                           kingPos, state.board().get(kingPos));
       
-    LegalityCheck<GameState> tmpLegality(tmp);
-    if (tmpLegality.attacks(Piece::oppositeColor(turn), kingPos))
-      return false;
-      
-    return true;
+    state.unmove(move, undo);
+    return res;
   }
   else {
     return false;
@@ -190,7 +257,7 @@ getMoveType(const Piece& piece, const Move& move, const Piece& _target) const {
       }
       else if (delta == Point(-2,0)) {
         if (m_state.board().get(move.from() - Point(1, 0)) == Piece() &&
-            m_state.board().get(move.to() + Point(1, 0)) == Piece() &&
+            m_state.board().get(move.to() - Point(1, 0)) == Piece() &&
             m_state.board().get(move.to()) == Piece() &&
             m_state.queenCastling(piece.color()))
             return Move::QUEEN_SIDE_CASTLING;
@@ -244,20 +311,146 @@ getMoveType(const Piece& piece, const Move& move, const Piece& _target) const {
 }
 
 template <typename GameState>
-bool LegalityCheck<GameState>::attacks(typename Piece::Color color, const Point& to, const Piece& target) const {
-  for (int i = 0; i < m_state.board().size().x; i++) {
-    for (int j = 0; j < m_state.board().size().y; j++) {
+bool LegalityCheck<GameState>::attacks(typename Piece::Color color, const Point& to, const Piece& _target) const {
+  Piece target = _target == Piece() ? m_state.board().get(to) : _target;
+
+  // the map only knows about captures
+  if (!m_state.board().valid(to) ||
+      (color != Piece::WHITE && color != Piece::BLACK) ||
+      target == Piece() || target.color() == color)
+    return computeAttacks(color, to, target);
+
+  return attackMap().attacked(to, color);
+}
+
+template <typename GameState>
+AttackTable::Map& LegalityCheck<GameState>::attackMap() const {
+  AttackTable::Map& map = m_state.attackTable().map(m_state.hash(), m_state.board().size());
+  if (!map.filled()) {
+    computeAttackMap(map);
+    map.setFilled();
+  }
+  return map;
+}
+
+template <typename GameState>
+void LegalityCheck<GameState>::computeAttackMap(AttackTable::Map& map) const {
+  static const Point knight[] = {
+    Point(1, 2), Point(1, -2), Point(-1, 2), Point(-1, -2),
+    Point(2, 1), Point(2, -1), Point(-2, 1), Point(-2, -1) };
+  // orthogonal directions first, then diagonals
+  static const Point lines[] = {
+    Point(1, 0), Point(-1, 0), Point(0, 1), Point(0, -1),
+    Point(1, 1), Point(1, -1), Point(-1, 1), Point(-1, -1) };
+
+  const Board& board = m_state.board();
+  for (int i = 0; i < board.size().x; i++) {
+    for (int j = 0; j < board.size().y; j++) {
       Point p(i, j);
-      Piece piece = m_state.board().get(p);
-      Move move(p, to);
-      if (piece != Piece() && piece.color() == color 
-          && getMoveType(piece, move, target) != Move::INVALID)
-        return true;
+      Piece piece = board.get(p);
+      typename Piece::Color color = piece.color();
+      if (piece == Piece() || (color != Piece::WHITE && color != Piece::BLACK))
+        continue;
+
+      switch (piece.type()) {
+      case Piece::PAWN:
+        {
+          Point dir = m_state.direction(color);
+          for (int k = -1; k <= 1; k += 2) {
+            Point q = p + dir + Point(k, 0);
+            if (board.valid(q))
+              map.setAttacked(q, color);
+          }
+        }
+        break;
+      case Piece::KNIGHT:
+        for (int k = 0; k < 8; k++) {
+          if (board.valid(p + knight[k]))
+            map.setAttacked(p + knight[k], color);
+        }
+        break;
+      case Piece::BISHOP:
+        for (int k = 4; k < 8; k++)
+          markSlide(map, color, p, lines[k]);
+        break;
+      case Piece::ROOK:
+        for (int k = 0; k < 4; k++)
+          markSlide(map, color, p, lines[k]);
+        break;
+      case Piece::QUEEN:
+        for (int k = 0; k < 8; k++)
+          markSlide(map, color, p, lines[k]);
+        break;
+      case Piece::KING:
+        // the first king found, like Board::find
+        if (!map.royal(color).valid() && piece == Piece(color, Piece::KING))
+          map.setRoyal(color, p);
+        for (int k = 0; k < 8; k++) {
+          if (board.valid(p + lines[k]))
+            map.setAttacked(p + lines[k], color);
+        }
+        break;
+      default:
+        break;
+      }
     }
   }
+}
+
+template <typename GameState>
+void LegalityCheck<GameState>::markSlide(AttackTable::Map& map, typename Piece::Color color,
+                                         const Point& from, const Point& dir) const {
+  const Board& board = m_state.board();
+  for (Point q = from + dir; board.valid(q); q += dir) {
+    map.setAttacked(q, color);
+    if (board.get(q) != Piece())
+      break;
+  }
+}
+
+template <typename GameState>
+bool LegalityCheck<GameState>::computeAttacks(typename Piece::Color color, const Point& to, const Piece& target) const {
+  static const Point knight[] = {
+    Point(1, 2), Point(1, -2), Point(-1, 2), Point(-1, -2),
+    Point(2, 1), Point(2, -1), Point(-2, 1), Point(-2, -1) };
+  static const Point lines[] = {
+    Point(1, 0), Point(-1, 0), Point(0, 1), Point(0, -1),
+    Point(1, 1), Point(1, -1), Point(-1, 1), Point(-1, -1) };
+
+  const Board& board = m_state.board();
+  if (!board.valid(to))
+    return false;
+
+  for (int k = 0; k < 8; k++) {
+    if (attacksFrom(color, to + knight[k], to, target))
+      return true;
+
+    // pieces behind the first one on a line are blocked
+    Point p = to + lines[k];
+    while (board.valid(p) && board.get(p) == Piece())
+      p += lines[k];
+    if (attacksFrom(color, p, to, target))
+      return true;
+  }
   return false;
 }
 
+template <typename GameState>
+bool LegalityCheck<GameState>::attacksFrom(typename Piece::Color color, const Point& from,
+                                           const Point& to, const Piece& target) const {
+  Piece piece = m_state.board().get(from);
+  return piece != Piece() && piece.color() == color &&
+         getMoveType(piece, Move(from, to), target) != Move::INVALID;
+}
+
+template <typename GameState>
+Point LegalityCheck<GameState>::kingPosition(typename Piece::Color color) const {
+  if (color != Piece::WHITE && color != Piece::BLACK)
+    return m_state.board().find(Piece(color, Piece::KING));
+
+  return attackMap().royal(color);
+}
+
 template <typename GameState>
 bool LegalityCheck<GameState>::checkPromotion(typename Piece::Type type) const {
   return type == -1 ||
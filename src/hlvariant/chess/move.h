@@ -29,29 +29,57 @@ public:
     PROMOTION
   };
 private:
-  Type m_type;
+  /**
+    * A move is packed in 32 bits. Coordinates must lie between -16 and 15,
+    * which is enough for the squares of boards up to 14x14, and for
+    * the off-board targets generators produce near their border.
+    */
+  signed int m_type : 4;
+  signed int m_from_x : 5;
+  signed int m_from_y : 5;
+  signed int m_to_x : 5;
+  signed int m_to_y : 5;
+  signed int m_promotion : 8;
   
-  Point m_from;
-  Point m_to;
-  int m_promotion;
+  static bool fits(const Point& p) {
+    return p.x >= -16 && p.x <= 15 && p.y >= -16 && p.y <= 15;
+  }
 public:
-  Move();
-  Move(const Point& from, const Point& to, int promotionType = -1);
-  virtual ~Move();
+  Move()
+  : m_type(INVALID)
+  , m_from_x(-1), m_from_y(-1)
+  , m_to_x(-1), m_to_y(-1)
+  , m_promotion(-1) { }
   
-  virtual Point enPassantTrigger() const;
-  virtual Point captureSquare() const;
-  virtual int promoteTo() const;
-  virtual bool kingSideCastling() const;
-  virtual bool queenSideCastling() const;
+  Move(const Point& from, const Point& to, int promotionType = -1)
+  : m_type(NORMAL)
+  , m_from_x(from.x), m_from_y(from.y)
+  , m_to_x(to.x), m_to_y(to.y)
+  , m_promotion(promotionType) {
+    // coordinates out of range would wrap onto real squares
+    if (!fits(from) || !fits(to))
+      *this = Move();
+  }
   
-  virtual Point from() const;
-  virtual Point to() const;
-  virtual bool valid() const;
+  Point enPassantTrigger() const;
+  Point captureSquare() const;
+  int promoteTo() const { return m_type == PROMOTION ? m_promotion : -1; }
+  bool kingSideCastling() const { return m_type == KING_SIDE_CASTLING; }
+  bool queenSideCastling() const { return m_type == QUEEN_SIDE_CASTLING; }
   
-  virtual void setType(Type type);
+  Point from() const { return Point(m_from_x, m_from_y); }
+  Point to() const { return Point(m_to_x, m_to_y); }
+  bool valid() const { 
+    return (m_to_x != -1 || m_to_y != -1) && m_type != INVALID;
+  }
   
-  virtual bool operator==(const Move& move) const;
+  void setType(Type type) { m_type = type; }
+  
+  bool operator==(const Move& move) const {
+    return m_from_x == move.m_from_x && m_from_y == move.m_from_y &&
+           m_to_x == move.m_to_x && m_to_y == move.m_to_y &&
+           m_promotion == move.m_promotion;
+  }
 };
 
 } // namespace Chess
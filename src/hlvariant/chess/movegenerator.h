@@ -23,6 +23,9 @@ public:
   typedef typename LegalityCheck::GameState GameState;
   typedef typename GameState::Move Move;
   typedef typename GameState::Board::Piece Piece;
+
+  /** generate() lists every legal move */
+  static const bool canGenerate = true;
   
   class MoveCallback {
   public:
@@ -32,6 +35,9 @@ public:
 protected:
   const GameState& m_state;
   
+  /** checks candidate moves, kept so that its scratch copy is made once */
+  LegalityCheck m_check;
+  
   class FindMove : public MoveCallback {
     bool m_found;
   public:
@@ -58,28 +64,35 @@ public:
 
 template <typename LegalityCheck>
 MoveGenerator<LegalityCheck>::MoveGenerator(const GameState& state)
-: m_state(state) { }
+: m_state(state)
+, m_check(state) { }
 
 template <typename LegalityCheck>
 MoveGenerator<LegalityCheck>::~MoveGenerator() { }
 
 template <typename LegalityCheck>
 bool MoveGenerator<LegalityCheck>::check(typename Piece::Color turn) const {
-  Point kingPosition = m_state.board().find(Piece(turn, Piece::KING));
+  Point kingPosition = m_check.kingPosition(turn);
   if (!kingPosition.valid()) {
     // a missing king is considered in check
     return true;
   }
   else {
-    LegalityCheck check(m_state);
-    return check.attacks(Piece::oppositeColor(turn), kingPosition);
+    return m_check.attacks(Piece::oppositeColor(turn), kingPosition);
   }
 }
 
 template <typename LegalityCheck>
 bool MoveGenerator<LegalityCheck>::stalled() const {
+  AttackTable::Map& map = m_state.attackTable().map(m_state.hash(), m_state.board().size());
+  int cached = map.stalled();
+  if (cached != AttackTable::Unknown)
+    return cached;
+  
   FindMove findMove;
   generate(findMove);
+  
+  map.setStalled(!findMove.found());
   return !findMove.found();
 }
 
@@ -173,9 +186,8 @@ generateSlide(const Point& p, const Point& dir, MoveCallback& callback) const {
 
 template <typename LegalityCheck>
 bool MoveGenerator<LegalityCheck>::addMove(const Move& m, MoveCallback& callback) const {
-  LegalityCheck check(m_state);
   Move move(m);
-  if (check.legal(move)) {
+  if (m_check.legal(move)) {
     return callback(move);
   }
   
@@ -14,17 +14,7 @@
 namespace HLVariant {
 namespace Chess {
 
-Piece::~Piece() { }
-
-Piece::Piece(Color color, Type type)
-: m_color(color)
-, m_type(type) { }
-
-Piece::Color Piece::color() const { return m_color; }
-
-Piece::Type Piece::type() const { return m_type; }
-
-QString Piece::colorName() const { return colorName(m_color); }
+QString Piece::colorName() const { return colorName(color()); }
 
 QString Piece::colorName(Color color) {
   switch (color) {
@@ -37,7 +27,7 @@ QString Piece::colorName(Color color) {
   }
 }
 
-QString Piece::typeName() const { return typeName(m_type); }
+QString Piece::typeName() const { return typeName(type()); }
 
 QString Piece::typeName(Type type) {
   switch (type) {
@@ -73,15 +63,6 @@ Piece::Color Piece::oppositeColor(Color color) {
   }
 }
 
-bool Piece::operator==(const Piece& other) const {
-  return m_color == other.m_color &&
-         m_type == other.m_type;
-}
-
-bool Piece::operator!=(const Piece& other) const {
-  return !((*this) == other);
-}
-
 Piece Piece::fromDescription(const QString& description) {
   if (description.size() == 1) {
     QChar c = description[0];
@@ -34,26 +34,59 @@ public:
     KING
   };
 private:
-  Color m_color;
-  Type m_type;
+  /**
+    * A piece is packed in a single byte, so that boards are small
+    * and can be copied and compared as plain memory.
+    * Bits 0-2 hold the type and bits 3-4 the color, both offset by 1,
+    * so that an invalid piece is 0. The remaining bits are left
+    * to subclasses, see flags().
+    */
+  unsigned char m_data;
+protected:
+  enum {
+    TYPE_MASK = 0x07,
+    COLOR_SHIFT = 3,
+    COLOR_MASK = 0x18,
+    FLAGS_SHIFT = 5
+  };
+  
+  /**
+    * \return Up to 3 bits of additional information stored by subclasses.
+    */
+  int flags() const { return m_data >> FLAGS_SHIFT; }
+  void setFlags(int flags) {
+    m_data = (m_data & (TYPE_MASK | COLOR_MASK)) | (flags << FLAGS_SHIFT);
+  }
 public:
-  Piece(Color color = INVALID_COLOR, Type type = INVALID_TYPE);
-  virtual ~Piece();
+  Piece(Color color = INVALID_COLOR, Type type = INVALID_TYPE)
+  : m_data(((color + 1) << COLOR_SHIFT) | (type + 1)) { }
   
-  virtual Color color() const;
-  virtual Type type() const;
+  Color color() const { 
+    return static_cast<Color>(((m_data & COLOR_MASK) >> COLOR_SHIFT) - 1);
+  }
+  Type type() const { return static_cast<Type>((m_data & TYPE_MASK) - 1); }
   
-  virtual QString colorName() const;
+  QString colorName() const;
   static QString colorName(Color color);
-  virtual QString typeName() const;
+  QString typeName() const;
   static QString typeName(Type type);
-  virtual QString name() const;
+  QString name() const;
   
   static Color oppositeColor(Color color);
   static Piece fromDescription(const QString& description);
   
-  virtual bool operator==(const Piece& other) const;
-  virtual bool operator!=(const Piece& other) const;
+  /**
+    * Compare color and type, ignoring subclass flags.
+    */
+  bool operator==(const Piece& other) const {
+    return ((m_data ^ other.m_data) & (TYPE_MASK | COLOR_MASK)) == 0;
+  }
+  bool operator!=(const Piece& other) const { return !((*this) == other); }
+  
+  /**
+    * \return A small integer identifying this piece, 0 for an invalid piece.
+    */
+  int hashCode() const { return (color() + 1) * 16 + type() + 1; }
 };
 
 } // namespace Chess
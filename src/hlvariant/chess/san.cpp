@@ -10,18 +10,11 @@
 
 #include "san.h"
 #include "piece.h"
+#include "../notation.h"
 
 namespace HLVariant {
 namespace Chess {
 
-//                         1           2                   3
-QRegExp SAN::pattern("^([PRNBKQ])?([a-wyzA-Z]?\\d*|x\\d+)([-x@])?"
-//                         4         5        6
-                     "([a-zA-Z]\\d+)(=?([RNBKQrnbkq]))?[+#]?[\?!]*");
-QRegExp SAN::kingCastlingPattern("^[oO0]-?[oO0][+#]?");
-QRegExp SAN::queenCastlingPattern("^[oO0]-?[oO0]-?[oO0][+#]?");
-QRegExp SAN::nonePattern("^none");
-
 SAN::SAN()
 : from(Point::invalid())
 , to(Point::invalid())
@@ -34,8 +27,11 @@ SAN::SAN()
 int SAN::getType(const QString& letter) {
   if (letter.isEmpty())
     return Piece::PAWN;
-    
-  switch(letter[0].toLower().toAscii()) {
+  return getType(letter[0]);
+}
+
+int SAN::getType(QChar letter) {
+  switch(letter.toLower().toAscii()) {
   case 'k':
     return Piece::KING;
   case 'q':
@@ -53,33 +49,106 @@ int SAN::getType(const QString& letter) {
   }
 }
 
+// Moves have the form
+//   [piece] [from] [- x @] to [[=] promotion] [+ #] [? !]...
+// where from is an optional column letter other than x followed by
+// an optional row number, or x followed by a row number.
+// As in a backtracking regular expression match, the first reading
+// of the string which yields a destination square is taken.
+bool SAN::loadMove(const QString& str, int& offset, int ysize) {
+  using namespace Notation;
+
+  for (int with_piece = 1; with_piece >= 0; with_piece--) {
+    int piece = offset;
+    if (with_piece && !isOneOf(at(str, piece), "PRNBKQ"))
+      continue;
+
+    const int from_begin = piece + with_piece;
+    ushort c = at(str, from_begin);
+
+    // candidate ends of the from square, in order of preference
+    int from_ends[32];
+    int n = 0;
+    for (int letter = (isLetter(c) && c != 'x') ? 1 : 0; letter >= 0; letter--) {
+      int digits = from_begin + letter;
+      for (int end = skipDigits(str, digits); end >= digits && n < 32; end--)
+        from_ends[n++] = end;
+    }
+    if (c == 'x') {
+      for (int end = skipDigits(str, from_begin + 1); end > from_begin + 1 && n < 32; end--)
+        from_ends[n++] = end;
+    }
+
+    for (int i = 0; i < n; i++) {
+      const int from_end = from_ends[i];
+      ushort separator = at(str, from_end);
+      for (int sep = isOneOf(separator, "-x@") ? 1 : 0; sep >= 0; sep--) {
+        const int to_begin = from_end + sep;
+        if (!isLetter(at(str, to_begin)) || !isDigit(at(str, to_begin + 1)))
+          continue;
+        const int to_end = skipDigits(str, to_begin + 1);
+
+        int end = to_end;
+        promotion = -1;
+        if (at(str, end) == '=' && isOneOf(at(str, end + 1), "RNBKQrnbkq")) {
+          promotion = getType(str[end + 1]);
+          end += 2;
+        }
+        else if (isOneOf(at(str, end), "RNBKQrnbkq")) {
+          promotion = getType(str[end]);
+          end++;
+        }
+        if (isOneOf(at(str, end), "+#"))
+          end++;
+        while (isOneOf(at(str, end), "?!"))
+          end++;
+
+        type = with_piece ? getType(str[piece]) : static_cast<int>(Piece::PAWN);
+        drop = sep && separator == '@';
+        from = drop ? Point::invalid() : point(str, from_begin, from_end, ysize);
+        to = point(str, to_begin, to_end, ysize);
+        castling = NoCastling;
+        offset = end;
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+bool SAN::loadCastling(const QString& str, int& offset, int count) {
+  using namespace Notation;
+
+  // O-O or O-O-O, dashes being optional
+  int i = offset;
+  for (int k = 0; k < count; k++) {
+    if (k > 0 && at(str, i) == '-')
+      i++;
+    if (!isOneOf(at(str, i), "oO0"))
+      return false;
+    i++;
+  }
+  if (isOneOf(at(str, i), "+#"))
+    i++;
+
+  offset = i;
+  return true;
+}
+
 void SAN::load(const QString& str, int& offset, int ysize) {
-  if (nonePattern.indexIn(str, offset, QRegExp::CaretAtOffset) != -1) {
+  if (Notation::matches(str, offset, "none")) {
     from = Point::invalid();
     to = Point::invalid();
-    offset += nonePattern.matchedLength();
+    offset += 4;
   }
-  else if (pattern.indexIn(str, offset, QRegExp::CaretAtOffset) != -1) {
-    type = getType(pattern.cap(1));
-    drop = pattern.cap(3) == "@";
-    if (drop)
-      from = Point::invalid();
-    else
-      from = Point(pattern.cap(2), ysize);
-    to = Point(pattern.cap(4), ysize);
-    promotion = pattern.cap(6).isEmpty() ? -1 : getType(pattern.cap(6));
-    castling = NoCastling;
-    offset += pattern.matchedLength();
+  else if (loadMove(str, offset, ysize)) {
   }
-  else if (queenCastlingPattern.indexIn(str, offset, QRegExp::CaretAtOffset) != -1) {
+  else if (loadCastling(str, offset, 3)) {
     castling = QueenSide;
-
-    offset += queenCastlingPattern.matchedLength();
   }
-  else if (kingCastlingPattern.indexIn(str, offset, QRegExp::CaretAtOffset) != -1) {
+  else if (loadCastling(str, offset, 2)) {
     castling = KingSide;
-
-    offset += kingCastlingPattern.matchedLength();
   }
   else {
     //kDebug() << "error!!!! " << str.mid(offset);
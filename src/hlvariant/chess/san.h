@@ -13,7 +13,6 @@
 
 #include <iostream>
 
-#include <QRegExp>
 #include <QDebug>
 #include "export.h"
 #include "point.h"
@@ -21,14 +20,16 @@
 namespace HLVariant {
 namespace Chess {
 
+/**
+  * A move in standard algebraic notation.
+  * Parsing keeps no state outside of the object being loaded,
+  * so different objects can be loaded concurrently.
+  */
 class TAGUA_EXPORT SAN {
   friend QDebug operator<<(QDebug os, const SAN& move);
 
-  static QRegExp pattern;
-  static QRegExp kingCastlingPattern;
-  static QRegExp queenCastlingPattern;
-  static QRegExp nonePattern;
-  
+  bool loadMove(const QString&, int& offset, int ysize);
+  static bool loadCastling(const QString&, int& offset, int count);
 public:
   enum CastlingType {
       NoCastling,
@@ -39,6 +40,7 @@ public:
   SAN();
 
   static int getType(const QString& letter);
+  static int getType(QChar letter);
 
   void load(const QString&, int& offset, int ysize);
   void load(const QString&, int ysize);
@@ -14,6 +14,7 @@
 #include <boost/function.hpp>
 
 #include "legalitycheck.h"
+#include "../movelist.h"
 #include "san.h"
 #include "icsverbose.h"
 
@@ -29,7 +30,12 @@ protected:
   typedef typename GameState::Board::Piece Piece;
   
   QString m_rep;
-
+  
+  /** legal moves of the positions seen, if the generator can list them */
+  MoveList<MoveGenerator>* m_moves;
+  
+  /** resolve @a san by looking it up among the legal moves */
+  Move find_san(const SAN& san, const GameState& ref);
 protected:
   virtual QString suffix(const Move& move, const GameState& ref);
   
@@ -46,8 +52,12 @@ public:
   /** 
     * Create a serializer to a given string representation for moves.
     * \param rep A move representation type.
+    * \param moves A list of legal moves, used to resolve and disambiguate
+    *              moves and to detect mate instead of testing moves one
+    *              by one. Serializers of the same position should share
+    *              it, so that its moves are generated only once.
     */
-  Serializer(const QString& rep);
+  Serializer(const QString& rep, MoveList<MoveGenerator>* moves = 0);
   
   virtual ~Serializer();
   
@@ -74,8 +84,9 @@ public:
 // IMPLEMENTATION
 
 template <typename MoveGenerator>
-Serializer<MoveGenerator>::Serializer(const QString& rep)
-: m_rep(rep) { }
+Serializer<MoveGenerator>::Serializer(const QString& rep, MoveList<MoveGenerator>* moves)
+: m_rep(rep)
+, m_moves(MoveGenerator::canGenerate ? moves : 0) { }
 
 template <typename MoveGenerator>
 Serializer<MoveGenerator>::~Serializer() { }
@@ -165,16 +176,14 @@ QString Serializer<MoveGenerator>::suffix(const Move& move, const GameState& ref
   GameState tmp(ref);
   tmp.move(move);
   
+  QString res;
   MoveGenerator generator(tmp);
-  if (generator.check(Piece::oppositeColor(ref.turn()))) {
-    if (generator.stalled())
-      return "#";
-    else
-      return "+";
-  }
-  else {
-    return "";
+  if (generator.check(tmp.turn())) {
+    bool mate = m_moves ? m_moves->moves(tmp).empty() : generator.stalled();
+    res = mate ? "#" : "+";
   }
+  
+  return res;
 }
 
 template <typename MoveGenerator>
@@ -204,7 +213,11 @@ Serializer<MoveGenerator>::get_san(const SAN& san, const GameState& ref) {
   if (san.from.valid()) {
     candidate = Move(san.from, san.to, static_cast<typename Piece::Type>(san.promotion));
   }
+  else if (m_moves) {
+    candidate = find_san(san, ref);
+  }
   else {
+    LegalityCheck check(ref);
     for (int i = 0; i < ref.board().size().x; i++) {
       for (int j = 0; j < ref.board().size().y; j++) {
         Point p(i, j);
@@ -215,7 +228,6 @@ Serializer<MoveGenerator>::get_san(const SAN& san, const GameState& ref) {
             piece.type() == san.type && 
             piece.color() == ref.turn()) {
   
-          LegalityCheck check(ref);
           if (check.legal(mv))  {
             if (candidate.valid()) {
               // ambiguous!
@@ -234,6 +246,40 @@ Serializer<MoveGenerator>::get_san(const SAN& san, const GameState& ref) {
   return candidate;
 }
 
+template <typename MoveGenerator>
+typename Serializer<MoveGenerator>::Move 
+Serializer<MoveGenerator>::find_san(const SAN& san, const GameState& ref) {
+  Move candidate;
+  const std::vector<Move>& moves = m_moves->moves(ref);
+  for (unsigned int i = 0; i < moves.size(); i++) {
+    const Move& mv = moves[i];
+    if (mv.to() != san.to || 
+        !mv.from().valid() || 
+        mv.from() == candidate.from() ||
+        !mv.from().resembles(san.from) ||
+        ref.board().get(mv.from()).type() != san.type)
+      continue;
+    
+    if (candidate.valid()) {
+      // ambiguous!
+      return Move();
+    }
+    else {
+      // ok, we have found a candidate move
+      candidate = mv;
+    }
+  }
+  
+  if (candidate.valid() && candidate.promoteTo() != san.promotion) {
+    // generated promotions come in all flavours, pick the requested one
+    Move mv(candidate.from(), san.to, static_cast<typename Piece::Type>(san.promotion));
+    LegalityCheck check(ref);
+    candidate = check.legal(mv) ? mv : Move();
+  }
+  
+  return candidate;
+}
+
 template <typename MoveGenerator>
 typename Serializer<MoveGenerator>::Move 
 Serializer<MoveGenerator>::deserialize(const QString& str, const GameState& ref) {
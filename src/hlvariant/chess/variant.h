@@ -11,7 +11,7 @@
 #ifndef HLVARIANT__CHESS__VARIANT_H
 #define HLVARIANT__CHESS__VARIANT_H
 
-#include "movegenerator.h"
+#include "bitboardmovegenerator.h"
 #include "serializer.h"
 #include "export.h"
 #include "option.h"
@@ -27,7 +27,7 @@ namespace Chess {
 struct TAGUA_EXPORT Variant {
   typedef GameState<CustomBoard<8, 8, Piece>, Move> GameState;
   typedef LegalityCheck<GameState> LegalityCheck;
-  typedef MoveGenerator<LegalityCheck> MoveGenerator;
+  typedef BitboardMoveGenerator<LegalityCheck> MoveGenerator;
   typedef Serializer<MoveGenerator> Serializer;
   typedef SimpleAnimator<Variant> Animator;
   typedef MoveFactory<GameState> MoveFactory;
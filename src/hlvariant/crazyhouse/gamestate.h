@@ -27,6 +27,7 @@ public:
   typedef typename Base::Piece Piece;
   typedef Pool<Piece> Pool;
   typedef PoolCollection<Pool> Pools;
+  typedef typename Base::UndoInfo UndoInfo;
 private:
   using Base::m_board;
   Pools m_pools;
@@ -37,8 +38,11 @@ public:
   virtual const Pools& pools() const;
   virtual Pools& pools();
   
+  virtual quint64 hash() const;
+  
   virtual void captureOn(const Point& p);
   virtual void move(const Move& m);
+  virtual void unmove(const Move& m, const UndoInfo& undo);
 };
 
 // IMPLEMENTATION
@@ -66,6 +70,11 @@ typename GameState<Board, Move>::Pools& GameState<Board, Move>::pools() {
   return m_pools;
 }
 
+template <typename Board, typename Move>
+quint64 GameState<Board, Move>::hash() const {
+  return Base::hash() ^ m_pools.hash();
+}
+
 template <typename Board, typename Move>
 void GameState<Board, Move>::move(const Move& m) {
   if (m.drop() == Piece()) {
@@ -92,6 +101,27 @@ void GameState<Board, Move>::move(const Move& m) {
   }
 }
 
+template <typename Board, typename Move>
+void GameState<Board, Move>::unmove(const Move& m, const UndoInfo& undo) {
+  Piece captured = undo.captured;
+  
+  if (m.drop() == Piece()) {
+    if (undo.moved != Piece() && captured != Piece()) {
+      m_pools.pool(Piece::oppositeColor(captured.color()))
+        .remove(captured.actualType());
+    }
+  }
+  else {
+    m_board.set(m.to(), captured);
+    m_pools.pool(m.drop().color()).add(m.drop().type());
+    
+    if (captured != Piece())
+      m_pools.pool(Piece::oppositeColor(captured.color())).remove(captured.type());
+  }
+  
+  Base::unmove(m, undo);
+}
+
 template <typename Board, typename Move>
 void GameState<Board, Move>::captureOn(const Point& p) {
   Piece captured = m_board.get(p);
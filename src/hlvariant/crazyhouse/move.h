@@ -24,9 +24,10 @@ public:
 private:
   typedef typename Piece::Color Color;
   
-  Color m_pool;
-  int m_index;
+  // small fields, so that a drop move stays a plain 8 byte value
   Piece m_drop;
+  signed char m_pool;
+  short m_index;
 public:
   MoveMixin();
   MoveMixin(const Point& from, const Point& to, int promotionType = -1);
@@ -62,9 +63,9 @@ MoveMixin<Move, Piece>::MoveMixin(Color pool, int index, const Point& to)
 template <typename Move, typename Piece>
 MoveMixin<Move, Piece>::MoveMixin(const Piece& dropped, const Point& to)
 : Move(Point::invalid(), to)
+, m_drop(dropped)
 , m_pool(dropped.color())
-, m_index(-1)
-, m_drop(dropped) { }
+, m_index(-1) { }
 
 template <typename Move, typename Piece>
 Piece MoveMixin<Move, Piece>::drop() const {
@@ -78,7 +79,7 @@ void MoveMixin<Move, Piece>::setDrop(const Piece& drop) {
 
 template <typename Move, typename Piece>
 typename Piece::Color MoveMixin<Move, Piece>::pool() const {
-  return m_pool;
+  return static_cast<Color>(m_pool);
 }
 
 template <typename Move, typename Piece>
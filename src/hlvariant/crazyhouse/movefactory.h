@@ -28,6 +28,13 @@ public:
                 drop.piece_index, 
                 drop.to);
   }
+
+  virtual bool toDrop(const Move& move, DropUserMove& drop) {
+    if (move.pool() == Piece::INVALID_COLOR || move.index() == -1)
+      return false;
+    drop = DropUserMove(move.pool(), move.index(), move.to());
+    return true;
+  }
 };
 
 } // namespace Crazyhouse
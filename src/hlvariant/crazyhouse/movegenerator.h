@@ -11,14 +11,14 @@
 #ifndef HLVARIANT__CRAZYHOUSE__MOVEGENERATOR_H
 #define HLVARIANT__CRAZYHOUSE__MOVEGENERATOR_H
 
-#include "../chess/movegenerator.h"
+#include "../chess/bitboardmovegenerator.h"
 
 namespace HLVariant {
 namespace Crazyhouse {
 
 template <typename _LegalityCheck>
-class MoveGenerator : public Chess::MoveGenerator<_LegalityCheck> {
-  typedef Chess::MoveGenerator<_LegalityCheck> Base;
+class MoveGenerator : public Chess::BitboardMoveGenerator<_LegalityCheck> {
+  typedef Chess::BitboardMoveGenerator<_LegalityCheck> Base;
   
   using Base::m_state;
 public:
@@ -44,14 +44,36 @@ void MoveGenerator<LegalityCheck>::generate(MoveCallback& callback) const {
   Base::generate(callback);
   
   // generate drops
-  const int n = m_state.pools().pool(m_state.turn()).size();
-  for (int i = 0; i < m_state.board().size().x; i++) {
-    for (int j = 0; j < m_state.board().size().y; j++) {
-      Point p(i, j);
-      for (int k = 0; k < n; k++) {
-        addMove(Move(m_state.turn(), k, p), callback);
+  Chess::Bitboard targets;
+  if (!Base::dropTargets(targets)) {
+    const int n = m_state.pools().pool(m_state.turn()).size();
+    for (int i = 0; i < m_state.board().size().x; i++) {
+      for (int j = 0; j < m_state.board().size().y; j++) {
+        Point p(i, j);
+        for (int k = 0; k < n; k++) {
+          this->addMove(Move(m_state.turn(), k, p), callback);
+        }
       }
     }
+    return;
+  }
+  
+  // drop targets already account for checks, so only
+  // the rules on the dropped piece need to be tested
+  LegalityCheck check(m_state);
+  const typename GameState::Pool& pool = m_state.pools().pool(m_state.turn());
+  const int n = pool.size();
+  for (int k = 0; k < n; k++) {
+    // equal pieces are stored next to each other
+    if (k > 0 && pool.get(k) == pool.get(k - 1))
+      continue;
+    
+    Chess::Bitboard b = targets;
+    while (b) {
+      Move move(m_state.turn(), k, Chess::Bitboards::point(Chess::Bitboards::popFirst(b)));
+      if (check.pseudolegal(move) && !callback(move))
+        return;
+    }
   }
 }
 
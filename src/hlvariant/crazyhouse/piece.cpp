@@ -13,25 +13,6 @@
 namespace HLVariant {
 namespace Crazyhouse {
 
-Piece::Piece(Color color, Type type)
-: Chess::Piece(color, type)
-, m_promoted(false) { }
-
-bool Piece::operator==(const Piece& other) const {
-  return Chess::Piece::operator==(other) && m_promoted == other.m_promoted;
-}
-
-void Piece::setPromoted() {
-  m_promoted = true;
-}
-
-Piece::Type Piece::actualType() const {
-  if (m_promoted)
-    return PAWN;
-  else
-    return type();
-}
-
 Piece Piece::fromDescription(const QString& description) {
   Chess::Piece res = Chess::Piece::fromDescription(description);
   return Piece(res.color(), res.type());
@@ -16,14 +16,26 @@
 namespace HLVariant {
 namespace Crazyhouse {
 
+/**
+  * A chess piece which remembers whether it was a promoted pawn.
+  * The promotion flag is kept in the spare bits of Chess::Piece,
+  * so that this is still a single byte.
+  * The flag is not part of the hash code, just like boards compare
+  * pieces by type and color only: servers do not report it.
+  */
 class Piece : public Chess::Piece {
-  bool m_promoted;
+  enum { PROMOTED = 1 };
 public:
-  Piece(Color color = INVALID_COLOR, Type type = INVALID_TYPE);
+  Piece(Color color = INVALID_COLOR, Type type = INVALID_TYPE)
+  : Chess::Piece(color, type) { }
   
-  virtual bool operator==(const Piece& other) const;
-  virtual void setPromoted();
-  virtual Type actualType() const;
+  bool operator==(const Piece& other) const {
+    return Chess::Piece::operator==(other) && flags() == other.flags();
+  }
+  
+  void setPromoted() { setFlags(flags() | PROMOTED); }
+  bool promoted() const { return flags() & PROMOTED; }
+  Type actualType() const { return promoted() ? PAWN : type(); }
   
   static Piece fromDescription(const QString& description);
 };
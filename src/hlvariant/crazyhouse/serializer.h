@@ -25,15 +25,15 @@ class Serializer : public Chess::Serializer<MoveGenerator> {
 protected:
   using Base::m_rep;
 public:
-  Serializer(const QString& rep);
+  Serializer(const QString& rep, MoveList<MoveGenerator>* moves = 0);
   virtual QString serialize(const Move& move, const GameState& ref);
 };
 
 // IMPLEMENTATION
 
 template <typename MoveGenerator>
-Serializer<MoveGenerator>::Serializer(const QString& rep)
-: Base(rep) { }
+Serializer<MoveGenerator>::Serializer(const QString& rep, MoveList<MoveGenerator>* moves)
+: Base(rep, moves) { }
 
 template <typename MoveGenerator>
 QString Serializer<MoveGenerator>::serialize(const Move& move, const GameState& ref) {
@@ -21,12 +21,23 @@ public:
   typedef typename LegalityCheck::GameState GameState;
   typedef typename GameState::Board Board;
   typedef typename Board::Piece Piece;
+  typedef typename GameState::Move Move;
+
+  /** any move is legal, so there is no list to generate: generate() lists nothing */
+  static const bool canGenerate = false;
+
+  class MoveCallback {
+  public:
+    virtual ~MoveCallback() { }
+    virtual bool operator()(const Move&) = 0;
+  };
 
   MoveGenerator(const GameState& ) { }
   virtual ~MoveGenerator() { }
   
   virtual bool stalled() const { return false; }
   virtual bool check(typename Piece::Color) const { return false; }
+  virtual void generate(MoveCallback&) const { }
 };
 
 } // namespace Dummy
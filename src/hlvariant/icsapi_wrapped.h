@@ -20,6 +20,7 @@ template <typename Variant>
 class WrappedICSAPI : public ICSAPI {
 public:
   virtual PositionPtr createChessboard(int, bool, bool, bool, bool, const Point&);
+  virtual PositionPtr createChessboard(int, bool, bool, bool, bool, const Point&, const QChar*);
   virtual PiecePtr createPiece(const QString& description);
   virtual MovePtr parseVerbose(const QString& str, const PositionPtr& ref);
 };
@@ -44,6 +45,45 @@ PositionPtr WrappedICSAPI<Variant>::createChessboard(
       enPassant)));
 }
 
+template <typename Variant>
+PositionPtr WrappedICSAPI<Variant>::createChessboard(
+                          int turn,
+                          bool wkCastle,
+                          bool wqCastle,
+                          bool bkCastle,
+                          bool bqCastle,
+                          const Point& enPassant,
+                          const QChar* squares) {
+  typedef typename VariantData<Variant>::Piece Piece;
+  typename VariantData<Variant>::GameState state(
+      static_cast<typename Piece::Color>(turn),
+      wkCastle,
+      wqCastle,
+      bkCastle,
+      bqCastle,
+      enPassant);
+
+  // decode each kind of piece once, and write the board directly
+  Piece pieces[128];
+  bool decoded[128] = { false };
+  typename VariantData<Variant>::Board& board = state.board();
+  for (int i = 0; i < 64; i++) {
+    ushort c = squares[i].unicode();
+    Point p(i % 8, i / 8);
+    if (c >= 128)
+      board.set(p, Piece::fromDescription(QString(squares[i])));
+    else {
+      if (!decoded[c]) {
+        pieces[c] = Piece::fromDescription(QString(squares[i]));
+        decoded[c] = true;
+      }
+      board.set(p, pieces[c]);
+    }
+  }
+
+  return PositionPtr(new WrappedPosition<Variant>(state));
+}
+
 template <typename Variant>
 PiecePtr WrappedICSAPI<Variant>::createPiece(const QString& description) {
   return PiecePtr(new WrappedPiece<Variant>(
@@ -19,6 +19,7 @@
 #include "../crazyhouse/move.h"
 #include "gamestate.h"
 #include "../shogi/legalitycheck.h"
+#include "../shogi/movegenerator.h"
 #include "../shogi/serializer.h"
 #include "../crazyhouse/movefactory.h"
 #include "../animator.h"
@@ -32,10 +33,10 @@ struct TAGUA_EXPORT Variant {
   typedef Crazyhouse::MoveMixin<Chess::Move, Shogi::Piece> Move;
   typedef GameState<Shogi::ShogiBan<5, 5, Shogi::Piece>, Move> GameState;
   typedef Shogi::LegalityCheck<GameState> LegalityCheck;
-  typedef Shogi::Serializer<LegalityCheck> Serializer;
+  typedef Shogi::MoveGenerator<LegalityCheck> MoveGenerator;
+  typedef Shogi::Serializer<MoveGenerator> Serializer;
   typedef DropAnimatorMixin<SimpleAnimator<Variant> > Animator;
   typedef Crazyhouse::MoveFactory<GameState> MoveFactory;
-  typedef Variant MoveGenerator; // to make VariantData happy
   
   static const bool hasICS = false;
   static const bool m_simple_moves = false;
@@ -36,6 +36,14 @@ public:
   virtual NormalUserMove toNormal(const Move& move) {
     return NormalUserMove(move.from(), move.to());
   }
+
+  /**
+    * \return Whether @a move is a drop, in which case it is
+    *         converted into @a drop.
+    */
+  virtual bool toDrop(const Move&, DropUserMove&) {
+    return false;
+  }
 };
 
 }
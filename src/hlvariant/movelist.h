@@ -0,0 +1,145 @@
+/*
+  Copyright (c) 2007 Paolo Capriotti <p.capriotti@gmail.com>
+            (c) 2007 Maurizio Monge <maurizio.monge@kdemail.net>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#ifndef HLVARIANT__MOVELIST_H
+#define HLVARIANT__MOVELIST_H
+
+#include <vector>
+#include <QtGlobal>
+
+namespace HLVariant {
+
+/**
+  * The legal moves of the last few positions asked for, each generated
+  * once and kept while it is in use.
+  *
+  * Lists are bound to the Zobrist key of the position they have been
+  * generated for. Keeping more than one lets a position answer for its
+  * own moves and for those of the positions its moves lead to, which
+  * serializers need to tell check from mate.
+  */
+template <typename _MoveGenerator>
+class MoveList {
+public:
+  typedef _MoveGenerator MoveGenerator;
+  typedef typename MoveGenerator::GameState GameState;
+  typedef typename MoveGenerator::Move Move;
+private:
+  class Collect : public MoveGenerator::MoveCallback {
+    std::vector<Move>& m_moves;
+  public:
+    Collect(std::vector<Move>& moves)
+    : m_moves(moves) { }
+
+    virtual bool operator()(const Move& move) {
+      m_moves.push_back(move);
+      return true;
+    }
+  };
+
+  struct Entry {
+    quint64 key;
+    unsigned int used;
+    std::vector<Move> moves;
+
+    Entry()
+    : key(0)
+    , used(0) { }
+  };
+
+  enum { EntryCount = 4 };
+
+  Entry m_entries[EntryCount];
+  unsigned int m_clock;
+
+  /** \return The list of the position whose key is @a key, or 0. */
+  Entry* lookup(quint64 key);
+public:
+  MoveList();
+
+  /**
+    * \return The legal moves in @a state, generating them only if
+    *         no list describes that position. The list is only valid
+    *         until moves are asked for another position.
+    */
+  const std::vector<Move>& moves(const GameState& state);
+
+  /**
+    * \return The legal moves in @a state if they have been generated
+    *         already, or 0. Nothing is generated.
+    */
+  const std::vector<Move>* find(const GameState& state);
+
+  /**
+    * Forget the moves, so that the next request generates them again.
+    */
+  void clear();
+};
+
+// IMPLEMENTATION
+
+template <typename MoveGenerator>
+MoveList<MoveGenerator>::MoveList()
+: m_clock(0) { }
+
+template <typename MoveGenerator>
+typename MoveList<MoveGenerator>::Entry*
+MoveList<MoveGenerator>::lookup(quint64 key) {
+  for (int i = 0; i < EntryCount; i++) {
+    Entry& e = m_entries[i];
+    if (e.used != 0 && e.key == key) {
+      e.used = ++m_clock;
+      return &e;
+    }
+  }
+  return 0;
+}
+
+template <typename MoveGenerator>
+const std::vector<typename MoveList<MoveGenerator>::Move>&
+MoveList<MoveGenerator>::moves(const GameState& state) {
+  quint64 key = state.hash();
+  if (Entry* e = lookup(key))
+    return e->moves;
+
+  // replace the least recently used list
+  Entry* res = &m_entries[0];
+  for (int i = 1; i < EntryCount; i++) {
+    if (m_entries[i].used < res->used)
+      res = &m_entries[i];
+  }
+
+  res->moves.clear();
+  res->moves.reserve(64);
+  Collect collect(res->moves);
+  MoveGenerator generator(state);
+  generator.generate(collect);
+
+  res->key = key;
+  res->used = ++m_clock;
+  return res->moves;
+}
+
+template <typename MoveGenerator>
+const std::vector<typename MoveList<MoveGenerator>::Move>*
+MoveList<MoveGenerator>::find(const GameState& state) {
+  Entry* e = lookup(state.hash());
+  return e ? &e->moves : 0;
+}
+
+template <typename MoveGenerator>
+void MoveList<MoveGenerator>::clear() {
+  for (int i = 0; i < EntryCount; i++)
+    m_entries[i].used = 0;
+}
+
+} // namespace HLVariant
+
+#endif // HLVARIANT__MOVELIST_H
@@ -0,0 +1,103 @@
+/*
+  Copyright (c) 2007 Paolo Capriotti <p.capriotti@gmail.com>
+            (c) 2007 Maurizio Monge <maurizio.monge@kdemail.net>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#ifndef HLVARIANT__NOTATION_H
+#define HLVARIANT__NOTATION_H
+
+#include <cstring>
+#include <QString>
+#include "point.h"
+
+namespace HLVariant {
+
+/**
+  * Character level helpers for move notation parsers.
+  * They work on ranges of a string without copying them, and keep
+  * no state, so that parsers built on them are reentrant.
+  */
+namespace Notation {
+
+/**
+  * \return The character at position @a i of @a str, or 0 past its end.
+  */
+inline ushort at(const QString& str, int i) {
+  return i < str.length() ? str[i].unicode() : 0;
+}
+
+inline bool isDigit(ushort c) {
+  return c >= '0' && c <= '9';
+}
+
+inline bool isLetter(ushort c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+/**
+  * \return Whether @a c is one of the ASCII characters in @a set.
+  */
+inline bool isOneOf(ushort c, const char* set) {
+  return c > 0 && c < 128 && strchr(set, c);
+}
+
+/**
+  * \return Whether @a str contains the ASCII string @a text at position @a i.
+  */
+inline bool matches(const QString& str, int i, const char* text) {
+  for (; *text; ++text, ++i) {
+    if (at(str, i) != *text)
+      return false;
+  }
+  return true;
+}
+
+/**
+  * \return The position following the run of digits starting at @a i.
+  */
+inline int skipDigits(const QString& str, int i) {
+  while (isDigit(at(str, i)))
+    i++;
+  return i;
+}
+
+/**
+  * \return The value of the digits in [@a begin, @a end).
+  */
+inline int number(const QString& str, int begin, int end) {
+  int res = 0;
+  for (int i = begin; i < end; i++)
+    res = res * 10 + (at(str, i) - '0');
+  return res;
+}
+
+/**
+  * Parse the square in [@a begin, @a end), a column letter followed
+  * by a row number, either of which can be missing.
+  * \return The same as Point(str.mid(begin, end - begin), ysize).
+  */
+inline Point point(const QString& str, int begin, int end, int ysize) {
+  Point res = Point::invalid();
+  if (begin >= end)
+    return res;
+
+  ushort c = at(str, begin);
+  if (isLetter(c)) {
+    res.x = c >= 'a' ? c - 'a' : c - 'A';
+    begin++;
+    if (begin == end)
+      return res;
+  }
+  res.y = ysize - number(str, begin, end);
+  return res;
+}
+
+} // namespace Notation
+} // namespace HLVariant
+
+#endif // HLVARIANT__NOTATION_H
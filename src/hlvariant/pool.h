@@ -12,6 +12,7 @@
 #define HLVARIANT__POOL_H
 
 #include <map>
+#include "zobrist.h"
 
 namespace HLVariant {
 
@@ -26,6 +27,7 @@ private:
   
   Color m_owner;
   Data m_data;
+  quint64 m_hash;
 public:
   Pool(Color owner);
   virtual ~Pool();
@@ -43,6 +45,12 @@ public:
   virtual Piece get(int index) const;
   virtual Piece take(int index);
   
+  /**
+    * \return A Zobrist key for the pool contents.
+    *         It is updated incrementally by add() and remove().
+    */
+  virtual quint64 hash() const;
+  
   typedef Data RawData;
   const RawData& rawData() const { return m_data; }
 };
@@ -52,14 +60,17 @@ public:
 
 template <typename Piece>
 Pool<Piece>::Pool(Color owner)
-: m_owner(owner) { }
+: m_owner(owner)
+, m_hash(0) { }
 
 template <typename Piece>
 Pool<Piece>::~Pool() { }
 
 template <typename Piece>
 bool Pool<Piece>::operator==(const Pool<Piece>& other) const {
-  return m_owner == other.m_owner && m_data == other.m_data;
+  return m_owner == other.m_owner && 
+         m_hash == other.m_hash && 
+         m_data == other.m_data;
 }
 
 template <typename Piece>
@@ -80,12 +91,15 @@ int Pool<Piece>::count(Type type) const {
 
 template <typename Piece>
 int Pool<Piece>::add(Type type) {
-  return ++m_data[type];
+  int n = ++m_data[type];
+  m_hash ^= Zobrist::pool(m_owner, type, n - 1) ^ Zobrist::pool(m_owner, type, n);
+  return n;
 }
 
 template <typename Piece>
 int Pool<Piece>::remove(Type type) {
   int n = --m_data[type];
+  m_hash ^= Zobrist::pool(m_owner, type, n + 1) ^ Zobrist::pool(m_owner, type, n);
   if (n <= 0) {
     m_data.erase(type);
     return 0;
@@ -94,6 +108,11 @@ int Pool<Piece>::remove(Type type) {
   return n;
 }
 
+template <typename Piece>
+quint64 Pool<Piece>::hash() const {
+  return m_hash;
+}
+
 template <typename Piece>
 bool Pool<Piece>::empty() const {
   return m_data.empty();
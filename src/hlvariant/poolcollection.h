@@ -31,6 +31,11 @@ public:
   
   virtual Pool& pool(Color player);
   virtual const Pool& pool(Color player) const;
+  
+  /**
+    * \return A Zobrist key for the contents of all pools.
+    */
+  virtual quint64 hash() const;
 };
 
 // IMPLEMENTATION
@@ -107,6 +112,14 @@ const Pool& PoolCollection<Pool>::pool(Color player) const {
   return const_cast<PoolCollection*>(this)->pool(player);
 }
 
+template <typename Pool>
+quint64 PoolCollection<Pool>::hash() const {
+  quint64 res = 0;
+  for (typename Pools::const_iterator i = m_pools.begin(); i != m_pools.end(); ++i)
+    res ^= i->second.hash();
+  return res;
+}
+
 }
 
 #endif // HLVARIANT__POOLCOLLECTION_H
@@ -47,21 +47,22 @@ bool LegalityCheck<GameState>::legal(Move& move) const {
   if (!pseudolegal(move))
     return false;
 
-  GameState tmp(Base::m_state);
-  tmp.move(move);
+  // try the move on a copy, and take it back afterwards
+  GameState& state = Base::scratch();
+  typename Piece::Color turn = state.turn();
+  typename GameState::UndoInfo undo = state.undoInfo(move);
+  state.move(move);
 
   // find king and prince positions
-  Point king_pos = tmp.board().find(Piece(Base::m_state.turn(), Piece::KING));
-  Point prince_pos = tmp.board().find(Piece(Base::m_state.turn(), Piece::DRUNKEN_ELEPHANT, true));
+  Point king_pos = state.board().find(Piece(turn, Piece::KING));
+  Point prince_pos = state.board().find(Piece(turn, Piece::DRUNKEN_ELEPHANT, true));
 
-  // check if the king and prince can be captured
-  if ((canBeCaptured(tmp, king_pos) && canBeCaptured(tmp, prince_pos)) ||
-      (canBeCaptured(tmp, king_pos) && !prince_pos.valid()) ||
-      (canBeCaptured(tmp, prince_pos) && !king_pos.valid()) ||
-      (!prince_pos.valid() && !king_pos.valid()))
-    return false;
+  // the move is legal as long as one of them cannot be captured
+  bool res = (king_pos.valid() && !canBeCaptured(state, king_pos)) ||
+             (prince_pos.valid() && !canBeCaptured(state, prince_pos));
 
-  return true;
+  state.unmove(move, undo);
+  return res;
 }
 
 } // namespace ShoShogi
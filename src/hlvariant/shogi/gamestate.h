@@ -14,6 +14,7 @@
 #include "../crazyhouse/gamestate.h"
 #include "../pool.h"
 #include "../poolcollection.h"
+#include "../attacktable.h"
 
 namespace HLVariant {
 namespace Shogi {
@@ -26,10 +27,21 @@ public:
   typedef typename Board::Piece Piece;
   typedef Pool<Piece> Pool;
   typedef PoolCollection<Pool> Pools;
+  
+  /**
+    * The part of the state that a move destroys,
+    * saved so that the move can be taken back.
+    */
+  struct UndoInfo {
+    Piece moved;
+    Piece captured;
+    typename Piece::Color turn;
+  };
 private:
   Board m_board;
   Pools m_pools;
   typename Piece::Color m_turn;
+  AttackTableHolder m_attacks;
 public:
   GameState();
   virtual ~GameState();
@@ -44,9 +56,34 @@ public:
   
   virtual bool operator==(const GameState<Board, Move>& other) const;
   
+  /**
+    * \return A Zobrist key for this state, covering the board,
+    *         the pools and the turn.
+    */
+  virtual quint64 hash() const;
+  
+  /**
+    * \return A cache of facts about the recent positions of this state, which
+    *         legality checks and move generators fill lazily.
+    */
+  virtual AttackTable& attackTable() const;
+  
   virtual void move(const Move& m);
   virtual void basicMove(const Move& m);
   virtual void captureOn(const Point& p);
+  
+  /**
+    * \return The information needed to take back @a m.
+    * \note Call this before executing @a m.
+    */
+  virtual UndoInfo undoInfo(const Move& m) const;
+  
+  /**
+    * Take back a move, restoring the state as it was before calling move().
+    * \param undo The information returned by undoInfo() before executing @a m.
+    */
+  virtual void unmove(const Move& m, const UndoInfo& undo);
+  
   virtual bool promotionZone(typename Piece::Color player, const Point& p) const;
   virtual bool canPromote(const Piece& p) const;
   
@@ -76,6 +113,9 @@ Board& GameState<Board, Move>::board() { return m_board; }
 template <typename Board, typename Move>
 const Board& GameState<Board, Move>::board() const { return m_board; }
 
+template <typename Board, typename Move>
+AttackTable& GameState<Board, Move>::attackTable() const { return m_attacks.get(); }
+
 template <typename Board, typename Move>
 typename GameState<Board, Move>::Pools& GameState<Board, Move>::pools() { return m_pools; }
 
@@ -132,6 +172,11 @@ bool GameState<Board, Move>::operator==(const GameState<Board, Move>& other) con
     m_board == other.m_board;
 }
 
+template <typename Board, typename Move>
+quint64 GameState<Board, Move>::hash() const {
+  return m_board.hash() ^ m_pools.hash() ^ Zobrist::turn(m_turn);
+}
+
 template <typename Board, typename Move>
 void GameState<Board, Move>::move(const Move& m) {
   if (m.drop() == Piece()) {
@@ -155,8 +200,38 @@ void GameState<Board, Move>::move(const Move& m) {
 template <typename Board, typename Move>
 void GameState<Board, Move>::captureOn(const Point& p) {
   Piece captured = m_board.get(p);
-  m_board.set(p, Piece());
-  m_pools.pool(Piece::oppositeColor(captured.color())).add(captured.type());
+  if (captured != Piece()) {
+    m_board.set(p, Piece());
+    m_pools.pool(Piece::oppositeColor(captured.color())).add(captured.type());
+  }
+}
+
+template <typename Board, typename Move>
+typename GameState<Board, Move>::UndoInfo
+GameState<Board, Move>::undoInfo(const Move& m) const {
+  UndoInfo undo;
+  undo.moved = m_board.get(m.from());
+  undo.captured = m_board.get(m.to());
+  undo.turn = m_turn;
+  return undo;
+}
+
+template <typename Board, typename Move>
+void GameState<Board, Move>::unmove(const Move& m, const UndoInfo& undo) {
+  if (m.drop() == Piece()) {
+    Piece captured = undo.captured;
+    if (captured != Piece())
+      m_pools.pool(Piece::oppositeColor(captured.color())).remove(captured.type());
+    
+    m_board.set(m.to(), captured);
+    m_board.set(m.from(), undo.moved);
+  }
+  else {
+    m_board.set(m.to(), Piece());
+    m_pools.pool(m.drop().color()).add(m.drop().type());
+  }
+  
+  m_turn = undo.turn;
 }
 
 template <typename Board, typename Move>
@@ -11,9 +11,11 @@
 #ifndef HLVARIANT__SHOGI__LEGALITYCHECK_H
 #define HLVARIANT__SHOGI__LEGALITYCHECK_H
 
+#include <boost/shared_ptr.hpp>
 #include "interactiontype.h"
 #include <KDebug>
 #include "turnpolicy.h"
+#include "../attacktable.h"
 
 namespace HLVariant {
 namespace Shogi {
@@ -27,7 +29,35 @@ public:
   typedef typename GameState::Move Move;
 protected:
   const GameState& m_state;
-  
+private:
+  mutable boost::shared_ptr<GameState> m_scratch;
+protected:
+  /**
+    * \return A copy of the state, where moves can be tried and taken back
+    *         without touching the state being checked. The copy is made
+    *         on first use, and reused as long as the state is unchanged.
+    */
+  GameState& scratch() const;
+
+  /**
+    * \return The attack map of the current position, filled on first use.
+    */
+  AttackTable::Map& attackMap() const;
+
+  /**
+    * Mark all squares where each side can move, and the royal squares,
+    * in a single pass over the board. Pieces are assumed to move
+    * at most two squares, or along a line.
+    */
+  virtual void computeAttackMap(AttackTable::Map& map) const;
+
+  /**
+    * Look for pieces of @a color able to move to @a p, bypassing
+    * the attack table. Like computeAttackMap, this only looks at the
+    * squares around @a p and at the first piece along each line.
+    */
+  bool computeAttacks(typename Piece::Color color, const Point& p) const;
+
   virtual bool stuckPiece(const Piece& piece, const Point& p) const;
 public:
   LegalityCheck(const GameState& state);
@@ -36,6 +66,23 @@ public:
   virtual bool getMoveType(const Piece& piece, const Move& move) const;
   bool legal(Move& move) const;
   bool pseudolegal(Move& move) const;
+  
+  /**
+    * \return Whether a piece of @a color can move to @a p.
+    * \note The result comes from the attack map of the position.
+    */
+  virtual bool attacks(typename Piece::Color color, const Point& p) const;
+
+  /**
+    * \return The type of the piece whose capture loses the game.
+    */
+  virtual typename Piece::Type royalType() const;
+
+  /**
+    * \return The square of the royal piece of @a color, or an invalid point.
+    * \note The result comes from the attack map of the position.
+    */
+  Point royalPosition(typename Piece::Color color) const;
   bool canBeCaptured(const GameState& state, const Point& point) const;
   
   virtual InteractionType movable(const TurnTest&, const Point& x) const;
@@ -169,8 +216,12 @@ bool LegalityCheck<GameState>::pseudolegal(Move& move) const {
     if (piece != Piece() && getMoveType(piece, move)) {
       if (m_state.canPromote(piece) &&
             (m_state.promotionZone(piece.color(), move.to()) ||
-            m_state.promotionZone(piece.color(), move.from())))
+            m_state.promotionZone(piece.color(), move.from()))) {
+        // a piece which could not move any more has to promote
+        if (stuckPiece(piece, move.to()))
+          move = Move(move.from(), move.to(), 0);
         move.setType(Move::PROMOTION);
+      }
       return true;
     }
     else {
@@ -181,38 +232,151 @@ bool LegalityCheck<GameState>::pseudolegal(Move& move) const {
 
 
 template <typename GameState>
-  bool LegalityCheck<GameState>::canBeCaptured(const GameState& state, const Point& point) const {
-  for (int i = 0; i < m_state.board().size().x; i++) {
-    for (int j = 0; j < m_state.board().size().y; j++) {
+bool LegalityCheck<GameState>::attacks(typename Piece::Color color, const Point& point) const {
+  if (!m_state.board().valid(point) || 
+      (color != Piece::BLACK && color != Piece::WHITE))
+    return false;
+  
+  return attackMap().attacked(point, color);
+}
+
+template <typename GameState>
+typename LegalityCheck<GameState>::Piece::Type LegalityCheck<GameState>::royalType() const {
+  return Piece::KING;
+}
+
+template <typename GameState>
+Point LegalityCheck<GameState>::royalPosition(typename Piece::Color color) const {
+  if (color != Piece::BLACK && color != Piece::WHITE)
+    return m_state.board().find(Piece(color, royalType()));
+
+  return attackMap().royal(color);
+}
+
+template <typename GameState>
+AttackTable::Map& LegalityCheck<GameState>::attackMap() const {
+  AttackTable::Map& map = m_state.attackTable().map(m_state.hash(), m_state.board().size());
+  if (!map.filled()) {
+    computeAttackMap(map);
+    map.setFilled();
+  }
+  return map;
+}
+
+template <typename GameState>
+void LegalityCheck<GameState>::computeAttackMap(AttackTable::Map& map) const {
+  static const Point lines[] = {
+    Point(1, 0), Point(-1, 0), Point(0, 1), Point(0, -1),
+    Point(1, 1), Point(1, -1), Point(-1, 1), Point(-1, -1) };
+
+  const Board& board = m_state.board();
+  for (int i = 0; i < board.size().x; i++) {
+    for (int j = 0; j < board.size().y; j++) {
       Point p(i, j);
-      Piece piece = state.board().get(p);
-      LegalityCheck<GameState> check(state);
-      if (piece.color() == state.turn() && check.getMoveType(piece, Move(p, point))) {
-        return true;
+      Piece piece = board.get(p);
+      typename Piece::Color color = piece.color();
+      if (piece == Piece() || (color != Piece::BLACK && color != Piece::WHITE))
+        continue;
+
+      // the first one found, like Board::find
+      if (!map.royal(color).valid() && piece == Piece(color, royalType()))
+        map.setRoyal(color, p);
+
+      for (int dx = -2; dx <= 2; dx++) {
+        for (int dy = -2; dy <= 2; dy++) {
+          Point q = p + Point(dx, dy);
+          if (board.valid(q) && getMoveType(piece, Move(p, q)))
+            map.setAttacked(q, color);
+        }
       }
+
+      // farther squares can only be reached sliding along a clear line
+      for (int k = 0; k < 8; k++) {
+        Point q = p + lines[k];
+        if (!board.valid(q) || board.get(q) != Piece())
+          continue;
+        q += lines[k];
+        if (!board.valid(q) || board.get(q) != Piece())
+          continue;
+        for (q += lines[k]; board.valid(q); q += lines[k]) {
+          if (!getMoveType(piece, Move(p, q)))
+            break;
+          map.setAttacked(q, color);
+          if (board.get(q) != Piece())
+            break;
+        }
+      }
+    }
+  }
+}
+
+template <typename GameState>
+bool LegalityCheck<GameState>::computeAttacks(typename Piece::Color color, const Point& point) const {
+  static const Point lines[] = {
+    Point(1, 0), Point(-1, 0), Point(0, 1), Point(0, -1),
+    Point(1, 1), Point(1, -1), Point(-1, 1), Point(-1, -1) };
+
+  const Board& board = m_state.board();
+  if (!board.valid(point))
+    return false;
+
+  for (int dx = -2; dx <= 2; dx++) {
+    for (int dy = -2; dy <= 2; dy++) {
+      Point p = point + Point(dx, dy);
+      Piece piece = board.get(p);
+      if (piece.color() == color && getMoveType(piece, Move(p, point)))
+        return true;
     }
   }
+
+  // farther pieces have to slide, so only the first one on each line counts
+  for (int k = 0; k < 8; k++) {
+    Point p = point + lines[k];
+    int distance = 1;
+    while (board.valid(p) && board.get(p) == Piece()) {
+      p += lines[k];
+      distance++;
+    }
+    Piece piece = board.get(p);
+    if (distance > 2 && piece.color() == color && getMoveType(piece, Move(p, point)))
+      return true;
+  }
   return false;
 }
 
+template <typename GameState>
+bool LegalityCheck<GameState>::canBeCaptured(const GameState& state, const Point& point) const {
+  // the position is only looked at once, so do not fill a map for it
+  LegalityCheck<GameState> check(state);
+  return check.computeAttacks(state.turn(), point);
+}
+
+template <typename GameState>
+GameState& LegalityCheck<GameState>::scratch() const {
+  if (!m_scratch)
+    m_scratch.reset(new GameState(m_state));
+  else if (m_scratch->hash() != m_state.hash())
+    *m_scratch = m_state;
+  return *m_scratch;
+}
+
 template <typename GameState>
 bool LegalityCheck<GameState>::legal(Move& move) const {
   if (!pseudolegal(move))
     return false;
 
-  GameState tmp(m_state);
-  tmp.move(move);
+  // try the move on a copy, and take it back afterwards
+  GameState& state = scratch();
+  typename Piece::Color turn = state.turn();
+  typename GameState::UndoInfo undo = state.undoInfo(move);
+  state.move(move);
 
-  // find king position
-  Point king_pos = tmp.board().find(Piece(m_state.turn(), Piece::KING));
-  if (!king_pos.valid()) 
-    return false;
-
-  // check if the king can be captured
-  if (canBeCaptured(tmp, king_pos))
-    return false;
+  // find king position, and check if the king can be captured
+  Point king_pos = state.board().find(Piece(turn, Piece::KING));
+  bool res = king_pos.valid() && !canBeCaptured(state, king_pos);
 
-  return true;
+  state.unmove(move, undo);
+  return res;
 }
 
 template <typename GameState>
@@ -0,0 +1,184 @@
+/*
+  Copyright (c) 2007 Paolo Capriotti <p.capriotti@gmail.com>
+            (c) 2007 Maurizio Monge <maurizio.monge@kdemail.net>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#ifndef HLVARIANT__SHOGI__MOVEGENERATOR_H
+#define HLVARIANT__SHOGI__MOVEGENERATOR_H
+
+#include "interactiontype.h"
+#include "turnpolicy.h"
+
+namespace HLVariant {
+namespace Shogi {
+
+/**
+  * Generic move generator for the shogi family.
+  * Every candidate move is tested with the legality check of the
+  * variant, so that this works unchanged for any set of pieces.
+  * Optional promotions are generated both ways, and drops are
+  * generated only for variants which allow them.
+  */
+template <typename _LegalityCheck>
+class MoveGenerator {
+public:
+  typedef _LegalityCheck LegalityCheck;
+  typedef typename LegalityCheck::GameState GameState;
+  typedef typename GameState::Move Move;
+  typedef typename GameState::Board::Piece Piece;
+
+  /** generate() lists every legal move */
+  static const bool canGenerate = true;
+
+  class MoveCallback {
+  public:
+    virtual ~MoveCallback() { }
+    virtual bool operator()(const Move&) = 0;
+  };
+protected:
+  const GameState& m_state;
+
+  /** checks candidate moves, kept so that its scratch copy is made once */
+  LegalityCheck m_check;
+
+  class FindMove : public MoveCallback {
+    bool m_found;
+  public:
+    FindMove() : m_found(false) { }
+    virtual bool operator()(const Move&) { m_found = true; return false; }
+
+    bool found() const { return m_found; }
+  };
+
+  virtual bool addMove(const Move& m, MoveCallback&) const;
+  virtual bool generateDrops(MoveCallback&) const;
+public:
+  MoveGenerator(const GameState& state);
+  virtual ~MoveGenerator();
+
+  virtual bool check(typename Piece::Color) const;
+  virtual bool stalled() const;
+  virtual void generate(MoveCallback&) const;
+  virtual bool generateFrom(const Point& p, MoveCallback&) const;
+};
+
+// IMPLEMENTATION
+
+template <typename LegalityCheck>
+MoveGenerator<LegalityCheck>::MoveGenerator(const GameState& state)
+: m_state(state)
+, m_check(state) { }
+
+template <typename LegalityCheck>
+MoveGenerator<LegalityCheck>::~MoveGenerator() { }
+
+template <typename LegalityCheck>
+bool MoveGenerator<LegalityCheck>::check(typename Piece::Color turn) const {
+  Point kingPosition = m_check.royalPosition(turn);
+  if (!kingPosition.valid()) {
+    // a missing king is considered in check
+    return true;
+  }
+
+  return m_check.attacks(Piece::oppositeColor(turn), kingPosition);
+}
+
+template <typename LegalityCheck>
+bool MoveGenerator<LegalityCheck>::stalled() const {
+  AttackTable::Map& map = m_state.attackTable().map(m_state.hash(), m_state.board().size());
+  int cached = map.stalled();
+  if (cached != AttackTable::Unknown)
+    return cached;
+
+  FindMove findMove;
+  generate(findMove);
+
+  map.setStalled(!findMove.found());
+  return !findMove.found();
+}
+
+template <typename LegalityCheck>
+void MoveGenerator<LegalityCheck>::generate(MoveCallback& callback) const {
+  for (int i = 0; i < m_state.board().size().x; i++) {
+    for (int j = 0; j < m_state.board().size().y; j++) {
+      if (!generateFrom(Point(i, j), callback))
+        return;
+    }
+  }
+
+  generateDrops(callback);
+}
+
+template <typename LegalityCheck>
+bool MoveGenerator<LegalityCheck>::generateFrom(const Point& p, MoveCallback& callback) const {
+  Piece piece = m_state.board().get(p);
+  if (piece == Piece() || piece.color() != m_state.turn())
+    return true;
+
+  for (int i = 0; i < m_state.board().size().x; i++) {
+    for (int j = 0; j < m_state.board().size().y; j++) {
+      Move move(p, Point(i, j));
+      if (m_check.getMoveType(piece, move) && !addMove(move, callback))
+        return false;
+    }
+  }
+
+  return true;
+}
+
+template <typename LegalityCheck>
+bool MoveGenerator<LegalityCheck>::generateDrops(MoveCallback& callback) const {
+  typename Piece::Color turn = m_state.turn();
+
+  TurnTest test;
+  test.setSimplePolicy(turn, true);
+  if (m_check.droppable(test, turn) != Moving)
+    return true;
+
+  const typename GameState::Pool& pool = m_state.pools().pool(turn);
+  const int size = pool.size();
+  for (int k = 0; k < size; k++) {
+    // identical pieces give the same moves
+    if (k > 0 && pool.get(k) == pool.get(k - 1))
+      continue;
+
+    for (int i = 0; i < m_state.board().size().x; i++) {
+      for (int j = 0; j < m_state.board().size().y; j++) {
+        Point p(i, j);
+        if (m_state.board().get(p) == Piece() && !addMove(Move(turn, k, p), callback))
+          return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+template <typename LegalityCheck>
+bool MoveGenerator<LegalityCheck>::addMove(const Move& m, MoveCallback& callback) const {
+  Move move(m);
+  if (!m_check.legal(move))
+    return true;
+
+  // unless promotion is forced, generate both
+  // the promotion and the refusal, whenever possible
+  if (move.drop() == Piece() && move.promoteTo() == -1) {
+    Move promotion(m.from(), m.to(), 0);
+    if (m_check.pseudolegal(promotion) &&
+        promotion.promoteTo() != -1 &&
+        !callback(promotion))
+      return false;
+  }
+
+  return callback(move);
+}
+
+} // namespace Shogi
+} // namespace HLVariant
+
+#endif // HLVARIANT__SHOGI__MOVEGENERATOR_H
@@ -40,29 +40,48 @@ public:
     INVALID_TYPE = -1
   };
 private:
-  Color m_color;
-  Type m_type;
-  bool m_promoted;
+  /**
+    * A piece is packed in a single byte: bits 0-3 hold the type and
+    * bits 4-5 the color, both offset by 1 so that an invalid piece is 0,
+    * and bit 6 is set for promoted pieces.
+    */
+  unsigned char m_data;
+
+  enum {
+    TYPE_MASK = 0x0f,
+    COLOR_SHIFT = 4,
+    COLOR_MASK = 0x30,
+    PROMOTED = 0x40
+  };
 public:
-  Piece(Color color = INVALID_COLOR, Type type = INVALID_TYPE, bool promoted = false);
-  virtual ~Piece();
+  Piece(Color color = INVALID_COLOR, Type type = INVALID_TYPE, bool promoted = false)
+  : m_data(((color + 1) << COLOR_SHIFT) | (type + 1) | (promoted ? PROMOTED : 0)) { }
   
-  virtual Color color() const;
-  virtual Type type() const;
+  Color color() const {
+    return static_cast<Color>(((m_data & COLOR_MASK) >> COLOR_SHIFT) - 1);
+  }
+  Type type() const { return static_cast<Type>((m_data & TYPE_MASK) - 1); }
   
-  virtual QString colorName() const;
+  QString colorName() const;
   static QString colorName(Color color);
-  virtual QString typeName() const;
+  QString typeName() const;
   static QString typeName(Type type);
-  virtual QString name() const;
+  QString name() const;
   
   static Color oppositeColor(Color color);
   
-  virtual bool operator==(const Piece& other) const;
-  virtual bool operator!=(const Piece& other) const;
+  bool operator==(const Piece& other) const { return m_data == other.m_data; }
+  bool operator!=(const Piece& other) const { return m_data != other.m_data; }
+  
+  /**
+    * \return A small integer identifying this piece, 0 for an invalid piece.
+    */
+  int hashCode() const {
+    return (color() + 1) * 32 + type() + 1 + (promoted() ? 128 : 0);
+  }
 
-  void setPromoted();
-  bool promoted() const;
+  void setPromoted() { m_data |= PROMOTED; }
+  bool promoted() const { return m_data & PROMOTED; }
 };
 
 } // namespace Shogi
@@ -12,17 +12,18 @@
 #define HLVARIANT__SHOGI__SERIALIZER_H
 
 #include <QString>
-#include <QRegExp>
 #include <KDebug>
+#include "../movelist.h"
+#include "../notation.h"
 
 namespace HLVariant {
 namespace Shogi {
 
-template <typename _LegalityCheck>
+template <typename _MoveGenerator>
 class Serializer {
-  static QRegExp pattern;
 public:
-  typedef _LegalityCheck LegalityCheck;
+  typedef _MoveGenerator MoveGenerator;
+  typedef typename MoveGenerator::LegalityCheck LegalityCheck;
   typedef typename LegalityCheck::GameState GameState;
   typedef typename GameState::Board Board;
   typedef typename Board::Piece Piece;
@@ -30,12 +31,23 @@ public:
 protected:
   QString m_rep;
   
+  /** legal moves of the positions seen, if the generator can list them */
+  MoveList<MoveGenerator>* m_moves;
+  
   virtual bool isAmbiguous(const Move& move, const GameState& ref) const;
   virtual QString square(const Point& p, const Point& size) const;
   virtual QString symbol(const Piece& piece) const;
   virtual typename Piece::Type getType(const QChar& letter) const;
 public:
-  Serializer(const QString& rep);
+  /**
+    * \param rep A move representation type.
+    * \param moves A list of legal moves, used to resolve and disambiguate
+    *              moves, see Chess::Serializer. Since the generator tests
+    *              every square, lists are not generated here: only those
+    *              already there are used, and other positions are handled
+    *              by testing the few candidate moves.
+    */
+  Serializer(const QString& rep, MoveList<MoveGenerator>* moves = 0);
   virtual ~Serializer();
   
   QString serialize(const Move&, const GameState& ref);
@@ -47,29 +59,43 @@ public:
 
 // IMPLEMENTATION
 
-template <typename LegalityCheck>
-Serializer<LegalityCheck>::Serializer(const QString& rep)
-: m_rep(rep) { }
+template <typename MoveGenerator>
+Serializer<MoveGenerator>::Serializer(const QString& rep, MoveList<MoveGenerator>* moves)
+: m_rep(rep)
+, m_moves(MoveGenerator::canGenerate ? moves : 0) { }
 
 
-template <typename LegalityCheck>
-Serializer<LegalityCheck>::~Serializer() { }
+template <typename MoveGenerator>
+Serializer<MoveGenerator>::~Serializer() { }
 
-template <typename LegalityCheck>
-bool Serializer<LegalityCheck>::isAmbiguous(const Move& move, const GameState& ref) const {
+template <typename MoveGenerator>
+bool Serializer<MoveGenerator>::isAmbiguous(const Move& move, const GameState& ref) const {
   Piece piece = move.drop();
   if (piece == Piece())
     piece = ref.board().get(move.from());
     
+  const std::vector<Move>* moves = m_moves ? m_moves->find(ref) : 0;
   bool ambiguous = false;
-  if (move.drop() == Piece()) {
+  if (move.drop() == Piece() && moves) {
+    for (unsigned int i = 0; i < moves->size(); i++) {
+      const Move& mv = (*moves)[i];
+      if (mv.to() == move.to() &&
+          mv.drop() == Piece() &&
+          mv.from() != move.from() &&
+          ref.board().get(mv.from()) == piece) {
+        ambiguous = true;
+        break;
+      }
+    }
+  }
+  else if (move.drop() == Piece()) {
+    LegalityCheck check(ref);
     for (int i = 0; i < ref.board().size().x; i++) {
-      for (int j = 0; j < ref.board().size().x; j++) {
+      for (int j = 0; j < ref.board().size().y; j++) {
         Point p(i, j);
         if (p == move.from() || ref.board().get(p) != piece)
           continue;
         Move mv(p, move.to());
-        LegalityCheck check(ref);
         if (check.legal(mv)) {
           ambiguous = true;
           break;
@@ -81,8 +107,8 @@ bool Serializer<LegalityCheck>::isAmbiguous(const Move& move, const GameState& r
   return ambiguous;
 }
 
-template <typename LegalityCheck>
-QString Serializer<LegalityCheck>::square(const Point& p, const Point& size) const {
+template <typename MoveGenerator>
+QString Serializer<MoveGenerator>::square(const Point& p, const Point& size) const {
   QString res = QString::number(size.x - p.x);
   if (m_rep == "decorated") {
     res += "{num_" + QString::number(p.y + 1) + "}";
@@ -95,8 +121,8 @@ QString Serializer<LegalityCheck>::square(const Point& p, const Point& size) con
 }
 
 
-template <typename LegalityCheck>
-QString Serializer<LegalityCheck>::serialize(const Move& move, const GameState& ref) {
+template <typename MoveGenerator>
+QString Serializer<MoveGenerator>::serialize(const Move& move, const GameState& ref) {
   Piece piece = move.drop();
   if (piece == Piece())
     piece = ref.board().get(move.from());
@@ -150,8 +176,8 @@ QString Serializer<LegalityCheck>::serialize(const Move& move, const GameState&
   }
 }
 
-template <typename LegalityCheck>
-QString Serializer<LegalityCheck>::symbol(const Piece& piece) const {
+template <typename MoveGenerator>
+QString Serializer<MoveGenerator>::symbol(const Piece& piece) const {
   if (m_rep == "decorated") {
     QString res = "{";
     if (piece.promoted())
@@ -169,9 +195,9 @@ QString Serializer<LegalityCheck>::symbol(const Piece& piece) const {
   }
 }
 
-template <typename LegalityCheck>
-typename Serializer<LegalityCheck>::Piece::Type 
-Serializer<LegalityCheck>::getType(const QChar& letter) const {
+template <typename MoveGenerator>
+typename Serializer<MoveGenerator>::Piece::Type 
+Serializer<MoveGenerator>::getType(const QChar& letter) const {
   switch(letter.toLower().toAscii()) {
   case 'p':
     return Piece::PAWN;
@@ -194,93 +220,151 @@ Serializer<LegalityCheck>::getType(const QChar& letter) const {
   }
 }
 
-template <typename LegalityCheck>
-QRegExp Serializer<LegalityCheck>::
-//          1  2         3       4   5      6          7
-  pattern("^(([+])?([PRBLNSGK]))?((\\d*)([a-wyzA-Z])?)([-x*])?"
-//              8           9
-	  "(\\d+[a-zA-Z])?([+=])?[\?!]*");
-
-template <typename LegalityCheck>
-typename Serializer<LegalityCheck>::Move
-Serializer<LegalityCheck>::parse(const QString& str, int& offset,
-				      int ysize, const GameState& ref) {
-  if (pattern.indexIn(str, offset, QRegExp::CaretAtOffset) != -1) {
-    Point from;
-    typename Serializer<LegalityCheck>::Piece::Type type;
-    bool promoted;
-    int promotion;
-    Move candidate;
-
-    type = getType(pattern.cap(3)[0]);
-    promoted = pattern.cap(2) == "+";
-    Point to(ref.board().size().x - pattern.cap(8)[0].digitValue(),
-	     pattern.cap(8)[1].toAscii() - 'a');
-    promotion = (pattern.cap(9) == "+") ? 1 : -1;
-
-    if (pattern.cap(7) == "*")			  // is a drop ?
-      return Move(Piece(ref.turn(), type), to);
-
-    from = Point((pattern.cap(5).length() == 0) ? -1 :
-		 ref.board().size().x - pattern.cap(5)[0].digitValue(),
-		 (pattern.cap(6).length() == 0) ? -1 :
-		 pattern.cap(6)[0].toAscii() - 'a');
-
-    if (from.valid()) {				  // explicit from ?
-      candidate = Move(from, to, static_cast<typename Piece::Type>(promotion));
-    }
-    else { // resolve implicit from
-      for (int i = 0; i < ref.board().size().x; i++) {
-	for (int j = 0; j < ref.board().size().y; j++) {
-	  Point p(i, j);
-	  Piece piece = ref.board().get(p);
-
-	  Move mv(p, to, static_cast<typename Piece::Type>(promotion));
-	  if (p.resembles(from) &&
-	      piece.type() == type &&
-	      piece.promoted() == promoted &&
-	      piece.color() == ref.turn()) {
-
-	    LegalityCheck check(ref);
-	    if (check.legal(mv))  {
-	      if (candidate.valid()) {
-		// ambiguous!
-		kDebug() << "ambiguous";
-		return Move();
-	      }
-	      else {
-		// ok, we have found a candidate move
-		candidate = mv;
-	      }
-	    }
-	  }
-	}
+// Moves have the form
+//   [[+]piece] [column][row] [- x *] [column row] [+ =] [? !]...
+// where the first square is the starting one, if both are present.
+template <typename MoveGenerator>
+typename Serializer<MoveGenerator>::Move
+Serializer<MoveGenerator>::parse(const QString& str, int& offset,
+                                 int ysize, const GameState& ref) {
+  using namespace Notation;
+
+  if (offset > str.length()) {
+    kDebug() << "error!!!! " << qPrintable(str.mid(offset));
+    return Move(Point::invalid(),Point::invalid());
+  }
+
+  const int size_x = ref.board().size().x;
+  int pos = offset;
+
+  bool promoted = false;
+  if (at(str, pos) == '+' && isOneOf(at(str, pos + 1), "PRBLNSGK")) {
+    promoted = true;
+    pos++;
+  }
+  QChar letter;
+  if (isOneOf(at(str, pos), "PRBLNSGK"))
+    letter = str[pos++];
+  typename Piece::Type type = getType(letter);
+
+  const int from_begin = pos;
+  const int from_end = pos = skipDigits(str, pos);
+  int from_row = -1;
+  if (isLetter(at(str, pos)) && at(str, pos) != 'x')
+    from_row = at(str, pos++) - 'a';
+
+  ushort separator = 0;
+  if (isOneOf(at(str, pos), "-x*"))
+    separator = at(str, pos++);
+
+  Point from(from_end == from_begin ? -1 : size_x - number(str, from_begin, from_end), from_row);
+  Point to = Point::invalid();
+  const int to_end = skipDigits(str, pos);
+  if (to_end > pos && isLetter(at(str, to_end))) {
+    to = Point(size_x - number(str, pos, to_end), at(str, to_end) - 'a');
+    pos = to_end + 1;
+  }
+  else if (!separator && from.x != -1 && from.y != -1) {
+    // a single square, like in P7f, is the destination
+    to = from;
+    from = Point::invalid();
+  }
+
+  int promotion = -1;
+  if (isOneOf(at(str, pos), "+=")) {
+    if (at(str, pos) == '+')
+      promotion = 1;
+    pos++;
+  }
+  while (isOneOf(at(str, pos), "?!"))
+    pos++;
+  offset = pos;
+
+  if (separator == '*')  // is a drop ?
+    return Move(Piece(ref.turn(), type), to);
+
+  Move candidate;
+  if (from.valid()) {  // explicit from ?
+    candidate = Move(from, to, static_cast<typename Piece::Type>(promotion));
+  }
+  else if (const std::vector<Move>* moves = m_moves ? m_moves->find(ref) : 0) {
+    // look implicit from up
+    Point p = Point::invalid();
+    for (unsigned int i = 0; i < moves->size(); i++) {
+      const Move& mv = (*moves)[i];
+      if (mv.to() != to || mv.drop() != Piece() ||
+          mv.from() == p || !mv.from().resembles(from))
+        continue;
+
+      Piece piece = ref.board().get(mv.from());
+      if (piece.type() == type &&
+          piece.promoted() == promoted) {
+        if (p.valid()) {
+          // ambiguous!
+          kDebug() << "ambiguous";
+          return Move();
+        }
+        else {
+          // ok, we have found a candidate move
+          p = mv.from();
+        }
       }
     }
 
-    if (!candidate.valid())
-      kError() << "Piece not found";
-
-    offset += pattern.matchedLength();
-    return candidate;
+    if (p.valid()) {
+      // generated moves come with and without promotion
+      Move mv(p, to, static_cast<typename Piece::Type>(promotion));
+      LegalityCheck check(ref);
+      if (check.legal(mv))
+        candidate = mv;
+    }
   }
-  else {
-    kDebug() << "error!!!! " << qPrintable(str.mid(offset));
-    return Move(Point::invalid(),Point::invalid());
+  else { // resolve implicit from
+    LegalityCheck check(ref);
+    for (int i = 0; i < ref.board().size().x; i++) {
+      for (int j = 0; j < ref.board().size().y; j++) {
+        Point p(i, j);
+        Piece piece = ref.board().get(p);
+
+        Move mv(p, to, static_cast<typename Piece::Type>(promotion));
+        if (p.resembles(from) &&
+            piece.type() == type &&
+            piece.promoted() == promoted &&
+            piece.color() == ref.turn()) {
+
+          if (check.legal(mv))  {
+            if (candidate.valid()) {
+              // ambiguous!
+              kDebug() << "ambiguous";
+              return Move();
+            }
+            else {
+              // ok, we have found a candidate move
+              candidate = mv;
+            }
+          }
+        }
+      }
+    }
   }
+
+  if (!candidate.valid())
+    kError() << "Piece not found";
+
+  return candidate;
 }
 
-template <typename LegalityCheck>
-typename Serializer<LegalityCheck>::Move
-Serializer<LegalityCheck>::parse(const QString& str, int ysize,
+template <typename MoveGenerator>
+typename Serializer<MoveGenerator>::Move
+Serializer<MoveGenerator>::parse(const QString& str, int ysize,
 				      const GameState& ref) {
   int offset = 0;
   return parse(str, offset, ysize, ref);
 }
 
-template <typename LegalityCheck>
-typename Serializer<LegalityCheck>::Move
-Serializer<LegalityCheck>::deserialize(const QString& str, const GameState& ref) {
+template <typename MoveGenerator>
+typename Serializer<MoveGenerator>::Move
+Serializer<MoveGenerator>::deserialize(const QString& str, const GameState& ref) {
   if (str[0].isDigit()) {
     // this is a move
     Point orig(ref.board().size().x - str[0].digitValue(), str[1].toAscii() - 'a');
@@ -14,6 +14,7 @@
 #include "tagua.h"
 #include "fwd.h"
 #include "movefactory.h"
+#include "movelist.h"
 #include "nopool.h"
 #include "variantdata.h"
 
@@ -143,7 +144,7 @@ namespace HLVariant {
       WrappedPosition<Variant>* ref = dynamic_cast<WrappedPosition<Variant>*>(_ref.get());
   
       if (ref) {
-        Serializer serializer(rep);
+        Serializer serializer(rep, &ref->moveList());
         return serializer.serialize(m_move, ref->inner());
       }
       else {
@@ -195,6 +196,54 @@ namespace HLVariant {
     }
   };
 
+  /**
+    * Metafunction that lists the legal moves of a state as user moves,
+    * or returns false when the move generator cannot enumerate them.
+    * The moves are taken from @a list, which is only generated again
+    * when the state is a different position.
+    */
+  template <typename Variant, bool canGenerate>
+  struct ListMovesAux {
+    static bool apply(const typename VariantData<Variant>::GameState& state,
+                      MoveList<typename VariantData<Variant>::MoveGenerator>& list,
+                      std::vector<NormalUserMove>& moves,
+                      std::vector<DropUserMove>& drops) {
+      typedef typename VariantData<Variant>::Move Move;
+      const std::vector<Move>& legal = list.moves(state);
+
+      typename VariantData<Variant>::MoveFactory factory;
+      for (unsigned int i = 0; i < legal.size(); i++) {
+        DropUserMove drop(-1, -1, Point::invalid());
+        if (factory.toDrop(legal[i], drop))
+          drops.push_back(drop);
+        else
+          moves.push_back(factory.toNormal(legal[i]));
+      }
+      return true;
+    }
+  };
+
+  template <typename Variant>
+  struct ListMovesAux<Variant, false> {
+    static bool apply(const typename VariantData<Variant>::GameState&,
+                      MoveList<typename VariantData<Variant>::MoveGenerator>&,
+                      std::vector<NormalUserMove>&,
+                      std::vector<DropUserMove>&) {
+      return false;
+    }
+  };
+
+  template <typename Variant>
+  struct ListMoves {
+    static bool apply(const typename VariantData<Variant>::GameState& state,
+                      MoveList<typename VariantData<Variant>::MoveGenerator>& list,
+                      std::vector<NormalUserMove>& moves,
+                      std::vector<DropUserMove>& drops) {
+      return ListMovesAux<Variant, VariantData<Variant>::MoveGenerator::canGenerate>
+        ::apply(state, list, moves, drops);
+    }
+  };
+
   template <typename Variant>
   class WrappedPosition : public AbstractPosition {
     typedef typename VariantData<Variant>::LegalityCheck LegalityCheck;
@@ -203,12 +252,22 @@ namespace HLVariant {
     typedef typename VariantData<Variant>::Piece Piece;
     typedef typename VariantData<Variant>::Move Move;
     typedef typename VariantData<Variant>::Serializer Serializer;
+    typedef typename VariantData<Variant>::MoveGenerator MoveGenerator;
     
     GameState m_state;
+    
+    /** legal moves of the last positions seen, see moveList() */
+    mutable MoveList<MoveGenerator> m_moves;
   public:
     const GameState& inner() const { return m_state; }
     GameState& inner() { return m_state; }
     
+    /**
+      * Legal moves of this position, and of those its moves lead to,
+      * shared by the serializers working on it.
+      */
+    MoveList<MoveGenerator>& moveList() const { return m_moves; }
+    
     WrappedPosition(const GameState& state)
     : m_state(state) { }
     
@@ -296,6 +355,11 @@ namespace HLVariant {
       }
     }
   
+    virtual bool legalMoves(std::vector<NormalUserMove>& moves,
+                            std::vector<DropUserMove>& drops) const {
+      return ListMoves<Variant>::apply(m_state, m_moves, moves, drops);
+    }
+
     virtual void move(const MovePtr& _move) {
       if (!_move)
         return;
@@ -326,15 +390,20 @@ namespace HLVariant {
       WrappedPosition<Variant>* other = dynamic_cast<WrappedPosition<Variant>*>(_other.get());
   
       if (other)
-        return m_state == other->inner();
+        return m_state.hash() == other->inner().hash() &&
+               m_state == other->inner();
       else {
         MISMATCH(*_other.get(), WrappedPosition<Variant>);
         return false;
       }
     }
   
+    virtual quint64 hash() const {
+      return m_state.hash();
+    }
+  
     virtual MovePtr getMove(const QString& san) const {
-      Serializer serializer("compact");
+      Serializer serializer("compact", &m_moves);
       Move res = serializer.deserialize(san, m_state);
       if (res.valid()) {
         return MovePtr(new WrappedMove<Variant>(res));
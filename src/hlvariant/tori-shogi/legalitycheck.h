@@ -33,6 +33,7 @@ public:
   bool legal(Move& move) const;
   bool pseudolegal(Move& move) const;
   bool canBeCaptured(const GameState& state, const Point& point) const;
+  virtual typename Piece::Type royalType() const;
 protected:
   virtual bool stuckPiece(const Piece& piece, const Point& p) const;
 };
@@ -153,8 +154,12 @@ bool LegalityCheck<GameState>::pseudolegal(Move& move) const {
     if (piece != Piece() && getMoveType(piece, move)) {
       if (Base::m_state.canPromote(piece) &&
             (Base::m_state.promotionZone(piece.color(), move.to()) ||
-            Base::m_state.promotionZone(piece.color(), move.from())))
+            Base::m_state.promotionZone(piece.color(), move.from()))) {
+        // a piece which could not move any more has to promote
+        if (stuckPiece(piece, move.to()))
+          move = Move(move.from(), move.to(), 0);
         move.setType(Move::PROMOTION);
+      }
       return true;
     }
     else {
@@ -166,18 +171,14 @@ bool LegalityCheck<GameState>::pseudolegal(Move& move) const {
 
 // strict copy from Shogi, for template-instantation reasons
 template <typename GameState>
-  bool LegalityCheck<GameState>::canBeCaptured(const GameState& state, const Point& point) const {
-  for (int i = 0; i < state.board().size().x; i++) {
-    for (int j = 0; j < state.board().size().y; j++) {
-      Point p(i, j);
-      Piece piece = state.board().get(p);
-      LegalityCheck<GameState> check(state);
-      if (piece.color() == state.turn() && check.getMoveType(piece, Move(p, point))) {
-        return true;
-      }
-    }
-  }
-  return false;
+bool LegalityCheck<GameState>::canBeCaptured(const GameState& state, const Point& point) const {
+  LegalityCheck<GameState> check(state);
+  return check.computeAttacks(state.turn(), point);
+}
+
+template <typename GameState>
+typename LegalityCheck<GameState>::Piece::Type LegalityCheck<GameState>::royalType() const {
+  return Piece::PHOENIX;
 }
 
 template <typename GameState>
@@ -185,19 +186,18 @@ bool LegalityCheck<GameState>::legal(Move& move) const {
   if (!pseudolegal(move))
     return false;
 
-  GameState tmp(Base::m_state);
-  tmp.move(move);
+  // try the move on a copy, and take it back afterwards
+  GameState& state = Base::scratch();
+  typename Piece::Color turn = state.turn();
+  typename GameState::UndoInfo undo = state.undoInfo(move);
+  state.move(move);
 
-  // find king position
-  Point king_pos = tmp.board().find(Piece(Base::m_state.turn(), Piece::PHOENIX));
-  if (!king_pos.valid())
-    return false;
-
-  // check if the king can be captured
-  if (canBeCaptured(tmp, king_pos))
-    return false;
+  // find king position, and check if the king can be captured
+  Point king_pos = state.board().find(Piece(turn, Piece::PHOENIX));
+  bool res = king_pos.valid() && !canBeCaptured(state, king_pos);
 
-  return true;
+  state.unmove(move, undo);
+  return res;
 }
 
 template <typename GameState>
@@ -0,0 +1,32 @@
+/*
+  Copyright (c) 2007 Paolo Capriotti <p.capriotti@gmail.com>
+            (c) 2007 Maurizio Monge <maurizio.monge@kdemail.net>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#ifndef HLVARIANT__TORI_SHOGI__MOVEGENERATOR_H
+#define HLVARIANT__TORI_SHOGI__MOVEGENERATOR_H
+
+#include "../shogi/movegenerator.h"
+
+namespace HLVariant {
+namespace ToriShogi {
+
+template <typename _LegalityCheck>
+class MoveGenerator : public Shogi::MoveGenerator<_LegalityCheck> {
+  typedef Shogi::MoveGenerator<_LegalityCheck> Base;
+public:
+  typedef typename Base::GameState GameState;
+  typedef typename Base::Piece Piece;
+
+  MoveGenerator(const GameState& state) : Base(state) { }
+};
+
+} // namespace ToriShogi
+} // namespace HLVariant
+
+#endif // HLVARIANT__TORI_SHOGI__MOVEGENERATOR_H
@@ -14,26 +14,7 @@
 namespace HLVariant {
 namespace ToriShogi {
 
-Piece::Piece(Color color, Type type, bool promoted)
-: m_color(color)
-, m_type(type)
-, m_promoted(promoted) { }
-
-Piece::~Piece() { }
-
-void Piece::setPromoted() {
-  m_promoted = true;
-}
-
-bool Piece::promoted() const {
-  return m_promoted;
-}
-
-Piece::Color Piece::color() const { return m_color; }
-
-Piece::Type Piece::type() const { return m_type; }
-
-QString Piece::colorName() const { return colorName(m_color); }
+QString Piece::colorName() const { return colorName(color()); }
 
 QString Piece::colorName(Color color) {
   switch (color) {
@@ -46,7 +27,7 @@ QString Piece::colorName(Color color) {
   }
 }
 
-QString Piece::typeName() const { return typeName(m_type); }
+QString Piece::typeName() const { return typeName(type()); }
 
 QString Piece::typeName(Type type) {
   switch (type) {
@@ -73,7 +54,7 @@ QString Piece::typeName(Type type) {
 
 QString Piece::name() const {
   QString res = colorName() + '_';
-  if (m_promoted)
+  if (promoted())
     res += "p_";
   return res + typeName();
 }
@@ -83,16 +64,6 @@ Piece::Color Piece::oppositeColor(Color color) {
     (color == BLACK) ? WHITE : INVALID_COLOR;
 }
 
-bool Piece::operator==(const Piece& other) const {
-  return m_color == other.m_color &&
-         m_type == other.m_type &&
-         m_promoted == other.m_promoted;
-}
-
-bool Piece::operator!=(const Piece& other) const {
-  return !((*this) == other);
-}
-
 
 } // namespace ToriShogi
 } // namespace HLVariant
@@ -20,25 +20,26 @@
 namespace HLVariant {
 namespace ToriShogi {
 
-template <typename _LegalityCheck>
-  class Serializer: public HLVariant::Shogi::Serializer<_LegalityCheck> {
+template <typename _MoveGenerator>
+  class Serializer: public HLVariant::Shogi::Serializer<_MoveGenerator> {
 public:
-  typedef HLVariant::Shogi::Serializer<_LegalityCheck> Base;
-  typedef _LegalityCheck LegalityCheck;
+  typedef HLVariant::Shogi::Serializer<_MoveGenerator> Base;
+  typedef _MoveGenerator MoveGenerator;
+  typedef typename Base::LegalityCheck LegalityCheck;
   typedef typename LegalityCheck::GameState GameState;
   typedef typename GameState::Board Board;
   typedef typename Board::Piece Piece;
-  Serializer(const QString& rep);
+  Serializer(const QString& rep, MoveList<MoveGenerator>* moves = 0);
 protected:
   virtual QString symbol(const Piece& piece) const;
 };
 
-template <typename LegalityCheck>
-Serializer<LegalityCheck>::Serializer(const QString& rep)
-: Base(rep) { }
+template <typename MoveGenerator>
+Serializer<MoveGenerator>::Serializer(const QString& rep, MoveList<MoveGenerator>* moves)
+: Base(rep, moves) { }
 
-template <typename LegalityCheck>
-QString Serializer<LegalityCheck>::symbol(const Piece& piece) const {
+template <typename MoveGenerator>
+QString Serializer<MoveGenerator>::symbol(const Piece& piece) const {
   if (Base::m_rep == "decorated") {
     QString res = "{";
     if (piece.promoted())
@@ -18,6 +18,7 @@
 #include "../crazyhouse/move.h"
 #include "gamestate.h"
 #include "legalitycheck.h"
+#include "movegenerator.h"
 #include "serializer.h"
 #include "../crazyhouse/movefactory.h"
 #include "../animator.h"
@@ -31,10 +32,10 @@ struct TAGUA_EXPORT Variant {
   typedef Crazyhouse::MoveMixin<Chess::Move, Piece> Move;
   typedef GameState<Shogi::ShogiBan<7, 7, Piece>, Move> GameState;
   typedef LegalityCheck<GameState> LegalityCheck;
-  typedef Serializer<LegalityCheck> Serializer;
+  typedef MoveGenerator<LegalityCheck> MoveGenerator;
+  typedef Serializer<MoveGenerator> Serializer;
   typedef DropAnimatorMixin<SimpleAnimator<Variant> > Animator;
   typedef Crazyhouse::MoveFactory<GameState> MoveFactory;
-  typedef Variant MoveGenerator; // to make VariantData happy
 
   static const bool hasICS = false;
   static const bool m_simple_moves = false;
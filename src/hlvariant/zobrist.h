@@ -0,0 +1,81 @@
+/*
+  Copyright (c) 2007 Paolo Capriotti <p.capriotti@gmail.com>
+            (c) 2007 Maurizio Monge <maurizio.monge@kdemail.net>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#ifndef HLVARIANT__ZOBRIST_H
+#define HLVARIANT__ZOBRIST_H
+
+#include <QtGlobal>
+
+namespace HLVariant {
+
+/**
+  * Random keys for Zobrist hashing of game states.
+  *
+  * A key is obtained by scrambling the coordinates of the feature
+  * it represents, instead of looking it up in a table, so that keys
+  * are available for boards and pools of any size.
+  * Features that are absent (empty squares, zero pieces of some type
+  * in a pool) have a null key, so that an empty board hashes to 0.
+  */
+class Zobrist {
+  enum Category {
+    SquareKey = 1,
+    PoolKey,
+    TurnKey,
+    CastlingKey,
+    EnPassantKey
+  };
+
+  static quint64 key(Category category, int a, int b = 0, int c = 0) {
+    quint64 x = (quint64(category) << 56) ^ (quint64(a & 0xffff) << 32)
+              ^ (quint64(b & 0xffff) << 16) ^ quint64(c & 0xffff);
+
+    // splitmix64 finalizer
+    x += Q_UINT64_C(0x9e3779b97f4a7c15);
+    x = (x ^ (x >> 30)) * Q_UINT64_C(0xbf58476d1ce4e5b9);
+    x = (x ^ (x >> 27)) * Q_UINT64_C(0x94d049bb133111eb);
+    return x ^ (x >> 31);
+  }
+public:
+  /**
+    * \param code The hash code of a piece, 0 for an empty square.
+    * \param index The linear index of a board square.
+    */
+  static quint64 square(int code, int index) {
+    return code ? key(SquareKey, code, index) : 0;
+  }
+
+  /**
+    * Key for a pool containing @a count pieces of type @a type.
+    */
+  static quint64 pool(int owner, int type, int count) {
+    return count > 0 ? key(PoolKey, owner, type, count) : 0;
+  }
+
+  static quint64 turn(int color) { return key(TurnKey, color); }
+
+  /**
+    * \param flag An index identifying a castling right.
+    */
+  static quint64 castling(int flag) { return key(CastlingKey, flag); }
+
+  static quint64 enPassant(int index) { return key(EnPassantKey, index); }
+
+  /**
+    * \return The hash code of @a piece, which is 0 for an invalid piece.
+    */
+  template <typename Piece>
+  static int code(const Piece& piece) { return piece.hashCode(); }
+  static int code(int piece) { return piece; }
+};
+
+} // namespace HLVariant
+
+#endif // HLVARIANT__ZOBRIST_H
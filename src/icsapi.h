@@ -33,7 +33,28 @@ public:
                 bool bkCastle,
                 bool bqCastle,
                 const Point& ep) = 0;
-                
+
+  /**
+    * Create a position and fill its board in one go.
+    * \param board The 64 squares of a style12 board, rank by rank
+    *              starting from the 8th, using piece letters and '-'
+    *              for empty squares.
+    * The default implementation creates each piece separately.
+    */
+  virtual PositionPtr createChessboard(
+                int turn,
+                bool wkCastle,
+                bool wqCastle,
+                bool bkCastle,
+                bool bqCastle,
+                const Point& ep,
+                const QChar* board) {
+    PositionPtr res = createChessboard(turn, wkCastle, wqCastle, bkCastle, bqCastle, ep);
+    for (int i = 0; i < 64; i++)
+      res->set(Point(i % 8, i / 8), createPiece(QString(board[i])));
+    return res;
+  }
+
 
   /**
     * Create a new piece using the given description string.
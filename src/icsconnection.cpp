@@ -18,10 +18,25 @@
 #include "gameinfo.h"
 #include "pgnparser.h"
 #include "icslistener.h"
+#include "latency.h"
+#include "premove.h"
 #include "variants.h"
 
 using namespace boost;
 
+namespace {
+
+/** \return Whether @a str contains @a prefix at @a offset */
+bool hasPrefix(const QString& str, int offset, const char* prefix) {
+  for (int i = 0; prefix[i]; i++, offset++) {
+    if (offset >= str.length() || str[offset] != QLatin1Char(prefix[i]))
+      return false;
+  }
+  return true;
+}
+
+}
+
 QRegExp ICSConnection::pressReturn("^Press return to enter the server as \"\\S+\":");
 
 // example: Creating: azsxdc (++++) Hispanico (1684) unrated crazyhouse 3 0
@@ -70,11 +85,12 @@ QRegExp ICSConnection::goBack("^Game (\\d+): (\\S+) backs up (\\d+) moves?\\.");
 
 ICSConnection::ICSConnection()
 : incomingGameInfo(0)
+, m_processed_offset(0)
 , m_move_list_game_info(NULL)
 , m_move_list_position_info(NULL)
 , m_move_list_pool_info(NULL) {
   state = Normal;
-  connect(this, SIGNAL(receivedLine(QString, int)), this, SLOT(process(QString)));
+  connect(this, SIGNAL(receivedLines(QStringList, int)), this, SLOT(processLines(QStringList)));
   connect(this, SIGNAL(receivedText(QString, int)), this, SLOT(processPartialLine(QString)));
 }
 
@@ -86,22 +102,55 @@ bool ICSConnection::test(const QRegExp& pattern, const QString& str) {
   else return false;
 }
 
+ICSConnection::LineType ICSConnection::classify(const QString& str) const {
+  const int offset = m_processed_offset;
+  if (offset >= str.length())
+    return OtherLine;
+
+  switch (str[offset].unicode()) {
+  case '<':
+    if (hasPrefix(str, offset, "<12>")) return Style12Line;
+    if (hasPrefix(str, offset, "<b1>")) return PoolLine;
+    break;
+  case 'C':
+    if (hasPrefix(str, offset, "Creating: ")) return CreatingLine;
+    break;
+  case 'G':
+    if (hasPrefix(str, offset, "Game")) return ObservedGameLine;
+    break;
+  case '{':
+    if (hasPrefix(str, offset, "{Game")) return GameLine;
+    break;
+  case 'Y':
+    if (hasPrefix(str, offset, "You")) return UnexamineLine;
+    break;
+  case 'R':
+    if (hasPrefix(str, offset, "Removing")) return UnobserveLine;
+    break;
+  case 'M':
+    if (hasPrefix(str, offset, "Movelist")) return MoveListStartLine;
+    break;
+  }
+  return OtherLine;
+}
+
 void ICSConnection::processPartialLine(QString str) {
 //  kDebug() << "processing (partial) " << str;
-  if (test(fics, str)) {
+  QChar first = m_processed_offset < str.length() ? str[m_processed_offset] : QChar();
+  if (str.indexOf("% ", m_processed_offset) != -1 && test(fics, str)) {
 //    kDebug() << "matched prompt";
     prompt();
   }
-  else if (test(beep, str)) {
+  else if (first == '\a' && test(beep, str)) {
     notification();
   }
-  else if (test(pressReturn, str)) {
+  else if (first == 'P' && test(pressReturn, str)) {
     registeredNickname();
   }
-  else if (test(login, str)) {
+  else if (first == 'l' && test(login, str)) {
     loginPrompt();
   }
-  else if (test(password, str)) {
+  else if (first == 'p' && test(password, str)) {
     passwordPrompt();
   }
   else {
@@ -110,14 +159,22 @@ void ICSConnection::processPartialLine(QString str) {
   }
 }
 
+void ICSConnection::processLines(QStringList lines) {
+  for (int i = 0; i < lines.size(); i++)
+    process(lines[i]);
+}
+
 void ICSConnection::process(QString str) {
+  // only the pattern the line can match is tried, most lines match none
+  LineType type = classify(str);
+
   switch(state) {
   case Normal:
-    if (test(creating, str)) {
+    if (type == CreatingLine && test(creating, str)) {
       delete incomingGameInfo;
       incomingGameInfo = new GameInfo(creating, 1);
     }
-    else if(test(observed_game, str)) {
+    else if (type == ObservedGameLine && test(observed_game, str)) {
       if(incomingGameInfo)
         delete incomingGameInfo;
       incomingGameInfo = new GameInfo(Player(observed_game.cap(2), observed_game.cap(3).toInt()),
@@ -129,7 +186,7 @@ void ICSConnection::process(QString str) {
       m_games[number] = ICSGameData(-1, incomingGameInfo->type());
       //kDebug() << "ok, obs " << number << " of type " << incomingGameInfo->type();
     }
-    else if (test(game, str)) {
+    else if (type == GameLine && test(game, str)) {
       //kDebug() << "matched game. incomingGameInfo = " << incomingGameInfo;
       if(game.cap(4).startsWith("Creating") || game.cap(4).startsWith("Continuing") ) {
         if (!incomingGameInfo) {
@@ -157,30 +214,48 @@ void ICSConnection::process(QString str) {
         }
       }
     }
-    else if (test(unexamine, str)) {
+    else if (type == UnexamineLine && test(unexamine, str)) {
       //kDebug() << "matching examined game end";
       int gameNumber = unexamine.cap(1).toInt();
       m_games.erase(gameNumber);
       endingExaminedGame(gameNumber);
     }
-    else if (test(unobserve, str)) {
+    else if (type == UnobserveLine && test(unobserve, str)) {
       int gameNumber = unobserve.cap(1).toInt();
       m_games.erase(gameNumber);
       endingObservedGame(gameNumber);
     }
-    else if (test(move_list_start, str)) {
+    else if (type == MoveListStartLine && test(move_list_start, str)) {
       //kDebug() << "entering move list state";
       m_move_list_game_num = move_list_start.cap(1).toInt();
       state = MoveListHeader;
     }
-    else {
+    else if (type == Style12Line) {
       PositionInfo positionInfo;
       bool game_start = positionInfo.load(m_games, str);
+      Latency::instance().mark(Latency::Dispatch);
       if (positionInfo.valid) {
         int gameNumber = positionInfo.gameNumber;
-        GameList::const_iterator game_it = m_games.find(gameNumber);
+        GameList::iterator game_it = m_games.find(gameNumber);
         Q_ASSERT(game_it != m_games.end());
 
+        // answer with the premove before anything else happens, but only
+        // to the opponent's move: takebacks and refreshes do not trigger it
+        ICSGameData& data = game_it->second;
+        if (data.last_index != -1 && positionInfo.index() < data.last_index)
+          data.premove.reset();
+        else if (data.premove && data.last_index != -1 &&
+                 positionInfo.index() == data.last_index + 1 &&
+                 positionInfo.relation == PositionInfo::MyMove) {
+          AbstractMove::Ptr move = data.premove->execute(positionInfo.position);
+          data.premove.reset();
+          if (move && sendTextNow(move->toString("simple", positionInfo.position))) {
+            positionInfo.sentPremove = move;
+            Latency::instance().mark(Latency::PremoveSend);
+          }
+        }
+        data.last_index = positionInfo.index();
+
         bool incoming = incomingGameInfo &&
                         incomingGameInfo->gameNumber() == gameNumber;
         
@@ -234,14 +309,14 @@ void ICSConnection::process(QString str) {
           notification();
         }
       }
-      else {
-        PoolInfo pool_info(m_games, str);
-        if (pool_info.m_valid) {
-          // BROKEN
-          if (!pool_info.m_added_piece) {
-            if (shared_ptr<ICSListener> listener = m_games[pool_info.m_game_num].listener.lock())
-              listener->notifyPool(pool_info);
-          }
+    }
+    else if (type == PoolLine) {
+      PoolInfo pool_info(m_games, str);
+      if (pool_info.m_valid) {
+        // BROKEN
+        if (!pool_info.m_added_piece) {
+          if (shared_ptr<ICSListener> listener = m_games[pool_info.m_game_num].listener.lock())
+            listener->notifyPool(pool_info);
         }
       }
     }
@@ -284,16 +359,16 @@ void ICSConnection::process(QString str) {
       //kDebug() << "move list ign2: " << str;
       state = MoveListMoves;
     }
-    else {
+    else if (type == Style12Line) {
       PositionInfo pi;
       pi.load(m_games, str);
       if (pi.valid)
         m_move_list_position_info = new PositionInfo(pi);
-      else {
-        PoolInfo pooli(m_games, str);
-        if(pooli.m_valid)
-          m_move_list_pool_info = new PoolInfo(pooli);
-      }
+    }
+    else if (type == PoolLine) {
+      PoolInfo pooli(m_games, str);
+      if(pooli.m_valid)
+        m_move_list_pool_info = new PoolInfo(pooli);
     }
     break;
   case MoveListMoves:
@@ -352,6 +427,12 @@ void ICSConnection::setListener(int gameNumber, const weak_ptr<ICSListener>& lis
   m_games[gameNumber].listener = listener;
 }
 
+void ICSConnection::setPremove(int gameNumber, const shared_ptr<Premove>& premove) {
+  GameList::iterator it = m_games.find(gameNumber);
+  if (it != m_games.end())
+    it->second.premove = premove;
+}
+
 void ICSConnection::startup() {
   sendText("alias $ @");
   sendText("iset startpos 1");
@@ -23,6 +23,7 @@ class PGN;
 class PositionInfo;
 class PoolInfo;
 class ICSListener;
+class Premove;
 
 class ICSConnection : public Connection {
 Q_OBJECT
@@ -34,6 +35,19 @@ Q_OBJECT
     MoveListMoves
   } state;
 
+  /** kinds of lines, told apart by their first characters */
+  enum LineType {
+    OtherLine,
+    Style12Line,
+    PoolLine,
+    CreatingLine,
+    ObservedGameLine,
+    GameLine,
+    UnexamineLine,
+    UnobserveLine,
+    MoveListStartLine
+  };
+
   // patterns
   static QRegExp pressReturn;
   static QRegExp creating;
@@ -60,13 +74,27 @@ Q_OBJECT
   QString m_move_list;
 
   bool test(const QRegExp& pattern, const QString& str);
+
+  /**
+    * Find out which pattern could match @a str, looking only at
+    * the text at the current offset. No regular expression is run.
+    */
+  LineType classify(const QString& str) const;
 public:
   ICSConnection();
 
   void setListener(int gameNumber, const boost::weak_ptr<ICSListener>& listener);
+
+  /**
+    * Send @a premove in game @a gameNumber as soon as a style12 line
+    * says it is our turn, before any listener is notified.
+    * A null premove cancels it.
+    */
+  void setPremove(int gameNumber, const boost::shared_ptr<Premove>& premove);
   void startup();
 public Q_SLOTS:
   void process(QString str);
+  void processLines(QStringList lines);
   void processPartialLine(QString str);
 Q_SIGNALS:
   void notification();
@@ -15,12 +15,14 @@
 #include "variants.h"
 
 ICSGameData::ICSGameData()
-: index(0) {
+: index(0)
+, last_index(-1) {
   setType("");
 }
 
 ICSGameData::ICSGameData(int index, const QString& type)
-: index(index) {
+: index(index)
+, last_index(-1) {
   setType(type);
 }
 
@@ -11,18 +11,26 @@
 #ifndef ICSGAMEDATA_H
 #define ICSGAMEDATA_H
 
+#include <boost/shared_ptr.hpp>
 #include <boost/weak_ptr.hpp>
 #include <QString>
 
 #include "fwd.h"
 
 class ICSListener;
+class Premove;
 
 struct ICSGameData {
   int index;
   VariantPtr variant;
   ICSAPIPtr icsapi;
   boost::weak_ptr<ICSListener> listener;
+
+  /** sent by the connection as soon as the opponent has moved */
+  boost::shared_ptr<Premove> premove;
+
+  /** the index of the last position received, -1 before the first one */
+  int last_index;
   
   ICSGameData();
   ICSGameData(int index, const QString& type);
@@ -193,6 +193,21 @@ std::pair<int, int> Index::stepsTo(const Index& ix) const {
   return std::pair<int,int>(down, up);
 }
 
+bool Index::operator<=(const Index& ix) const {
+  int s = nested.size();
+  if(s == 0)
+    return num_moves <= ix.num_moves;
+  if(num_moves != ix.num_moves || ix.nested.size() < s)
+    return false;
+
+  for(int i = 0; i < s-1; i++)
+  if(nested[i] != ix.nested[i])
+    return false;
+
+  return nested[s-1].variation == ix.nested[s-1].variation
+      && nested[s-1].num_moves <= ix.nested[s-1].num_moves;
+}
+
 int Index::lastIndex() {
   return nested.size() ? nested.back().num_moves : num_moves;
 }
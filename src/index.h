@@ -11,9 +11,9 @@
 #ifndef INDEX_H
 #define INDEX_H
 
-#include <QVector>
 #include <QString>
 #include "common.h"
+#include "smallvector.h"
 #include <map>
 
 /**
@@ -39,7 +39,9 @@ public:
   };
 
   int num_moves;
-  QVector<Ref> nested;
+
+  /** variations entered on the way, kept inline up to a few levels */
+  SmallVector<Ref, 4> nested;
 
   /** Constructor, you can contruct it from an integer that
       is the number of moves played in the main line */
@@ -79,15 +81,12 @@ public:
 
   /** True if this index refers to a position 'before' than the given one */
   bool operator<(const Index& ix) const {
-    std::pair<int,int> s = stepsTo(ix);
-    return s.first == 0 && s.second>0;
+    return *this <= ix && *this != ix;
   }
 
-  /** True if this index refers to a position 'before or equal' than the given one */
-  bool operator<=(const Index& ix) const {
-    std::pair<int,int> s = stepsTo(ix);
-    return s.first == 0;
-  }
+  /** True if this index refers to a position 'before or equal' than the given one,
+      ie it is on the line from the start to the given one */
+  bool operator<=(const Index& ix) const;
 
   /** True if this index refers to a position 'after' than the given one */
   bool operator>(const Index& ix) const {
@@ -101,8 +100,7 @@ public:
 
   /** True if this index refers to the same position of the given one */
   bool operator==(const Index& ix) const {
-    std::pair<int,int> s = stepsTo(ix);
-    return s.first == 0 && s.second == 0;
+    return num_moves == ix.num_moves && nested == ix.nested;
   }
 
   /** True if this index refers to a different position of the given one */
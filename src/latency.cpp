@@ -0,0 +1,147 @@
+/*
+  Copyright (c) 2006 Paolo Capriotti <p.capriotti@gmail.com>
+            (c) 2006 Maurizio Monge <maurizio.monge@kdemail.net>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#include "latency.h"
+#include <QTime>
+#ifdef Q_OS_UNIX
+#include <sys/time.h>
+#endif
+
+Latency::Histogram::Histogram() {
+  clear();
+}
+
+void Latency::Histogram::clear() {
+  for (int i = 0; i < BucketCount; i++)
+    m_buckets[i] = 0;
+  m_count = 0;
+  m_total = 0;
+  m_min = 0;
+  m_max = 0;
+}
+
+void Latency::Histogram::add(qint64 usecs) {
+  if (usecs < 0)
+    usecs = 0;
+
+  int b = 0;
+  for (qint64 v = usecs; v > 0 && b < BucketCount - 1; v >>= 1)
+    b++;
+  m_buckets[b]++;
+
+  if (m_count == 0 || usecs < m_min)
+    m_min = usecs;
+  if (usecs > m_max)
+    m_max = usecs;
+  m_total += usecs;
+  m_count++;
+}
+
+qint64 Latency::Histogram::quantile(double fraction) const {
+  if (m_count == 0)
+    return 0;
+
+  quint64 wanted = quint64(fraction * m_count);
+  quint64 seen = 0;
+  for (int i = 0; i < BucketCount; i++) {
+    seen += m_buckets[i];
+    if (seen > wanted)
+      return qMin(i == 0 ? 0 : (Q_INT64_C(1) << i) - 1, m_max);
+  }
+  return m_max;
+}
+
+Latency::Latency()
+: m_arrival(0)
+, m_depth(0) {
+}
+
+Latency& Latency::instance() {
+  static Latency latency;
+  return latency;
+}
+
+qint64 Latency::now() {
+#ifdef Q_OS_UNIX
+  timeval tv;
+  gettimeofday(&tv, 0);
+  return qint64(tv.tv_sec) * 1000000 + tv.tv_usec;
+#else
+  static QTime start = QTime::currentTime();
+  return qint64(start.elapsed()) * 1000;
+#endif
+}
+
+void Latency::arrive() {
+  if (m_depth++ == 0)
+    m_arrival = now();
+}
+
+void Latency::done() {
+  if (m_depth > 0 && --m_depth == 0)
+    m_arrival = 0;
+}
+
+void Latency::mark(Stage stage) {
+  if (m_depth > 0)
+    m_histograms[stage].add(now() - m_arrival);
+}
+
+const char* Latency::stageName(Stage stage) {
+  switch (stage) {
+  case SocketRead:
+    return "socket read";
+  case LineFraming:
+    return "line framing";
+  case Dispatch:
+    return "dispatch";
+  case EntityUpdate:
+    return "entity update";
+  case AnimationEnqueue:
+    return "animation enqueue";
+  case PremoveSend:
+    return "premove send";
+  case PremoveReconcile:
+    return "premove reconcile";
+  default:
+    return "unknown";
+  }
+}
+
+QString Latency::report() const {
+  QString res;
+  for (int s = 0; s < StageCount; s++) {
+    const Histogram& h = m_histograms[s];
+    if (h.count() == 0)
+      continue;
+
+    res += QString("%1: %2 samples, min %3 us, mean %4 us, p50 %5 us, p99 %6 us, max %7 us\n")
+      .arg(stageName(static_cast<Stage>(s)))
+      .arg(h.count())
+      .arg(h.min())
+      .arg(h.mean())
+      .arg(h.quantile(0.5))
+      .arg(h.quantile(0.99))
+      .arg(h.max());
+
+    for (int i = 0; i < Histogram::BucketCount; i++) {
+      if (h.bucket(i) == 0)
+        continue;
+      qint64 upper = i == 0 ? 0 : (Q_INT64_C(1) << i) - 1;
+      res += QString("  <= %1 us: %2\n").arg(upper).arg(h.bucket(i));
+    }
+  }
+  return res;
+}
+
+void Latency::clear() {
+  for (int s = 0; s < StageCount; s++)
+    m_histograms[s].clear();
+}
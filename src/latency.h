@@ -0,0 +1,100 @@
+/*
+  Copyright (c) 2006 Paolo Capriotti <p.capriotti@gmail.com>
+            (c) 2006 Maurizio Monge <maurizio.monge@kdemail.net>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <QString>
+
+/**
+  * @class Latency <latency.h>
+  * @brief Time taken by data from the server to get through each stage.
+  *
+  * When data is read from the server, its arrival is recorded with
+  * @ref arrive. Each stage calls @ref mark when done, adding the time
+  * elapsed since the arrival to a histogram of its own. Marks made while
+  * no incoming data is being handled are ignored.
+  * Only use this class from the GUI thread.
+  */
+class Latency {
+public:
+  enum Stage {
+    SocketRead,
+    LineFraming,
+    Dispatch,
+    EntityUpdate,
+    AnimationEnqueue,
+    PremoveSend,
+    PremoveReconcile,
+    StageCount
+  };
+
+  /**
+    * A histogram of times in microseconds, with power of two buckets:
+    * bucket 0 holds 0, bucket i holds values in [2^(i-1), 2^i).
+    */
+  class Histogram {
+  public:
+    enum { BucketCount = 32 };
+  private:
+    quint64 m_buckets[BucketCount];
+    quint64 m_count;
+    qint64 m_total;
+    qint64 m_min;
+    qint64 m_max;
+  public:
+    Histogram();
+
+    void add(qint64 usecs);
+    void clear();
+
+    quint64 count() const { return m_count; }
+    qint64 min() const { return m_min; }
+    qint64 max() const { return m_max; }
+    qint64 mean() const { return m_count ? m_total / qint64(m_count) : 0; }
+    quint64 bucket(int i) const { return m_buckets[i]; }
+
+    /** \return An upper bound for the quantile @a fraction, e.g. 0.99 */
+    qint64 quantile(double fraction) const;
+  };
+
+private:
+  qint64 m_arrival;
+  int m_depth;
+  Histogram m_histograms[StageCount];
+
+public:
+  Latency();
+
+  /** \return The current time in microseconds */
+  static qint64 now();
+
+  /**
+    * Incoming data has been received. Calls can be nested, as long as
+    * each is matched by a call to @ref done: the outermost one counts.
+    */
+  void arrive();
+  void done();
+
+  /** @a stage has finished handling the incoming data */
+  void mark(Stage stage);
+
+  const Histogram& histogram(Stage stage) const { return m_histograms[stage]; }
+  static const char* stageName(Stage stage);
+
+  /** \return A human readable summary of all stages with data */
+  QString report() const;
+
+  void clear();
+
+  static Latency& instance();
+};
+
+#endif // LATENCY_H
@@ -9,26 +9,32 @@
 */
 
 #include "common.h"
+#include <QThreadStorage>
 #include <KDebug>
 #include "loader/context.h"
 
 namespace Loader {
 
 
-Context::Cache Context::s_cache;
+Context::Cache& Context::cache() {
+  static QThreadStorage<Cache*> caches;
+  if(!caches.hasLocalData())
+    caches.setLocalData(new Cache);
+  return *caches.localData();
+}
 
 
 void Context::flush() {
   for(KeySet::iterator i = m_references.begin();
         i != m_references.end(); ) {
-    Cache::iterator cit = s_cache.find(*i);
-    Q_ASSERT(cit != s_cache.end());
+    Cache::iterator cit = cache().find(*i);
+    Q_ASSERT(cit != cache().end());
     Q_ASSERT(cit->second.m_ref_count > 0);
 
     m_references.erase(i++);
 
     if( !--cit->second.m_ref_count )
-      s_cache.erase(cit);
+      cache().erase(cit);
   }
 }
 
@@ -25,6 +25,8 @@ namespace Loader {
   * This class offers a set of references in a global cache, to access
   * a global cache remembering which elements of the cache are being used.
   *
+  * Each thread has a cache of its own, so a context has to be used only
+  * by the thread that created it.
   */
 class Context {
 
@@ -63,7 +65,8 @@ public:
   typedef std::map<Key, Resource> Cache;
   typedef std::set<Key> KeySet;
 
-  static Cache s_cache;
+  /** the cache of the calling thread */
+  static Cache& cache();
   KeySet m_references;
 
 public:
@@ -81,9 +84,9 @@ public:
   template<typename T>
   T* get(const QString& name) {
     Key key(name, typeid(T).name());
-    Cache::iterator it = s_cache.find(key);
+    Cache::iterator it = cache().find(key);
 
-    if(it == s_cache.end())
+    if(it == cache().end())
       return NULL;
     if(!m_references.count(key)) {
       it->second.m_ref_count++;
@@ -100,10 +103,10 @@ public:
   template<typename T>
   void put(const QString& name, const T& data) {
     Key key(name, typeid(T).name());
-    Q_ASSERT(!s_cache.count(key));
+    Q_ASSERT(!cache().count(key));
     Q_ASSERT(!m_references.count(key));
 
-    s_cache[key] = Resource(data);
+    cache()[key] = Resource(data);
     m_references.insert(key);
   }
 };
@@ -0,0 +1,196 @@
+/*
+  Copyright (c) 2006 Paolo Capriotti <p.capriotti@gmail.com>
+            (c) 2006 Maurizio Monge <maurizio.monge@kdemail.net>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#include "diskcache.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QFile>
+#include <QFileInfo>
+#include <KDebug>
+#include <KStandardDirs>
+#ifdef Q_OS_UNIX
+#include <utime.h>
+#endif
+
+namespace Loader {
+
+namespace {
+
+// stored files start with these
+const quint32 MAGIC = 0x54474943; // "TGIC"
+const quint32 VERSION = 1;
+
+enum Type {
+  SingleImage,
+  ImageMap
+};
+
+// the default bound for the cache shared by all themes
+const qint64 MAX_SIZE = 64 * 1024 * 1024;
+
+}
+
+DiskCache::DiskCache(const QString& dir, qint64 max_size)
+: m_dir(dir)
+, m_max_size(max_size)
+, m_size(0) {
+  if(!m_dir.exists() && !m_dir.mkpath("."))
+    kError() << "Cannot create theme cache directory" << dir;
+
+  // newest first
+  QFileInfoList files = m_dir.entryInfoList(QDir::Files, QDir::Time);
+  for(int i = files.size() - 1; i >= 0; i--) {
+    if(files[i].suffix() == "tmp")
+      m_dir.remove(files[i].fileName());
+    else
+      insert(files[i].fileName(), files[i].size());
+  }
+  evict();
+}
+
+DiskCache& DiskCache::instance() {
+  static DiskCache cache(KStandardDirs::locateLocal("cache", "tagua/themes/"), MAX_SIZE);
+  return cache;
+}
+
+QString DiskCache::file_name(const QByteArray& key) {
+  return QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex();
+}
+
+void DiskCache::insert(const QString& name, qint64 size) {
+  remove(name);
+  m_files.push_front(name);
+  m_index[name] = std::make_pair(m_files.begin(), size);
+  m_size += size;
+}
+
+void DiskCache::remove(const QString& name) {
+  FileIndex::iterator it = m_index.find(name);
+  if(it == m_index.end())
+    return;
+
+  m_size -= it->second.second;
+  m_files.erase(it->second.first);
+  m_index.erase(it);
+}
+
+void DiskCache::touch(const QString& name) {
+  FileIndex::iterator it = m_index.find(name);
+  if(it == m_index.end())
+    return;
+
+  m_files.splice(m_files.begin(), m_files, it->second.first);
+#ifdef Q_OS_UNIX
+  // keep the order across sessions
+  utime(QFile::encodeName(m_dir.filePath(name)).constData(), NULL);
+#endif
+}
+
+void DiskCache::evict() {
+  while(m_size > m_max_size && !m_files.empty()) {
+    QString name = m_files.back();
+    remove(name);
+    m_dir.remove(name);
+  }
+}
+
+bool DiskCache::load(const QByteArray& key, ::LuaApi::ImageOrMap& value) {
+  QString name = file_name(key);
+  if(!m_index.count(name))
+    return false;
+
+  QFile file(m_dir.filePath(name));
+  if(!file.open(QIODevice::ReadOnly)) {
+    remove(name);
+    return false;
+  }
+
+  // decoding makes copies of the image data, so the mapping can go away afterwards
+  uchar* data = file.map(0, file.size());
+  QByteArray raw = data ? QByteArray::fromRawData(reinterpret_cast<const char*>(data), file.size())
+                        : file.readAll();
+  QDataStream stream(raw);
+  stream.setVersion(QDataStream::Qt_4_2);
+
+  quint32 magic, version, type;
+  stream >> magic >> version >> type;
+  bool ok = stream.status() == QDataStream::Ok && magic == MAGIC && version == VERSION;
+  if(ok && type == SingleImage) {
+    QImage image;
+    stream >> image;
+    value = image;
+  }
+  else if(ok && type == ImageMap) {
+    quint32 count;
+    stream >> count;
+    ::LuaApi::ImageMap map;
+    for(quint32 i = 0; i < count && stream.status() == QDataStream::Ok; i++) {
+      QRect rect;
+      QImage image;
+      stream >> rect >> image;
+      map[rect] = image;
+    }
+    value = map;
+  }
+  else
+    ok = false;
+  ok = ok && stream.status() == QDataStream::Ok;
+
+  if(data)
+    file.unmap(data);
+  file.close();
+
+  if(!ok) {
+    kError() << "Corrupted theme cache file" << file.fileName();
+    remove(name);
+    m_dir.remove(name);
+    return false;
+  }
+
+  touch(name);
+  return true;
+}
+
+void DiskCache::store(const QByteArray& key, const ::LuaApi::ImageOrMap& value) {
+  QString name = file_name(key);
+
+  // write to a temporary file first, so that no half written file is ever read
+  QFile file(m_dir.filePath(name + ".tmp"));
+  if(!file.open(QIODevice::WriteOnly))
+    return;
+
+  QDataStream stream(&file);
+  stream.setVersion(QDataStream::Qt_4_2);
+  stream << MAGIC << VERSION;
+  if(const QImage* image = boost::get<QImage>(&value))
+    stream << quint32(SingleImage) << *image;
+  else if(const ::LuaApi::ImageMap* map = boost::get< ::LuaApi::ImageMap>(&value)) {
+    stream << quint32(ImageMap) << quint32(map->size());
+    for(::LuaApi::ImageMap::const_iterator it = map->begin(); it != map->end(); ++it)
+      stream << it->first << it->second;
+  }
+  file.close();
+
+  if(stream.status() != QDataStream::Ok || file.error() != QFile::NoError) {
+    file.remove();
+    return;
+  }
+
+  m_dir.remove(name);
+  if(!file.rename(m_dir.filePath(name))) {
+    file.remove();
+    return;
+  }
+
+  insert(name, QFileInfo(m_dir.filePath(name)).size());
+  evict();
+}
+
+} //end namespace Loader
@@ -0,0 +1,74 @@
+/*
+  Copyright (c) 2006 Paolo Capriotti <p.capriotti@gmail.com>
+            (c) 2006 Maurizio Monge <maurizio.monge@kdemail.net>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#ifndef LOADER__DISKCACHE_H
+#define LOADER__DISKCACHE_H
+
+#include <list>
+#include <map>
+#include <QByteArray>
+#include <QDir>
+#include "luaapi/loader.h"
+
+namespace Loader {
+
+/**
+  * @class DiskCache <loader/diskcache.h>
+  * @brief A persistent cache of images rendered by themes.
+  *
+  * Each image is stored in a file named after a hash of its key, that
+  * should describe everything the image depends on. The total size of
+  * the files is bounded, and the least recently used ones are removed
+  * first when the limit is exceeded.
+  */
+class DiskCache {
+  typedef std::list<QString> Files;
+  typedef std::map<QString, std::pair<Files::iterator, qint64> > FileIndex;
+
+  QDir m_dir;
+  qint64 m_max_size;
+  qint64 m_size;
+
+  /** file names, most recently used first */
+  Files m_files;
+  FileIndex m_index;
+
+  static QString file_name(const QByteArray& key);
+
+  void insert(const QString& name, qint64 size);
+  void remove(const QString& name);
+  void touch(const QString& name);
+  void evict();
+public:
+  /**
+    * Create a cache in @a dir, holding at most @a max_size bytes.
+    * Files already in the directory are kept.
+    */
+  DiskCache(const QString& dir, qint64 max_size);
+
+  /**
+    * Look for an image.
+    * \return Whether the image was found and could be decoded.
+    */
+  bool load(const QByteArray& key, ::LuaApi::ImageOrMap& value);
+
+  /** Store an image under the key @a key */
+  void store(const QByteArray& key, const ::LuaApi::ImageOrMap& value);
+
+  /** \return the total size of the cached files */
+  qint64 size() const { return m_size; }
+
+  /** \return the cache shared by all themes */
+  static DiskCache& instance();
+};
+
+} //end namespace Loader
+
+#endif //LOADER__DISKCACHE_H
@@ -0,0 +1,195 @@
+/*
+  Copyright (c) 2006 Paolo Capriotti <p.capriotti@gmail.com>
+            (c) 2006 Maurizio Monge <maurizio.monge@kdemail.net>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#include "renderer.h"
+#include <map>
+#include <QCoreApplication>
+#include <QEvent>
+#include <QThread>
+#include <KDebug>
+#include "loader/context.h"
+#include "loader/theme.h"
+
+namespace Loader {
+
+namespace {
+
+// leave a core to the GUI thread, and do not hog big machines
+const int MAX_WORKERS = 4;
+
+}
+
+class Renderer::DoneEvent : public QEvent {
+public:
+  Job job;
+
+  DoneEvent(const Job& job)
+  : QEvent(QEvent::User)
+  , job(job) { }
+};
+
+class Renderer::Worker : public QThread {
+  /** a theme script loaded in this thread */
+  class State {
+  public:
+    Context context;
+    ::LuaApi::Loader loader;
+    QByteArray script_hash;
+    QByteArray fingerprint;
+
+    State(const ThemeInfo& info, const QByteArray& script_hash)
+    : loader(&context, info)
+    , script_hash(script_hash) {
+      loader.runFile(info.file_name);
+    }
+  };
+  typedef std::map<QString, State*> States;
+
+  Renderer& m_renderer;
+
+  void render(States& states, Job& job);
+public:
+  Worker(Renderer& renderer)
+  : m_renderer(renderer) { }
+
+  virtual void run();
+};
+
+void Renderer::Worker::run() {
+  // states are created and destroyed here, so that their contexts use the cache of this thread
+  States states;
+  Job job;
+  while(m_renderer.take(job)) {
+    render(states, job);
+    m_renderer.done(job);
+  }
+
+  for(States::iterator it = states.begin(); it != states.end(); ++it)
+    delete it->second;
+}
+
+void Renderer::Worker::render(States& states, Job& job) {
+  State*& state = states[job.info.file_name];
+  if(state && state->script_hash != job.script_hash) {
+    delete state;
+    state = NULL;
+  }
+  if(!state)
+    state = new State(job.info, job.script_hash);
+
+  ::LuaApi::Loader& loader = state->loader;
+  if(loader.error()) {
+    job.error = true;
+    job.error_string = loader.errorString();
+    return;
+  }
+
+  if(state->fingerprint != job.fingerprint) {
+    OptList ol = loader.getValue<OptList>("options", 0, NULL, true);
+    if(loader.error())
+      loader.clearError();
+    else
+      options_list_set_values(ol, job.options);
+    state->fingerprint = job.fingerprint;
+  }
+
+  job.result = loader.getValue< ::LuaApi::ImageOrMap>(job.key, job.size,
+                                      job.has_args ? &job.args : NULL, false);
+  if(loader.error()) {
+    job.error = true;
+    job.error_string = loader.errorString();
+    loader.clearError();
+  }
+}
+
+Renderer::Renderer()
+: m_quit(false) {
+}
+
+Renderer::~Renderer() {
+  {
+    QMutexLocker lock(&m_mutex);
+    m_quit = true;
+    m_queue.clear();
+    m_wait.wakeAll();
+  }
+
+  for(unsigned int i = 0; i < m_workers.size(); i++) {
+    m_workers[i]->wait();
+    delete m_workers[i];
+  }
+}
+
+Renderer& Renderer::instance() {
+  static Renderer renderer;
+  return renderer;
+}
+
+bool Renderer::take(Job& job) {
+  QMutexLocker lock(&m_mutex);
+  while(!m_quit && m_queue.empty())
+    m_wait.wait(&m_mutex);
+  if(m_quit)
+    return false;
+
+  job = m_queue.back();
+  m_queue.pop_back();
+  return true;
+}
+
+void Renderer::done(const Job& job) {
+  QMutexLocker lock(&m_mutex);
+  if(!m_quit)
+    QCoreApplication::postEvent(this, new DoneEvent(job));
+}
+
+void Renderer::customEvent(QEvent* e) {
+  if(e->type() != QEvent::User)
+    return;
+
+  const Job& job = static_cast<DoneEvent*>(e)->job;
+  if(m_themes.count(job.theme))
+    job.theme->onRendered(job);
+}
+
+void Renderer::request(const Job& job) {
+  QMutexLocker lock(&m_mutex);
+  if(m_workers.empty()) {
+    int count = qBound(1, QThread::idealThreadCount() - 1, MAX_WORKERS);
+    for(int i = 0; i < count; i++) {
+      m_workers.push_back(new Worker(*this));
+      m_workers.back()->start(QThread::LowPriority);
+    }
+  }
+
+  m_queue.push_back(job);
+  m_wait.wakeOne();
+}
+
+void Renderer::cancel(Theme* theme, int size) {
+  QMutexLocker lock(&m_mutex);
+  for(std::deque<Job>::iterator it = m_queue.begin(); it != m_queue.end(); ) {
+    if(it->theme == theme && (size == -1 || it->size == size))
+      it = m_queue.erase(it);
+    else
+      ++it;
+  }
+}
+
+void Renderer::addTheme(Theme* theme) {
+  m_themes.insert(theme);
+}
+
+void Renderer::removeTheme(Theme* theme) {
+  m_themes.erase(theme);
+  cancel(theme);
+}
+
+} //end namespace Loader
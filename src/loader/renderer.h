@@ -0,0 +1,112 @@
+/*
+  Copyright (c) 2006 Paolo Capriotti <p.capriotti@gmail.com>
+            (c) 2006 Maurizio Monge <maurizio.monge@kdemail.net>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#ifndef LOADER__RENDERER_H
+#define LOADER__RENDERER_H
+
+#include <deque>
+#include <set>
+#include <vector>
+#include <QMutex>
+#include <QObject>
+#include <QWaitCondition>
+#include "luaapi/loader.h"
+#include "option.h"
+#include "themeinfo.h"
+
+namespace Loader {
+
+class Theme;
+
+/**
+  * @class Renderer <loader/renderer.h>
+  * @brief Runs theme scripts in background threads.
+  *
+  * Each worker thread loads the themes it is asked to render with in Lua
+  * states of its own. Rendered images are handed back to the requesting
+  * Theme in the GUI thread. The most recent requests are served first,
+  * so that after a resize the current size is rendered before older ones.
+  */
+class Renderer : public QObject {
+Q_OBJECT
+
+public:
+  /** a request to render a value */
+  class Job {
+  public:
+    /** the requesting theme, only dereferenced in the GUI thread */
+    Theme* theme;
+
+    ThemeInfo info;
+    QByteArray script_hash;
+
+    /** a copy of the option values, and a key describing them */
+    OptList options;
+    QByteArray fingerprint;
+
+    QString key;
+    QString cache_key;
+    int size;
+    bool has_args;
+    ::LuaApi::LuaValueMap args;
+
+    ::LuaApi::ImageOrMap result;
+    bool error;
+    QString error_string;
+
+    Job()
+      : theme(NULL), size(0), has_args(false), error(false) { }
+  };
+
+private:
+  class Worker;
+  class DoneEvent;
+  friend class Worker;
+
+  QMutex m_mutex;
+  QWaitCondition m_wait;
+  std::deque<Job> m_queue;
+  bool m_quit;
+  std::vector<Worker*> m_workers;
+
+  /** live themes, only accessed in the GUI thread */
+  std::set<Theme*> m_themes;
+
+  Renderer();
+
+  /** wait for a job, \return false when the workers have to quit */
+  bool take(Job& job);
+
+  /** hand a job back to the GUI thread */
+  void done(const Job& job);
+
+protected:
+  virtual void customEvent(QEvent* e);
+
+public:
+  ~Renderer();
+
+  /** queue a job, starting the workers if needed */
+  void request(const Job& job);
+
+  /** drop the queued jobs of @a theme at size @a size, or at any size if it is -1 */
+  void cancel(Theme* theme, int size = -1);
+
+  /** start and stop delivering results to @a theme */
+  void addTheme(Theme* theme);
+  void removeTheme(Theme* theme);
+
+  /** \return the renderer shared by all themes */
+  static Renderer& instance();
+};
+
+} //end namespace Loader
+
+#endif //LOADER__RENDERER_H
@@ -10,9 +10,18 @@
 
 
 #include "theme.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
 #include <QHash>
+#include <QPointF>
+#include <QRectF>
 #include <KDebug>
 #include "common.h"
+#include "loader/diskcache.h"
 #include "mastersettings.h"
 
 namespace Loader {
@@ -32,21 +41,66 @@ PixmapOrMap Theme::to_pixmap_map(const ::LuaApi::ImageOrMap& m) {
     return PixmapOrMap();
 }
 
+QString Theme::cache_key(const QString& key, const ::LuaApi::LuaValueMap* args) {
+  if(!args || args->isEmpty())
+    return key;
+
+  // arguments are sorted by name, so equal maps give the same key
+  QString retv = key;
+  for(::LuaApi::LuaValueMap::const_iterator it = args->begin(); it != args->end(); ++it) {
+    retv += QChar(0) + it.key() + '=';
+    if(const double *d = boost::get<double>(&it.value()))
+      retv += QString::number(*d, 'g', 17);
+    else if(const QPointF *p = boost::get<QPointF>(&it.value()))
+      retv += QString("(%1,%2)").arg(p->x(), 0, 'g', 17).arg(p->y(), 0, 'g', 17);
+    else if(const QRectF *r = boost::get<QRectF>(&it.value()))
+      retv += QString("(%1,%2,%3,%4)").arg(r->x(), 0, 'g', 17).arg(r->y(), 0, 'g', 17)
+                                      .arg(r->width(), 0, 'g', 17).arg(r->height(), 0, 'g', 17);
+  }
+  return retv;
+}
+
+PixmapOrMap Theme::scaled(const PixmapOrMap& p, double factor) {
+  if(const QPixmap *px = boost::get<QPixmap>(&p)) {
+    if(px->isNull())
+      return p;
+    return px->scaled(px->size() * factor, Qt::IgnoreAspectRatio, Qt::FastTransformation);
+  }
+  else if(const PixmapMap *m = boost::get<PixmapMap>(&p)) {
+    PixmapMap retv;
+    for(PixmapMap::const_iterator it = m->begin(); it != m->end(); ++it) {
+      QRect r(it->first.topLeft() * factor, it->first.size() * factor);
+      retv[r] = it->second.scaled(r.size(), Qt::IgnoreAspectRatio, Qt::FastTransformation);
+    }
+    return retv;
+  }
+  return p;
+}
+
 Theme::Theme(const ThemeInfo& theme)
 : m_theme(theme)
 , m_context()
-, m_lua_loader(&m_context, theme) {
+, m_lua_loader(&m_context, theme)
+, m_cache_hits(0)
+, m_cache_misses(0)
+, m_fallback_size(0) {
   m_lua_loader.runFile(m_theme.file_name);
   if(m_lua_loader.error())
     kError() << "Script load error:" << m_lua_loader.errorString();
 
+  m_script_hash = files_hash();
+
   settings().onChange(this, "onSettingsChanged");
   onSettingsChanged();
+  Renderer::instance().addTheme(this);
 }
 
 Theme::~Theme() {
+  Renderer::instance().removeTheme(this);
   if(!m_cache.empty())
     kError() << "Sizes still referenced.";
+  kDebug() << "Theme" << m_theme.file_name << "cache hits:" << m_cache_hits
+           << "misses:" << m_cache_misses;
 }
 
 void Theme::onSettingsChanged() {
@@ -58,9 +112,96 @@ void Theme::onSettingsChanged() {
     return;
   }
 
-  if(options_list_load_from_settings(ol, entry.group("options")))
-  for(Cache::iterator it = m_cache.begin(); it != m_cache.end(); ++it)
-    it->second.m_pixmaps_cache.clear();
+  if(options_list_load_from_settings(ol, entry.group("options"))) {
+    // the old pixmaps are still good enough until the new ones are rendered
+    Cache::reverse_iterator largest = m_cache.rbegin();
+    if(largest != m_cache.rend())
+      setFallback(largest->second, largest->first);
+
+    for(Cache::iterator it = m_cache.begin(); it != m_cache.end(); ++it)
+      it->second.m_pixmaps_cache.clear();
+
+    Renderer::instance().cancel(this);
+    m_pending.clear();
+  }
+
+  m_options = options_list_duplicate(ol);
+  m_fingerprint = m_script_hash + options_list_to_string(ol).toUtf8();
+}
+
+QByteArray Theme::files_hash() const {
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+
+  // the scripts, imported ones included
+  const QStringList& scripts = m_lua_loader.files();
+  for(int i = 0; i < scripts.size(); i++) {
+    QFile script(scripts[i]);
+    if(!script.open(QIODevice::ReadOnly))
+      return QByteArray();
+    hash.addData(scripts[i].toUtf8() + '\0');
+    hash.addData(script.readAll());
+  }
+  if(scripts.isEmpty())
+    return QByteArray();
+
+  // the images and fonts the scripts may load, which are looked up in the theme directory
+  QStringList assets;
+  QDir dir = QFileInfo(m_theme.file_name).dir();
+  QDirIterator it(dir.path(), QDir::Files, QDirIterator::Subdirectories);
+  while(it.hasNext())
+    assets << it.next();
+  assets.sort();
+  for(int i = 0; i < assets.size(); i++) {
+    QFileInfo info(assets[i]);
+    hash.addData(dir.relativeFilePath(assets[i]).toUtf8() + '\0'
+                 + QByteArray::number(info.size()) + '\0'
+                 + QByteArray::number(info.lastModified().toTime_t()) + '\0');
+  }
+
+  return hash.result();
+}
+
+QByteArray Theme::disk_key(const QString& ckey, int size) const {
+  // without a hash of the script, images could not be told apart from those of other themes
+  if(m_script_hash.isEmpty())
+    return QByteArray();
+  return m_fingerprint + '\0' + QByteArray::number(size) + '\0' + ckey.toUtf8();
+}
+
+void Theme::setFallback(const SizeCache& cache, int size) {
+  if(size <= 0 || cache.m_pixmaps_cache.empty())
+    return;
+  m_fallback = cache.m_pixmaps_cache;
+  m_fallback_size = size;
+}
+
+bool Theme::approximate(const QString& ckey, int size, PixmapOrMap& retv) const {
+  const PixmapOrMap* best = NULL;
+  int best_size = 0;
+
+  for(Cache::const_iterator it = m_cache.begin(); it != m_cache.end(); ++it) {
+    if(it->first <= 0 || it->first == size)
+      continue;
+    SizeCache::PixmapsCache::const_iterator pix = it->second.m_pixmaps_cache.find(ckey);
+    if(pix != it->second.m_pixmaps_cache.end()
+        && (!best || qAbs(it->first - size) < qAbs(best_size - size))) {
+      best = &pix->second;
+      best_size = it->first;
+    }
+  }
+
+  if(m_fallback_size > 0 && (!best || qAbs(m_fallback_size - size) < qAbs(best_size - size))) {
+    SizeCache::PixmapsCache::const_iterator pix = m_fallback.find(ckey);
+    if(pix != m_fallback.end()) {
+      best = &pix->second;
+      best_size = m_fallback_size;
+    }
+  }
+
+  if(!best)
+    return false;
+  retv = best_size == size ? *best : scaled(*best, double(size) / best_size);
+  return true;
 }
 
 void Theme::refSize(int size) {
@@ -74,8 +215,14 @@ void Theme::unrefSize(int size) {
     return;
   }
 
-  if(!--it->second.m_ref_count)
+  if(!--it->second.m_ref_count) {
+    setFallback(it->second, size);
     m_cache.erase(size);
+
+    Renderer::instance().cancel(this, size);
+    m_pending.erase(m_pending.lower_bound(std::make_pair(size, QString())),
+                    m_pending.lower_bound(std::make_pair(size + 1, QString())));
+  }
 }
 
 template<typename T>
@@ -110,23 +257,113 @@ PixmapOrMap Theme::getValue<PixmapOrMap>(const QString& key, int size, const ::L
     return PixmapOrMap();
   }
 
-  if(!args) {
-    SizeCache::PixmapsCache::iterator pix = it->second.m_pixmaps_cache.find(key);
-    if(pix != it->second.m_pixmaps_cache.end())
-      return pix->second;
+  QString ckey = cache_key(key, args);
+  SizeCache::PixmapsCache::iterator pix = it->second.m_pixmaps_cache.find(ckey);
+  if(pix != it->second.m_pixmaps_cache.end()) {
+    m_cache_hits++;
+    return pix->second;
   }
-
-  PixmapOrMap retv = to_pixmap_map(m_lua_loader.getValue< ::LuaApi::ImageOrMap>(key, size, args, allow_nil));
-  if(m_lua_loader.error()) {
-    kError() << "Script run error:" << m_lua_loader.errorString();
-    m_lua_loader.clearError();
+  m_cache_misses++;
+
+  QByteArray dkey = disk_key(ckey, size);
+  ::LuaApi::ImageOrMap image;
+  if(dkey.isEmpty() || !DiskCache::instance().load(dkey, image)) {
+    image = m_lua_loader.getValue< ::LuaApi::ImageOrMap>(key, size, args, allow_nil);
+    if(m_lua_loader.error()) {
+      kError() << "Script run error:" << m_lua_loader.errorString();
+      m_lua_loader.clearError();
+    }
+    else if(!dkey.isEmpty())
+      DiskCache::instance().store(dkey, image);
   }
 
-  if(!args)
-    it->second.m_pixmaps_cache[key] = retv;
+  PixmapOrMap retv = to_pixmap_map(image);
+
+  it->second.m_pixmaps_cache[ckey] = retv;
   return retv;
 }
 
+PixmapOrMap Theme::getPixmapAsync(const QString& key, int size,
+                                  const ::LuaApi::LuaValueMap* args, bool* exact) {
+  if(exact)
+    *exact = true;
+  if(m_lua_loader.error())
+    return PixmapOrMap();
+
+  Cache::iterator it = m_cache.find(size);
+  if(it == m_cache.end()) {
+    kError() << "Size" << size << "not referenced.";
+    return PixmapOrMap();
+  }
+
+  QString ckey = cache_key(key, args);
+  SizeCache::PixmapsCache::iterator pix = it->second.m_pixmaps_cache.find(ckey);
+  if(pix != it->second.m_pixmaps_cache.end()) {
+    m_cache_hits++;
+    return pix->second;
+  }
+
+  // with nothing to show meanwhile, it is better to wait for the script
+  PixmapOrMap approx;
+  if(!approximate(ckey, size, approx))
+    return getValue<PixmapOrMap>(key, size, args);
+
+  m_cache_misses++;
+
+  // decoding is cheap enough to be done right away
+  QByteArray dkey = disk_key(ckey, size);
+  ::LuaApi::ImageOrMap image;
+  if(!dkey.isEmpty() && DiskCache::instance().load(dkey, image)) {
+    PixmapOrMap retv = to_pixmap_map(image);
+    it->second.m_pixmaps_cache[ckey] = retv;
+    return retv;
+  }
+
+  std::pair<int, QString> id(size, ckey);
+  if(!m_pending.count(id)) {
+    m_pending.insert(id);
+
+    Renderer::Job job;
+    job.theme = this;
+    job.info = m_theme;
+    job.script_hash = m_script_hash;
+    job.options = m_options;
+    job.fingerprint = m_fingerprint;
+    job.key = key;
+    job.cache_key = ckey;
+    job.size = size;
+    if(args) {
+      job.has_args = true;
+      job.args = *args;
+    }
+    Renderer::instance().request(job);
+  }
+
+  if(exact)
+    *exact = false;
+  return approx;
+}
+
+void Theme::onRendered(const Renderer::Job& job) {
+  m_pending.erase(std::make_pair(job.size, job.cache_key));
+
+  // the options or the size could have changed in the meantime
+  Cache::iterator it = m_cache.find(job.size);
+  if(job.fingerprint != m_fingerprint || it == m_cache.end())
+    return;
+
+  if(job.error)
+    kError() << "Script run error:" << job.error_string;
+  else {
+    QByteArray dkey = disk_key(job.cache_key, job.size);
+    if(!dkey.isEmpty())
+      DiskCache::instance().store(dkey, job.result);
+  }
+
+  it->second.m_pixmaps_cache[job.cache_key] = to_pixmap_map(job.result);
+  rendered();
+}
+
 template<>
 QPixmap Theme::getValue<QPixmap>(const QString& key, int size, const ::LuaApi::LuaValueMap* args, bool allow_nil) {
   PixmapOrMap p = getValue<PixmapOrMap>(key, size, args, allow_nil);
@@ -146,11 +383,13 @@ Glyph Theme::getValue<Glyph>(const QString& key, int size, const ::LuaApi::LuaVa
     return Glyph();
   }
 
-  if(!args) {
-    SizeCache::GlyphsCache::iterator pix = it->second.m_glyphs_cache.find(key);
-    if(pix != it->second.m_glyphs_cache.end())
-      return pix->second;
+  QString ckey = cache_key(key, args);
+  SizeCache::GlyphsCache::iterator pix = it->second.m_glyphs_cache.find(ckey);
+  if(pix != it->second.m_glyphs_cache.end()) {
+    m_cache_hits++;
+    return pix->second;
   }
+  m_cache_misses++;
 
   Glyph retv = m_lua_loader.getValue<Glyph>(key, size, args, allow_nil);
 
@@ -160,8 +399,7 @@ Glyph Theme::getValue<Glyph>(const QString& key, int size, const ::LuaApi::LuaVa
   }
 
   retv.m_font.setPointSize(size+retv.delta());
-  if(!args)
-    it->second.m_glyphs_cache[key] = retv;
+  it->second.m_glyphs_cache[ckey] = retv;
   return retv;
 }
 
@@ -12,9 +12,11 @@
 #define LOADER__THEME_H
 
 #include <map>
+#include <set>
 #include <QPixmap>
 #include <QObject>
 #include "loader/context.h"
+#include "loader/renderer.h"
 #include "luaapi/loader.h"
 #include "themeinfo.h"
 
@@ -28,7 +30,10 @@ typedef boost::variant<QPixmap, PixmapMap> PixmapOrMap;
   * @brief A class that represents and caches all images loaded by a theme.
   *
   * This class will be created once for each lua-scripted theme, and will cache
-  * images loaded from that theme.
+  * images loaded from that theme. Rendered images are also kept in the DiskCache,
+  * so that they survive restarts and size changes.
+  *
+  * Pixmaps can also be rendered in the background by the Renderer, see getPixmapAsync.
   */
 class Theme : public QObject {
 Q_OBJECT
@@ -54,9 +59,47 @@ private:
   Context m_context;
   LuaApi::Loader m_lua_loader;
   Cache m_cache;
+  int m_cache_hits;
+  int m_cache_misses;
+
+  /** a hash of the theme files, and of them with the values of the options */
+  QByteArray m_script_hash;
+  QByteArray m_fingerprint;
+
+  /** a copy of the options, for background rendering */
+  OptList m_options;
+
+  /** the (size, cache key) pairs being rendered in the background */
+  std::set<std::pair<int, QString> > m_pending;
+
+  /** the pixmaps of the size most recently dropped, to approximate other sizes */
+  SizeCache::PixmapsCache m_fallback;
+  int m_fallback_size;
 
   static PixmapOrMap to_pixmap_map(const ::LuaApi::ImageOrMap& m);
 
+  /** \return @a p scaled by @a factor, quickly */
+  static PixmapOrMap scaled(const PixmapOrMap& p, double factor);
+
+  /** the key of a cached value, made of its name and the arguments it has been loaded with */
+  static QString cache_key(const QString& key, const ::LuaApi::LuaValueMap* args);
+
+  /** a hash of the scripts run, and of the size and time of the files in the theme directory,
+      empty if a script cannot be read */
+  QByteArray files_hash() const;
+
+  /** the key of a value in the DiskCache, empty if the value cannot be stored there */
+  QByteArray disk_key(const QString& ckey, int size) const;
+
+  /** keep the pixmaps of @a cache at @a size as approximations */
+  void setFallback(const SizeCache& cache, int size);
+
+  /** find a pixmap in another size, and scale it to @a size */
+  bool approximate(const QString& ckey, int size, PixmapOrMap& retv) const;
+
+  friend class Renderer;
+  void onRendered(const Renderer::Job& job);
+
 private Q_SLOTS:
   void onSettingsChanged();
 
@@ -74,6 +117,25 @@ public:
   /** Loads a value */
   template<typename T>
   T getValue(const QString& key, int size, const ::LuaApi::LuaValueMap* args = NULL, bool allow_nil = false);
+
+  /**
+    * Loads a pixmap, without running the theme script if an approximation is available.
+    * In that case the pixmap is rendered in the background, a pixmap of another size
+    * is returned scaled, and rendered() will be emitted when the exact one is ready.
+    * @param exact Set to whether the returned pixmap is the exact one.
+    */
+  PixmapOrMap getPixmapAsync(const QString& key, int size,
+                             const ::LuaApi::LuaValueMap* args, bool* exact = NULL);
+
+  /** \return the number of pixmaps and glyphs taken from the cache */
+  int cacheHits() const { return m_cache_hits; }
+
+  /** \return the number of pixmaps and glyphs that had to be loaded by the theme script */
+  int cacheMisses() const { return m_cache_misses; }
+
+Q_SIGNALS:
+  /** emitted when pixmaps rendered in the background are available */
+  void rendered();
 };
 
 } //end namespace loader
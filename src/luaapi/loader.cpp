@@ -147,6 +147,8 @@ bool Loader::runFile(const QString& file, bool setdir) {
     return false;
   }
 
+  m_files << path;
+
   if(setdir) {
     QFileInfo f_info( path );
     m_curr_dir = f_info.dir();
@@ -16,6 +16,7 @@
 #include <boost/variant.hpp>
 #include <QDir>
 #include <QImage>
+#include <QStringList>
 #include "loader/image.h"
 #include "luaapi/luavalue.h"
 #include "option.h"
@@ -50,6 +51,9 @@ class Loader {
   lua_State* m_state;
   QDir m_curr_dir;
 
+  /** the scripts run so far, imported ones included */
+  QStringList m_files;
+
   static const luaL_Reg lualibs[];
 
   template<typename T> struct create_value_data;
@@ -72,6 +76,12 @@ public:
   lua_State* state() const { return m_state; }
   bool runFile(const QString& file, bool set_dir = true);
 
+  /**
+    * \return The paths of the script files run so far, in the order
+    *         they have been run, including the ones they imported.
+    */
+  const QStringList& files() const { return m_files; }
+
   template<typename T> T getValue(const QString& key, int size = 0,
                             const LuaValueMap* args = NULL, bool allow_nil = false);
 
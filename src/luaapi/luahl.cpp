@@ -188,7 +188,63 @@ static const luaL_Reg lualibs[] = {
 
 LUALIB_API void luaL_openlibs (lua_State*) { }
 
-Api::Api() {
+namespace {
+
+/**
+  * \return The literal text any match of @a re has to start with,
+  * or an empty string if @a re is not anchored or has no such text.
+  */
+QString literal_prefix(const QString& re) {
+  if (!re.startsWith('^'))
+    return QString();
+
+  // an alternative at the top level can start anywhere
+  int depth = 0;
+  for (int i = 0; i < re.length(); i++) {
+    QChar c = re[i];
+    if (c == '\\')
+      i++;
+    else if (c == '[') {
+      // skip the class, a ] right after [ or [^ is part of it
+      i++;
+      if (i < re.length() && re[i] == '^') i++;
+      if (i < re.length() && re[i] == ']') i++;
+      while (i < re.length() && re[i] != ']') {
+        if (re[i] == '\\') i++;
+        i++;
+      }
+    }
+    else if (c == '(')
+      depth++;
+    else if (c == ')')
+      depth--;
+    else if (c == '|' && depth == 0)
+      return QString();
+  }
+
+  static const QString special = "\\.[](){}*+?|^$";
+  QString prefix;
+  for (int i = 1; i < re.length(); i++) {
+    QChar c = re[i];
+    if (c == '\\' && i + 1 < re.length() && !re[i + 1].isLetterOrNumber())
+      c = re[++i];
+    else if (special.contains(c)) {
+      // a quantifier makes the previous character optional
+      if ((c == '*' || c == '?' || c == '{') && !prefix.isEmpty())
+        prefix.chop(1);
+      break;
+    }
+    prefix += c;
+  }
+
+  return prefix;
+}
+
+}
+
+Api::Api()
+: m_patterns_valid(false)
+, m_all_prefixed(false) {
   lua_State* l = lua_open();
   m_state = l;
 
@@ -207,6 +263,8 @@ Api::~Api() {
 }
 
 void Api::runFile(const char* file) {
+  m_patterns_valid = false;
+
   //luaL_dofile(m_state, file);
   if (QFile(file).exists()) {
     if(luaL_loadfile(m_state, file) == 0)
@@ -245,30 +303,68 @@ void Api::loadTest() {
 }
 #endif
 
-HLine* Api::highlight(const QString& text) {
-  // iterate through patterns
+void Api::compilePatterns() {
   StackCheck check(m_state);
+  m_patterns.clear();
+  m_first_chars.clear();
+  m_all_prefixed = true;
+
   lua_getglobal(m_state, "__patterns__");
   if (lua_istable(m_state, -1)) {
-    lua_pushnil(m_state);
-    while (lua_next(m_state, -2) != 0) {
-      int i = static_cast<int>(lua_tonumber(m_state, -2));
-      lua_pushstring(m_state, "pattern");
-      lua_gettable(m_state, -2);
-      QString pattern(lua_tostring(m_state, -1));
-      QRegExp re(pattern.replace("%", "\\"));
-      lua_pop(m_state, 2);
-
-      std::pair<bool, HLine*> res = runEvent(text, i, re);
-      if (res.first) {
-        lua_pop(m_state, 2);
-        return res.second;
+    const int n = lua_objlen(m_state, -1);
+    for (int i = 1; i <= n; i++) {
+      lua_rawgeti(m_state, -1, i);
+      if (lua_istable(m_state, -1)) {
+        lua_pushstring(m_state, "pattern");
+        lua_gettable(m_state, -2);
+        QString pattern(lua_tostring(m_state, -1));
+        lua_pop(m_state, 1);
+
+        Pattern p;
+        p.index = i;
+        p.regexp = QRegExp(pattern.replace("%", "\\"));
+        if (!p.regexp.isValid())
+          kDebug() << "invalid highlighting pattern" << pattern << ":" << p.regexp.errorString();
+        p.prefix = literal_prefix(pattern);
+        if (p.prefix.isEmpty())
+          m_all_prefixed = false;
+        else if (!m_first_chars.contains(p.prefix[0]))
+          m_first_chars += p.prefix[0];
+        m_patterns.push_back(p);
       }
-
+      lua_pop(m_state, 1);
     }
   }
-
   lua_pop(m_state, 1);
+
+  m_patterns_valid = true;
+}
+
+HLine* Api::highlight(const QString& text) {
+  // patterns added by handlers are picked up as well
+  if (m_patterns_valid) {
+    StackCheck check(m_state);
+    lua_getglobal(m_state, "__patterns__");
+    if (!lua_istable(m_state, -1) || (int)lua_objlen(m_state, -1) != (int)m_patterns.size())
+      m_patterns_valid = false;
+    lua_pop(m_state, 1);
+  }
+  if (!m_patterns_valid)
+    compilePatterns();
+
+  if (m_all_prefixed && (text.isEmpty() || !m_first_chars.contains(text[0])))
+    return new HLine(text, QTextCharFormat());
+
+  for (unsigned int i = 0; i < m_patterns.size(); i++) {
+    Pattern& p = m_patterns[i];
+    if (!p.prefix.isEmpty() && !text.startsWith(p.prefix))
+      continue;
+
+    std::pair<bool, HLine*> res = runEvent(text, p.index, p.regexp);
+    if (res.first)
+      return res.second;
+  }
+
   return new HLine(text, QTextCharFormat());
 }
 
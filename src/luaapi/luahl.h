@@ -12,6 +12,7 @@
 #define LUAHL_H
 
 #include <map>
+#include <vector>
 #include <QRegExp>
 
 class lua_State;
@@ -20,10 +21,34 @@ class HLine;
 namespace LuaApi {
 
 class Api {
+  /** a compiled entry of the __patterns__ table */
+  struct Pattern {
+    /** position in __patterns__ */
+    int index;
+    QRegExp regexp;
+    /** literal text every match starts with, for anchored patterns */
+    QString prefix;
+  };
+
   lua_State* m_state;
-  
+
+  /**
+    * Patterns compiled from the scripts, in order.
+    * Rebuilt when a script is run or the table changes size.
+    */
+  std::vector<Pattern> m_patterns;
+  bool m_patterns_valid;
+
+  /**
+    * When no pattern lacks a prefix, the characters prefixes can start with.
+    * Lines starting with anything else are not matched at all.
+    */
+  QString m_first_chars;
+  bool m_all_prefixed;
+
   void pcall(int nArgs, int nResults);
   void pushpair(int x, int y);
+  void compilePatterns();
   std::pair<bool, HLine*> runEvent(const QString& text, int eventIndex, QRegExp& pattern);
 public:
   Api();
@@ -9,38 +9,54 @@
 */
 
 #include "mainanimation.h"
+#include "framescheduler.h"
 
 using namespace boost;
 
 MainAnimation::MainAnimation(double speed)
 : AnimationGroup(true)
+, m_scheduler(FrameScheduler::instance())
 , m_translate(0)
 , m_speed(speed)
-, m_delay(20) {
+, m_delay(20)
+, m_last_frame(0) {
   m_active = true;
-  connect(&m_timer, SIGNAL(timeout()), this, SLOT(tick()));
+}
+
+MainAnimation::~MainAnimation() {
+  m_scheduler.detach(this);
 }
 
 void MainAnimation::addAnimation(const shared_ptr<Animation>& a) {
-  if (!m_timer.isActive()) {
-    m_timer.start(m_delay);
+  if (empty()) {
     m_time.restart();
+    m_last_frame = -m_delay;
   }
-  
+
+  // immediate animations are done at once; timed ones are started now
+  // and advanced at the next frames, together with the others
+  if (!a || a->animationAdvance(
+        static_cast<int>(m_time.elapsed() * m_speed) + m_translate) != Active)
+    return;
+
   AnimationGroup::addPostAnimation(a);
-  tick();
+  m_scheduler.attach(this);
 }
 
 void MainAnimation::stop() {
   AnimationGroup::stop();
 }
 
-void MainAnimation::tick() {
-  animationAdvance(static_cast<int>(m_time.elapsed() * m_speed) + m_translate);
-  if (empty()) {
-    // no more animations, stop the clock!
-    m_timer.stop();
-  }
+bool MainAnimation::frame(int interval) {
+  int elapsed = m_time.elapsed();
+
+  // with a delay longer than a frame, only step at the closest frame
+  if (elapsed - m_last_frame + interval / 2 < m_delay)
+    return !empty();
+
+  m_last_frame = elapsed;
+  animationAdvance(static_cast<int>(elapsed * m_speed) + m_translate);
+  return !empty();
 }
 
 void MainAnimation::setSpeed(double speed) {
@@ -50,7 +66,7 @@ void MainAnimation::setSpeed(double speed) {
 }
 
 void MainAnimation::setDelay(int delay) {
-  m_timer.setInterval(m_delay = delay);
+  m_delay = delay;
 }
 
 MainAnimation& MainAnimation::global() { 
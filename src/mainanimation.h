@@ -13,26 +13,40 @@
 
 #include <QObject>
 #include <QTime>
-#include <QTimer>
 #include "animation.h"
 #include <boost/shared_ptr.hpp>
 
+class FrameScheduler;
+
 /**
   * @a MainAnimation is a persistent animation used to activate
   * all chessboard animations.
+  * Animations are advanced by the @ref FrameScheduler, at most once
+  * per frame.
   */
 class MainAnimation : public QObject, protected AnimationGroup {
 Q_OBJECT
+  friend class FrameScheduler;
+
+  FrameScheduler& m_scheduler;
   QTime m_time;
-  QTimer m_timer;
   int    m_translate;
   double m_speed;
   int m_delay;
+  int m_last_frame;
+
+  /**
+    * Called by the scheduler once per frame, @a interval milliseconds long.
+    * \return Whether there are still animations running.
+    */
+  bool frame(int interval);
 public:
   MainAnimation(double speed = 1.0);
+  ~MainAnimation();
 
   /**
-    * Activate the animation @a a.
+    * Activate the animation @a a. Animations which do not take any
+    * time are run immediately, the others from the next frame on.
     */
   void addAnimation(const boost::shared_ptr<Animation>& a);
 
@@ -48,7 +62,8 @@ public:
   void setSpeed(double speed);
 
   /**
-    * Sets the frame delay.
+    * Sets the minimum delay between two steps of the animations.
+    * Delays shorter than a frame are rounded up to it.
     */
   void setDelay(int delay);
 
@@ -56,8 +71,6 @@ public:
     * Return a global MasterAnimation, i.e. not tied to a particular board.
     */
   static MainAnimation& global();
-protected Q_SLOTS:
-  void tick();
 };
 
 #endif // MAINANIMATION_H
@@ -28,6 +28,7 @@
 #include <KMessageBox>
 #include <KMenuBar>
 #include <KStandardAction>
+#include <KStandardDirs>
 #include <KTemporaryFile>
 
 #include "actioncollection.h"
@@ -47,6 +48,7 @@
 #include "flash.h"
 #include "foreach.h"
 #include "pgnparser.h"
+#include "pgndatabase.h"
 #include "pref_highlight.h"
 #include "pref_preferences.h"
 #include "tabwidget.h"
@@ -426,19 +428,17 @@ bool MainWindow::openFile(const QString& filename) {
      return false;
   }
 
-  QFile file(filename);
+  // the game index is kept in the cache, keyed by the file path
+  QString index = KStandardDirs::locateLocal("cache", "pgnindex/" +
+    QString::number(qHash(info.absoluteFilePath()), 16));
+  PGNDatabase database(filename, index);
 
-  if(!file.open(QIODevice::ReadOnly)) {
+  if(!database.open()) {
      KMessageBox::sorry(this, i18n("You do not have read permission to this file."), i18n("Error"));
      return false;
   }
 
-  QTextStream stream(&file);
-  QTextCodec *codec;
-  codec = QTextCodec::codecForLocale();
-  stream.setCodec(codec);
-
-  setupPGN(stream.readAll());
+  setupPGN(database.size() > 0 ? database.text(0) : QString());
   //ui().pgnPaste(stream.readAll());
   return true;
 }
@@ -526,7 +526,7 @@ void MainWindow::createConnection(const QString& username, const QString& passwo
   connect(m_connection.get(), SIGNAL(hostLookup()), this, SLOT(onHostLookup()));
   connect(m_connection.get(), SIGNAL(hostFound()), this, SLOT(onHostFound()));
 
-  connect(m_connection.get(), SIGNAL(receivedLine(QString, int)), console, SLOT(displayText(QString, int)));
+  connect(m_connection.get(), SIGNAL(receivedLines(QStringList, int)), console, SLOT(displayLines(QStringList, int)));
   connect(m_connection.get(), SIGNAL(receivedText(QString, int)), console, SLOT(displayText(QString, int)));
 
   connect(console, SIGNAL(receivedInput(const QString&)), m_connection.get(), SLOT(sendText(const QString&)));
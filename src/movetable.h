@@ -0,0 +1,135 @@
+/*
+  Copyright (c) 2006 Paolo Capriotti <p.capriotti@gmail.com>
+            (c) 2006 Maurizio Monge <maurizio.monge@kdemail.net>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#ifndef MOVETABLE_H
+#define MOVETABLE_H
+
+#include <map>
+#include <vector>
+#include <QtGlobal>
+#include "fwd.h"
+#include "point.h"
+
+/**
+  * @class MoveTable <movetable.h>
+  * @brief Legal targets of the displayed position, grouped by source.
+  *
+  * A source is either a square, a piece in a pool, or no square at all
+  * for one-click moves. The board fills the table from the move list of
+  * the position as soon as the position changes, so that drag feedback
+  * and hints, which are queried on every mouse move, are lookups.
+  * When the variant cannot list its moves, the targets of each source
+  * are filled the first time they are needed instead.
+  * The table is bound to the hash of a position.
+  */
+class MoveTable {
+public:
+  /**
+    * A source: the pool index (-1 for moves on the board) and
+    * the square or piece index (-1 for one-click moves).
+    */
+  typedef std::pair<int, int> Source;
+private:
+  typedef std::map<Source, std::vector<bool> > Targets;
+
+  quint64 m_key;
+  bool m_bound;
+  bool m_complete;
+  Point m_size;
+  Targets m_targets;
+  std::vector<PiecePtr> m_hints;
+
+  int index(const Point& p) const { return p.x + p.y * m_size.x; }
+  bool valid(const Point& p) const {
+    return p.x >= 0 && p.x < m_size.x && p.y >= 0 && p.y < m_size.y;
+  }
+public:
+  MoveTable()
+  : m_key(0)
+  , m_bound(false)
+  , m_complete(false) { }
+
+  /** the source for a move starting at @a from, or a one-click move if @a from is invalid */
+  Source source(const Point& from) const {
+    return Source(-1, from == Point::invalid() ? -1 : index(from));
+  }
+
+  /** the source for a drop of the piece @a index of @a pool */
+  static Source dropSource(int pool, int index) { return Source(pool, index); }
+
+  /** returns true if the table describes the position with hash @a key on a board of size @a size */
+  bool bound(quint64 key, const Point& size) const {
+    return m_bound && m_key == key && m_size == size;
+  }
+
+  /** empties the table, and binds it to the position with hash @a key on a board of size @a size */
+  void bind(quint64 key, const Point& size) {
+    clear();
+    m_key = key;
+    m_size = size;
+    m_bound = true;
+  }
+
+  /** forgets all targets */
+  void clear() {
+    m_targets.clear();
+    m_hints.clear();
+    m_bound = false;
+    m_complete = false;
+  }
+
+  /** marks every source as filled, the ones never added having no targets */
+  void setComplete() { m_complete = true; }
+
+  /** returns true if the targets of @a source have been filled */
+  bool contains(const Source& source) const {
+    return m_complete || m_targets.find(source) != m_targets.end();
+  }
+
+  /** starts filling the targets of @a source, all of them initially illegal */
+  void addSource(const Source& source) {
+    m_targets[source].assign(m_size.x * m_size.y, false);
+  }
+
+  void setLegal(const Source& source, const Point& to) {
+    if (!valid(to))
+      return;
+    std::vector<bool>& targets = m_targets[source];
+    if (targets.empty())
+      targets.assign(m_size.x * m_size.y, false);
+    targets[index(to)] = true;
+  }
+
+  /** returns true if @a to is a legal target of @a source, which must have been filled */
+  bool legal(const Source& source, const Point& to) const {
+    Targets::const_iterator it = m_targets.find(source);
+    if (it == m_targets.end() || !valid(to))
+      return false;
+    return it->second[index(to)];
+  }
+
+  /** sets the piece shown as a hint for the one-click move to @a to */
+  void setHint(const Point& to, const PiecePtr& hint) {
+    if (!valid(to))
+      return;
+    if (m_hints.empty())
+      m_hints.resize(m_size.x * m_size.y);
+    m_hints[index(to)] = hint;
+  }
+
+  /** returns the hint for the one-click move to @a to, or a null pointer */
+  PiecePtr hint(const Point& to) const {
+    if (m_hints.empty() || !valid(to))
+      return PiecePtr();
+    return m_hints[index(to)];
+  }
+};
+
+#endif // MOVETABLE_H
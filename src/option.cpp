@@ -313,6 +313,111 @@ void dump_options_list(const OptList& options, int indent) {
   if(!indent)kDebug() << "---- end dump ----";
 }
 
+QString options_list_to_string(const OptList& options) {
+  QString retv;
+  for(int i=0;i<options.size();i++) {
+    OptPtr _o = options[i];
+    retv += _o->name() + '=';
+    if(BoolOptPtr o =
+            boost::dynamic_pointer_cast<BoolOpt,BaseOpt>(_o)) {
+      retv += QString(o->value() ? "1" : "0");
+      if(o->subOptions().size())
+        retv += '{' + options_list_to_string(o->subOptions()) + '}';
+    }
+    else if(IntOptPtr o =
+            boost::dynamic_pointer_cast<IntOpt,BaseOpt>(_o))
+      retv += QString::number(o->value());
+    else if(StringOptPtr o =
+            boost::dynamic_pointer_cast<StringOpt,BaseOpt>(_o))
+      retv += '"' + o->value() + '"';
+    else if(UrlOptPtr o =
+            boost::dynamic_pointer_cast<UrlOpt,BaseOpt>(_o))
+      retv += '"' + o->value() + '"';
+    else if(ColorOptPtr o =
+            boost::dynamic_pointer_cast<ColorOpt,BaseOpt>(_o))
+      retv += QString::number(o->value().rgba(), 16);
+    else if(FontOptPtr o =
+            boost::dynamic_pointer_cast<FontOpt,BaseOpt>(_o))
+      retv += '"' + o->value().toString() + '"';
+    else if(ComboOptPtr o =
+            boost::dynamic_pointer_cast<ComboOpt,BaseOpt>(_o))
+      retv += QString::number(o->selected());
+    else if(SelectOptPtr o =
+            boost::dynamic_pointer_cast<SelectOpt,BaseOpt>(_o)) {
+      OptList l;
+      for(int j=0;j<o->options().size();j++)
+        l << o->options()[j];
+      retv += QString::number(o->selected()) + '{' + options_list_to_string(l) + '}';
+    }
+    else
+      kError() << "option of type" << prettyTypeName(typeid(*_o).name());
+    retv += ';';
+  }
+  return retv;
+}
+
+void options_list_set_values(OptList& options, const OptList& values) {
+  for(int i=0;i<options.size();i++) {
+    OptPtr _o = options[i];
+    OptPtr _v = options_list_find<BaseOpt>(values, _o->name());
+    if(!_v)
+      continue;
+
+    if(BoolOptPtr o =
+            boost::dynamic_pointer_cast<BoolOpt,BaseOpt>(_o)) {
+      if(BoolOptPtr v = boost::dynamic_pointer_cast<BoolOpt,BaseOpt>(_v)) {
+        OptList sub = o->subOptions();
+        options_list_set_values(sub, v->subOptions());
+        o->setValue(v->value());
+      }
+    }
+    else if(IntOptPtr o =
+            boost::dynamic_pointer_cast<IntOpt,BaseOpt>(_o)) {
+      if(IntOptPtr v = boost::dynamic_pointer_cast<IntOpt,BaseOpt>(_v))
+        o->setValue(v->value());
+    }
+    else if(StringOptPtr o =
+            boost::dynamic_pointer_cast<StringOpt,BaseOpt>(_o)) {
+      if(StringOptPtr v = boost::dynamic_pointer_cast<StringOpt,BaseOpt>(_v))
+        o->setValue(v->value());
+    }
+    else if(UrlOptPtr o =
+            boost::dynamic_pointer_cast<UrlOpt,BaseOpt>(_o)) {
+      if(UrlOptPtr v = boost::dynamic_pointer_cast<UrlOpt,BaseOpt>(_v))
+        o->setValue(v->value());
+    }
+    else if(ColorOptPtr o =
+            boost::dynamic_pointer_cast<ColorOpt,BaseOpt>(_o)) {
+      if(ColorOptPtr v = boost::dynamic_pointer_cast<ColorOpt,BaseOpt>(_v))
+        o->setValue(v->value());
+    }
+    else if(FontOptPtr o =
+            boost::dynamic_pointer_cast<FontOpt,BaseOpt>(_o)) {
+      if(FontOptPtr v = boost::dynamic_pointer_cast<FontOpt,BaseOpt>(_v))
+        o->setValue(v->value());
+    }
+    else if(ComboOptPtr o =
+            boost::dynamic_pointer_cast<ComboOpt,BaseOpt>(_o)) {
+      if(ComboOptPtr v = boost::dynamic_pointer_cast<ComboOpt,BaseOpt>(_v))
+        o->setSelected(v->selected());
+    }
+    else if(SelectOptPtr o =
+            boost::dynamic_pointer_cast<SelectOpt,BaseOpt>(_o)) {
+      if(SelectOptPtr v = boost::dynamic_pointer_cast<SelectOpt,BaseOpt>(_v)) {
+        OptList l, vl;
+        for(int j=0;j<o->options().size();j++)
+          l << o->options()[j];
+        for(int j=0;j<v->options().size();j++)
+          vl << v->options()[j];
+        options_list_set_values(l, vl);
+        o->setSelected(v->selected());
+      }
+    }
+    else
+      kError() << "option of type" << prettyTypeName(typeid(*_o).name());
+  }
+}
+
 bool options_list_load_from_settings(OptList& options, const Settings& s) {
   bool retv = false;
   for(int i=0;i<options.size();i++) {
@@ -318,6 +318,12 @@ typename O::ValueType options_list_find(const OptList& o, const QString& name,
 bool options_list_load_from_settings(OptList&, const Settings& s);
 void options_list_save_to_settings(const OptList&, Settings s);
 
+/** \return a string with the names and values of all options, equal for equal lists */
+QString options_list_to_string(const OptList& options);
+
+/** copy the values of the options in @a values into the options with the same names */
+void options_list_set_values(OptList& options, const OptList& values);
+
 
 class OptionWidget : public QWidget {
   Q_OBJECT
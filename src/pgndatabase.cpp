@@ -0,0 +1,334 @@
+/*
+  Copyright (c) 2006 Paolo Capriotti <p.capriotti@gmail.com>
+            (c) 2006 Maurizio Monge <maurizio.monge@kdemail.net>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#include "pgndatabase.h"
+#include <cstring>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QTextCodec>
+#include <KDebug>
+#include "pgnparser.h"
+
+namespace {
+
+const quint32 INDEX_MAGIC = 0x54504749; // "TPGI"
+const quint32 INDEX_VERSION = 1;
+
+inline bool isSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+inline const char* skipSpaces(const char* p, const char* end) {
+  while (p < end && isSpace(*p))
+    ++p;
+  return p;
+}
+
+inline bool equals(const char* begin, const char* end, const char* str) {
+  int len = strlen(str);
+  return end - begin == len && strncmp(begin, str, len) == 0;
+}
+
+inline bool isResult(const char* begin, const char* end) {
+  return equals(begin, end, "*") ||
+         equals(begin, end, "1-0") ||
+         equals(begin, end, "0-1") ||
+         equals(begin, end, "1/2-1/2");
+}
+
+}
+
+PGNDatabase::PGNDatabase(const QString& filename, const QString& index_filename)
+: m_filename(filename)
+, m_index_filename(index_filename)
+, m_file(filename)
+, m_data(0)
+, m_size(0)
+, m_codec(QTextCodec::codecForLocale()) { }
+
+PGNDatabase::~PGNDatabase() {
+  close();
+}
+
+bool PGNDatabase::open() {
+  close();
+
+  if (!m_file.open(QIODevice::ReadOnly))
+    return false;
+
+  m_size = m_file.size();
+  if (m_size > 0) {
+    m_data = reinterpret_cast<const char*>(m_file.map(0, m_size));
+    if (!m_data) {
+      // mapping is not supported everywhere, read the file instead
+      m_buffer = m_file.readAll();
+      m_data = m_buffer.constData();
+      m_size = m_buffer.size();
+    }
+  }
+
+  if (!loadIndex()) {
+    scan();
+    if (!m_index_filename.isEmpty() && !saveIndex())
+      kDebug() << "could not write PGN index" << m_index_filename;
+  }
+
+  return true;
+}
+
+void PGNDatabase::close() {
+  if (m_file.isOpen()) {
+    if (m_buffer.isNull() && m_data)
+      m_file.unmap(reinterpret_cast<uchar*>(const_cast<char*>(m_data)));
+    m_file.close();
+  }
+
+  m_buffer = QByteArray();
+  m_data = 0;
+  m_size = 0;
+  m_entries.clear();
+}
+
+QString PGNDatabase::decode(const char* begin, const char* end) const {
+  return m_codec->toUnicode(begin, end - begin);
+}
+
+void PGNDatabase::readTag(const char* begin, const char* end, Entry& entry) const {
+  // [Name "value"]
+  const char* name = begin + 1;
+  const char* name_end = name;
+  while (name_end < end && !isSpace(*name_end) && *name_end != '"')
+    ++name_end;
+
+  QString* field = 0;
+  if (equals(name, name_end, "White"))
+    field = &entry.white;
+  else if (equals(name, name_end, "Black"))
+    field = &entry.black;
+  else if (equals(name, name_end, "Event"))
+    field = &entry.event;
+  else if (equals(name, name_end, "Date"))
+    field = &entry.date;
+  else if (equals(name, name_end, "Result"))
+    field = &entry.result;
+  else if (equals(name, name_end, "ECO"))
+    field = &entry.eco;
+  if (!field)
+    return;
+
+  const char* value = static_cast<const char*>(memchr(name_end, '"', end - name_end));
+  if (!value)
+    return;
+  ++value;
+
+  QByteArray unescaped;
+  const char* p = value;
+  while (p < end && *p != '"') {
+    if (*p == '\\' && p + 1 < end) {
+      unescaped.append(value, p - value);
+      value = ++p;
+    }
+    ++p;
+  }
+
+  if (unescaped.isEmpty())
+    *field = decode(value, p);
+  else {
+    unescaped.append(value, p - value);
+    *field = m_codec->toUnicode(unescaped);
+  }
+}
+
+void PGNDatabase::scan() {
+  m_entries.clear();
+
+  const char* begin = m_data;
+  const char* end = m_data + m_size;
+  if (m_size >= 3 && strncmp(begin, "\xef\xbb\xbf", 3) == 0)
+    begin += 3;
+
+  enum {
+    Between,
+    Tags,
+    Moves
+  } state = Between;
+  bool in_comment = false;
+  Entry entry;
+
+#define START_GAME(p) entry = Entry(); entry.offset = (p) - m_data;
+#define END_GAME(p) entry.length = (p) - m_data - entry.offset; m_entries.push_back(entry);
+
+  for (const char* line = begin; line < end; ) {
+    const char* eol = static_cast<const char*>(memchr(line, '\n', end - line));
+    const char* line_end = eol ? eol : end;
+    const char* next = eol ? eol + 1 : end;
+    const char* p = line;
+
+    if (in_comment) {
+      p = static_cast<const char*>(memchr(line, '}', line_end - line));
+      if (!p) {
+        line = next;
+        continue;
+      }
+      in_comment = false;
+      ++p;
+    }
+    else {
+      // escape mechanism
+      if (*line == '%') {
+        line = next;
+        continue;
+      }
+
+      // tag pair: a game starts at the first one
+      p = skipSpaces(line, line_end);
+      if (p < line_end && *p == '[') {
+        if (state == Moves) {
+          END_GAME(line);
+        }
+        if (state != Tags) {
+          START_GAME(line);
+        }
+        state = Tags;
+
+        readTag(p, line_end, entry);
+        line = next;
+        continue;
+      }
+    }
+
+    // movetext: only comments and results matter here
+    while ((p = skipSpaces(p, line_end)) < line_end) {
+      if (state == Between) {
+        // a game without tags
+        START_GAME(p);
+      }
+      state = Moves;
+
+      if (*p == '{') {
+        const char* close = static_cast<const char*>(memchr(p + 1, '}', line_end - p - 1));
+        if (!close) {
+          in_comment = true;
+          break;
+        }
+        p = close + 1;
+        continue;
+      }
+      if (*p == ';')
+        break;
+
+      const char* token = p;
+      while (p < line_end && !isSpace(*p) &&
+             *p != '{' && *p != ';' && *p != '(' && *p != ')')
+        ++p;
+      if (p == token) {
+        // variation delimiter
+        ++p;
+        continue;
+      }
+
+      if (isResult(token, p)) {
+        if (entry.result.isEmpty())
+          entry.result = decode(token, p);
+        END_GAME(p);
+        state = Between;
+      }
+    }
+
+    line = next;
+  }
+
+  if (state != Between) {
+    END_GAME(end);
+  }
+
+#undef START_GAME
+#undef END_GAME
+}
+
+bool PGNDatabase::loadIndex() {
+  if (m_index_filename.isEmpty())
+    return false;
+
+  QFile file(m_index_filename);
+  if (!file.open(QIODevice::ReadOnly))
+    return false;
+
+  QDataStream stream(&file);
+  quint32 magic, version;
+  stream >> magic >> version;
+  if (magic != INDEX_MAGIC || version != INDEX_VERSION)
+    return false;
+
+  // the index is only valid for the very same file
+  QFileInfo info(m_filename);
+  QString filename;
+  qint64 size;
+  QDateTime modified;
+  stream >> filename >> size >> modified;
+  if (filename != info.absoluteFilePath() ||
+      size != m_size ||
+      modified != info.lastModified())
+    return false;
+
+  // a damaged index must not make us allocate more entries than the file
+  // can hold: each takes at least two offsets and six string lengths
+  quint32 count;
+  stream >> count;
+  const qint64 min_entry_size = 2 * sizeof(qint64) + 6 * sizeof(quint32);
+  if (stream.status() != QDataStream::Ok ||
+      count > (file.size() - file.pos()) / min_entry_size)
+    return false;
+
+  std::vector<Entry> entries(count);
+  for (quint32 i = 0; i < count; i++) {
+    Entry& e = entries[i];
+    stream >> e.offset >> e.length
+           >> e.white >> e.black >> e.event
+           >> e.date >> e.result >> e.eco;
+    if (e.offset < 0 || e.length < 0 || e.offset + e.length > m_size)
+      return false;
+  }
+  if (stream.status() != QDataStream::Ok)
+    return false;
+
+  m_entries.swap(entries);
+  return true;
+}
+
+bool PGNDatabase::saveIndex() const {
+  QFile file(m_index_filename);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    return false;
+
+  QFileInfo info(m_filename);
+  QDataStream stream(&file);
+  stream << INDEX_MAGIC << INDEX_VERSION
+         << info.absoluteFilePath() << m_size << info.lastModified()
+         << static_cast<quint32>(m_entries.size());
+  for (unsigned int i = 0; i < m_entries.size(); i++) {
+    const Entry& e = m_entries[i];
+    stream << e.offset << e.length
+           << e.white << e.black << e.event
+           << e.date << e.result << e.eco;
+  }
+
+  return stream.status() == QDataStream::Ok;
+}
+
+QString PGNDatabase::text(int index) const {
+  const Entry& e = m_entries[index];
+  return decode(m_data + e.offset, m_data + e.offset + e.length);
+}
+
+boost::shared_ptr<PGN> PGNDatabase::game(int index) const {
+  return boost::shared_ptr<PGN>(new PGN(text(index)));
+}
@@ -0,0 +1,101 @@
+/*
+  Copyright (c) 2006 Paolo Capriotti <p.capriotti@gmail.com>
+            (c) 2006 Maurizio Monge <maurizio.monge@kdemail.net>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#ifndef PGNDATABASE_H
+#define PGNDATABASE_H
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <QFile>
+#include <QString>
+#include "export.h"
+
+class PGN;
+class QTextCodec;
+
+/**
+  * @class PGNDatabase <pgndatabase.h>
+  * @brief A file containing any number of PGN games.
+  *
+  * The file is memory mapped and scanned once to find where each
+  * game starts, collecting the tags needed to list games along the way.
+  * The result can be stored in a side index, which is reused as long as
+  * the PGN file is unchanged, so that even huge archives open instantly.
+  * Games are only decoded and parsed when they are requested.
+  */
+class TAGUA_EXPORT PGNDatabase {
+public:
+  /**
+    * Position and summary of a game in the file.
+    */
+  struct Entry {
+    qint64 offset;
+    qint64 length;
+    QString white;
+    QString black;
+    QString event;
+    QString date;
+    QString result;
+    QString eco;
+
+    Entry() : offset(0), length(0) { }
+  };
+private:
+  QString m_filename;
+  QString m_index_filename;
+  QFile m_file;
+  const char* m_data;
+  qint64 m_size;
+  QByteArray m_buffer;
+  QTextCodec* m_codec;
+  std::vector<Entry> m_entries;
+
+  QString decode(const char* begin, const char* end) const;
+  void readTag(const char* begin, const char* end, Entry& entry) const;
+  void scan();
+  bool loadIndex();
+  bool saveIndex() const;
+public:
+  /**
+    * Create a database for a PGN file.
+    * @param filename The PGN file.
+    * @param index_filename Where to store the side index.
+    *                       If empty, the index is only kept in memory.
+    */
+  explicit PGNDatabase(const QString& filename,
+                       const QString& index_filename = QString());
+  ~PGNDatabase();
+
+  /**
+    * Map the file and build the game index, or load it from the
+    * side index if that is up to date.
+    * @return Whether the file could be read.
+    */
+  bool open();
+
+  /**
+    * Unmap the file and forget the game index.
+    */
+  void close();
+
+  /** the number of games in the file */
+  int size() const { return m_entries.size(); }
+
+  /** the position and tags of the game @a index */
+  const Entry& entry(int index) const { return m_entries[index]; }
+
+  /** the source of the game @a index */
+  QString text(int index) const;
+
+  /** the game @a index, parsed */
+  boost::shared_ptr<PGN> game(int index) const;
+};
+
+#endif // PGNDATABASE_H
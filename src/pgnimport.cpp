@@ -0,0 +1,145 @@
+/*
+  Copyright (c) 2006 Paolo Capriotti <p.capriotti@gmail.com>
+            (c) 2006 Maurizio Monge <maurizio.monge@kdemail.net>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#include "pgnimport.h"
+#include <map>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include "game.h"
+#include "pgndatabase.h"
+#include "pgnparser.h"
+#include "tagua.h"
+#include "variants.h"
+
+namespace {
+
+// games are handed out to workers in chunks of this size
+const int CHUNK_SIZE = 16;
+
+// kept games only store a position every so many plies
+const int CHECKPOINT_INTERVAL = 16;
+
+typedef std::map<QString, VariantPtr> VariantCache;
+
+void importGame(const QString& text, VariantCache& variants,
+                bool keep_game, PGNImport::Result& result) {
+  PGN pgn(text);
+  if (!pgn.valid()) {
+    result.status = PGNImport::ParseError;
+    return;
+  }
+
+  std::map<QString, QString>::const_iterator var = pgn.m_tags.find("Variant");
+  QString name = var == pgn.m_tags.end() ? QString("chess") : var->second;
+  VariantPtr& variant = variants[name];
+  if (!variant)
+    variant = Variants::instance().get(name);
+  if (!variant) {
+    result.status = PGNImport::UnknownVariant;
+    return;
+  }
+
+  PositionPtr pos = variant->createPosition();
+  pos->setup();
+
+  // replay the main line in place
+  result.status = PGNImport::Imported;
+  int depth = 0;
+  for (uint i = 0; i < pgn.size(); i++) {
+    if (boost::get<PGN::BeginVariation>(pgn[i]))
+      depth++;
+    else if (boost::get<PGN::EndVariation>(pgn[i]))
+      depth--;
+    else if (depth == 0) {
+      if (const PGN::Move* pm = boost::get<PGN::Move>(pgn[i])) {
+        MovePtr m = pos->getMove(pm->m_move);
+        if (!m || !pos->testMove(m)) {
+          result.status = PGNImport::IllegalMove;
+          break;
+        }
+        pos->move(m);
+        result.plies++;
+      }
+    }
+  }
+
+  if (keep_game) {
+    PositionPtr start = variant->createPosition();
+    start->setup();
+
+    result.game = boost::shared_ptr<Game>(new Game);
+    result.game->setCheckpointInterval(CHECKPOINT_INTERVAL);
+    result.game->load(start, pgn);
+  }
+}
+
+}
+
+class PGNImport::Worker : public QRunnable {
+  PGNImport& m_import;
+public:
+  Worker(PGNImport& import)
+  : m_import(import) { }
+
+  virtual void run() { m_import.work(); }
+};
+
+PGNImport::PGNImport(const PGNDatabase& database, bool keep_games)
+: m_database(database)
+, m_keep_games(keep_games) { }
+
+void PGNImport::work() {
+  // variant objects are not shared among workers
+  VariantCache variants;
+
+  const int size = m_games.size();
+  int begin;
+  while ((begin = m_next.fetchAndAddOrdered(CHUNK_SIZE)) < size) {
+    int end = qMin(begin + CHUNK_SIZE, size);
+    for (int i = begin; i < end; i++)
+      importGame(m_database.text(m_games[i]), variants, m_keep_games, m_results[i]);
+  }
+}
+
+void PGNImport::run(const std::vector<int>& games, int threads) {
+  m_games = games;
+  m_results.assign(games.size(), Result());
+  m_next = 0;
+
+  // make sure the variant registry is created before any worker starts
+  Variants::instance();
+
+  if (threads <= 0)
+    threads = QThread::idealThreadCount();
+  threads = qMax(1, qMin(threads, (int(games.size()) + CHUNK_SIZE - 1) / CHUNK_SIZE));
+
+  QThreadPool pool;
+  pool.setMaxThreadCount(threads);
+  for (int i = 0; i < threads; i++)
+    pool.start(new Worker(*this));
+  pool.waitForDone();
+}
+
+void PGNImport::run(int threads) {
+  std::vector<int> games(m_database.size());
+  for (int i = 0; i < m_database.size(); i++)
+    games[i] = i;
+  run(games, threads);
+}
+
+int PGNImport::count(Status status) const {
+  int res = 0;
+  for (unsigned int i = 0; i < m_results.size(); i++) {
+    if (m_results[i].status == status)
+      res++;
+  }
+  return res;
+}
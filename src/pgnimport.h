@@ -0,0 +1,89 @@
+/*
+  Copyright (c) 2006 Paolo Capriotti <p.capriotti@gmail.com>
+            (c) 2006 Maurizio Monge <maurizio.monge@kdemail.net>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#ifndef PGNIMPORT_H
+#define PGNIMPORT_H
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <QAtomicInt>
+#include "export.h"
+
+class Game;
+class PGNDatabase;
+
+/**
+  * @class PGNImport <pgnimport.h>
+  * @brief Replays many games of a PGN database in parallel.
+  *
+  * Games are handed out to a pool of worker threads in small chunks.
+  * Each worker parses the games it gets, and replays their main line
+  * with variant and position objects of its own, reporting whether
+  * all moves are legal. Full game histories can be kept as well.
+  */
+class TAGUA_EXPORT PGNImport {
+public:
+  enum Status {
+    NotImported,
+    Imported,
+    ParseError,
+    UnknownVariant,
+    IllegalMove
+  };
+
+  struct Result {
+    Status status;
+
+    /** the number of main line moves that could be replayed */
+    int plies;
+
+    /** the replayed game, only if games are kept */
+    boost::shared_ptr<Game> game;
+
+    Result() : status(NotImported), plies(0) { }
+  };
+private:
+  class Worker;
+  friend class Worker;
+
+  const PGNDatabase& m_database;
+  bool m_keep_games;
+  std::vector<int> m_games;
+  std::vector<Result> m_results;
+  QAtomicInt m_next;
+
+  void work();
+public:
+  /**
+    * @param database An open database.
+    * @param keep_games Whether to keep the history of each game.
+    */
+  explicit PGNImport(const PGNDatabase& database, bool keep_games = false);
+
+  /**
+    * Import the games with the given indices in the database,
+    * blocking until all of them are done.
+    * @param threads The number of worker threads, 0 for one per core.
+    */
+  void run(const std::vector<int>& games, int threads = 0);
+
+  /**
+    * Import all games in the database.
+    */
+  void run(int threads = 0);
+
+  /** results, in the same order as the imported games */
+  const std::vector<Result>& results() const { return m_results; }
+
+  /** the number of games with status @a status */
+  int count(Status status) const;
+};
+
+#endif // PGNIMPORT_H
@@ -9,105 +9,326 @@
 */
 
 #include "pgnparser.h"
-#include <QRegExp>
+#include <cstring>
+#include <QByteArray>
 #include <KDebug>
 
-QRegExp PGN::number("^(\\d+)(?:(?:\\.\\s+)?(\\.\\.\\.)|\\.?)?");
-QRegExp PGN::begin_var("^\\(");
-QRegExp PGN::end_var("^\\)");
-QRegExp PGN::comment("^\\{[^}]*\\}");
-QRegExp PGN::comment2("^;[^\\n]*\\n");
-QRegExp PGN::wsPattern("^\\s+");
-QRegExp PGN::tag("^\\[(\\S+)\\s+\"((?:[^\"]|\\\\\")*)\"\\]");
-QRegExp PGN::move_tag("^\\$(\\d+)");
-QRegExp PGN::move("^[^$\\{\\(\\[\\s][^\\{\\(\\)\\[\\s]*");
-QRegExp PGN::result("^(?:\\*|1-0|0-1|1/2-1/2)");
-QRegExp PGN::time("^\\([\\d:.]*\\)");
-QRegExp PGN::eol("(?:[ \t]\r?\n\r?|\r?\n\r?[ \t]|\r?\n\r?)");
-
-bool PGN::tryRegExp(QRegExp& re, const QString& str, int& offset) {
-  if (re.indexIn(str, offset, QRegExp::CaretAtOffset) != -1) {
-    offset += re.matchedLength();
-    return true;
-  }
-  else return false;
+namespace {
+
+/**
+  * A token of PGN source. Tokens do not own any text, they
+  * point into the source they have been read from.
+  */
+struct Token {
+  enum Type {
+    End,
+    Error,
+    Tag,
+    Comment,
+    BeginVariation,
+    EndVariation,
+    Number,
+    Move,
+    Result
+  };
+
+  Type type;
+
+  /** the text: comment contents, tag value, move or result */
+  const char* begin;
+  const char* end;
+
+  /** the name of a tag */
+  const char* name_begin;
+  const char* name_end;
+
+  /** the half move number of a number token */
+  int number;
+
+  Token(Type type, const char* begin = 0, const char* end = 0)
+  : type(type), begin(begin), end(end)
+  , name_begin(0), name_end(0), number(0) { }
+};
+
+inline bool isSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
 }
 
-#define IGNORE(re) if (tryRegExp((re), pgn, offset)) continue;
-bool PGN::parse(const QString& pgn) {
-  int offset = 0;
+inline bool isDigit(char c) {
+  return c >= '0' && c <= '9';
+}
 
-  while (offset < pgn.length()) {
-    IGNORE(wsPattern);
+inline bool startsWith(const char* p, const char* end, const char* str) {
+  int len = strlen(str);
+  return end - p >= len && strncmp(p, str, len) == 0;
+}
 
-    // read result
-    if (result.indexIn(pgn, offset, QRegExp::CaretAtOffset) != -1) {
-      QString res = pgn.mid(offset, result.matchedLength());
-      offset += result.matchedLength();
-      return true;
-    }
+/**
+  * Single pass PGN tokenizer on UTF-8 text.
+  * Whitespace, rest of line comments, NAGs and time annotations
+  * are skipped.
+  */
+class Lexer {
+  const char* m_pos;
+  const char* m_end;
 
-    IGNORE(comment2);
-    IGNORE(time);
+  void skipSpaces() {
+    while (m_pos < m_end && isSpace(*m_pos))
+      ++m_pos;
+  }
 
-    // read comment
-    if (tag.indexIn(pgn, offset, QRegExp::CaretAtOffset) != -1) {
-      m_tags[tag.cap(1)] = tag.cap(2);
-      offset += tag.matchedLength();
-      continue;
-    }
+  Token readTag();
+  Token readNumber();
+  Token readMove();
+  bool skipTime();
+public:
+  Lexer(const char* begin, const char* end)
+  : m_pos(begin), m_end(end) { }
 
-    // read comment
-    if (comment.indexIn(pgn, offset, QRegExp::CaretAtOffset) != -1) {
-      m_entries.push_back(pgn.mid(offset + 1, comment.matchedLength() - 2).replace(eol, " "));
-      offset += comment.matchedLength();
-      continue;
-    }
+  Token next();
 
-    // read var, 1
-    if (begin_var.indexIn(pgn, offset, QRegExp::CaretAtOffset) != -1) {
-      m_entries.push_back(BeginVariation());
-      offset += begin_var.matchedLength();
+  const char* position() const { return m_pos; }
+};
+
+Token Lexer::next() {
+  for (;;) {
+    skipSpaces();
+    if (m_pos == m_end)
+      return Token(Token::End, m_pos, m_pos);
+
+    const char* start = m_pos;
+    switch (*m_pos) {
+    case ';': {
+      // comment to the end of the line
+      const char* eol = static_cast<const char*>(memchr(m_pos, '\n', m_end - m_pos));
+      m_pos = eol ? eol + 1 : m_end;
       continue;
     }
-
-    // read var, 2
-    if (end_var.indexIn(pgn, offset, QRegExp::CaretAtOffset) != -1) {
-      m_entries.push_back(EndVariation());
-      offset += end_var.matchedLength();
+    case '$':
+      // numeric annotation glyph
+      ++m_pos;
+      while (m_pos < m_end && isDigit(*m_pos))
+        ++m_pos;
       continue;
+    case '{': {
+      const char* close = static_cast<const char*>(memchr(m_pos, '}', m_end - m_pos));
+      if (!close)
+        return Token(Token::Error, start, m_end);
+      m_pos = close + 1;
+      return Token(Token::Comment, start + 1, close);
+    }
+    case '[':
+      return readTag();
+    case '(':
+      if (skipTime())
+        continue;
+      ++m_pos;
+      return Token(Token::BeginVariation, start, m_pos);
+    case ')':
+      ++m_pos;
+      return Token(Token::EndVariation, start, m_pos);
+    default:
+      break;
     }
 
-    // read move tag
-    if (move_tag.indexIn(pgn, offset, QRegExp::CaretAtOffset) != -1) {
-      // not nothing :)
-      tryRegExp(wsPattern, pgn, offset);
+    if (startsWith(m_pos, m_end, "1/2-1/2"))
+      m_pos += 7;
+    else if (startsWith(m_pos, m_end, "1-0") || startsWith(m_pos, m_end, "0-1"))
+      m_pos += 3;
+    else if (*m_pos == '*')
+      m_pos += 1;
+    if (m_pos != start)
+      return Token(Token::Result, start, m_pos);
+
+    if (isDigit(*m_pos))
+      return readNumber();
+    return readMove();
+  }
+}
+
+bool Lexer::skipTime() {
+  // (1:23.4)
+  const char* p = m_pos + 1;
+  while (p < m_end && (isDigit(*p) || *p == ':' || *p == '.'))
+    ++p;
+  if (p < m_end && *p == ')') {
+    m_pos = p + 1;
+    return true;
+  }
+  return false;
+}
+
+Token Lexer::readTag() {
+  // [Name "value"]
+  const char* start = m_pos;
+  const char* p = m_pos + 1;
+
+  Token res(Token::Tag);
+  res.name_begin = p;
+  while (p < m_end && !isSpace(*p) && *p != '"' && *p != ']')
+    ++p;
+  res.name_end = p;
+  while (p < m_end && isSpace(*p))
+    ++p;
+  if (res.name_end == res.name_begin || p == res.name_end || p == m_end || *p != '"')
+    return Token(Token::Error, start, m_end);
+
+  res.begin = ++p;
+  while (p < m_end && *p != '"') {
+    if (*p == '\\' && p + 1 < m_end)
+      ++p;
+    ++p;
+  }
+  res.end = p;
+  if (p == m_end)
+    return Token(Token::Error, start, m_end);
+
+  ++p;
+  while (p < m_end && isSpace(*p))
+    ++p;
+  if (p == m_end || *p != ']')
+    return Token(Token::Error, start, m_end);
+
+  m_pos = p + 1;
+  return res;
+}
+
+Token Lexer::readNumber() {
+  const char* start = m_pos;
+  const char* p = m_pos;
+  int n = 0;
+  while (p < m_end && isDigit(*p))
+    n = n * 10 + (*p++ - '0');
+
+  bool black = false;
+  if (startsWith(p, m_end, "...")) {
+    p += 3;
+    black = true;
+  }
+  else if (p < m_end && *p == '.') {
+    ++p;
+    const char* q = p;
+    while (q < m_end && isSpace(*q))
+      ++q;
+    if (q != p && startsWith(q, m_end, "...")) {
+      p = q + 3;
+      black = true;
     }
+  }
+  else if (p < m_end && !isSpace(*p)) {
+    // a move starting with a digit, like 0-0
+    return readMove();
+  }
+
+  m_pos = p;
+  Token res(Token::Number, start, p);
+  res.number = n * 2 + (black ? 1 : 0);
+  return res;
+}
+
+Token Lexer::readMove() {
+  const char* start = m_pos;
+  ++m_pos;
+  while (m_pos < m_end && !isSpace(*m_pos) &&
+         *m_pos != '{' && *m_pos != '(' && *m_pos != ')' &&
+         *m_pos != '[' && *m_pos != '$' && *m_pos != ';')
+    ++m_pos;
+  return Token(Token::Move, start, m_pos);
+}
+
+QString text(const char* begin, const char* end) {
+  return QString::fromUtf8(begin, end - begin);
+}
 
-    int num = 0;
+QString tagValue(const char* begin, const char* end) {
+  if (!memchr(begin, '\\', end - begin))
+    return text(begin, end);
 
-    // read number, and do not continue
-    if (number.indexIn(pgn, offset, QRegExp::CaretAtOffset) != -1) {
-      num = number.cap(1).toInt()*2 + (number.cap(2).isEmpty() ? 0 : 1);
-      offset += number.matchedLength();
-      tryRegExp(wsPattern, pgn, offset);
+  QByteArray res;
+  for (const char* p = begin; p < end; ++p) {
+    if (*p == '\\' && p + 1 < end)
+      ++p;
+    res.append(*p);
+  }
+  return QString::fromUtf8(res.constData(), res.size());
+}
+
+/**
+  * Comment text, with line breaks and a blank next
+  * to each of them folded into a single space.
+  */
+QString commentText(const char* begin, const char* end) {
+  if (!memchr(begin, '\n', end - begin))
+    return text(begin, end);
+
+  QByteArray res;
+  for (const char* p = begin; p < end; ) {
+    const char* q = p;
+    bool blank = *q == ' ' || *q == '\t';
+    if (blank)
+      ++q;
+    if (q < end && *q == '\r')
+      ++q;
+    if (q < end && *q == '\n') {
+      ++q;
+      if (q < end && *q == '\r')
+        ++q;
+      if (!blank && q < end && (*q == ' ' || *q == '\t'))
+        ++q;
+      res.append(' ');
+      p = q;
     }
+    else
+      res.append(*p++);
+  }
+  return QString::fromUtf8(res.constData(), res.size());
+}
+
+}
 
-    // read move
-    if (move.indexIn(pgn, offset, QRegExp::CaretAtOffset) != -1) {
-      m_entries.push_back(Move(num, move.cap(0)));
-      offset += move.matchedLength();
+bool PGN::parse(const QString& pgn) {
+  QByteArray source = pgn.toUtf8();
+  const char* end = source.constData() + source.size();
+  Lexer lexer(source.constData(), end);
+
+  int num = 0;
+  for (;;) {
+    Token token = lexer.next();
+
+    switch (token.type) {
+    case Token::End:
+      return true;
+    case Token::Result:
+      m_result = text(token.begin, token.end);
+      return true;
+    case Token::Tag:
+      m_tags[text(token.name_begin, token.name_end)] = tagValue(token.begin, token.end);
+      break;
+    case Token::Comment:
+      m_entries.push_back(commentText(token.begin, token.end));
+      break;
+    case Token::BeginVariation:
+      m_entries.push_back(BeginVariation());
+      break;
+    case Token::EndVariation:
+      m_entries.push_back(EndVariation());
+      break;
+    case Token::Number:
+      // applies to the following move
+      num = token.number;
       continue;
+    case Token::Move:
+      m_entries.push_back(Move(num, text(token.begin, token.end)));
+      break;
+    case Token::Error:
+      kDebug() << "pgn parse error! at"
+               << text(token.begin, token.begin + qMin(100, int(end - token.begin)));
+      return false;
     }
 
-    // parse error!
-    kDebug() << "pgn parse error! at" << pgn.mid(offset, 100);
-    return false;
+    num = 0;
   }
-
-  return true;
 }
-#undef IGNORE
 
 PGN::PGN(const QString& str) {
   m_valid = parse(str);
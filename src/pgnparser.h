@@ -24,8 +24,6 @@
 #endif
 #include <QString>
 
-class QRegExp;
-
 class PGN {
 public:
   class Move {
@@ -44,10 +42,6 @@ private:
   QString m_result;
   bool m_valid;
 
-  static QRegExp number, begin_var, end_var, comment, comment2,
-                   wsPattern, tag, result, time, eol, move_tag, move;
-
-  static bool tryRegExp(QRegExp& re, const QString& str, int& offset);
   bool parse(const QString& pgn);
 public:
   std::vector<Entry> m_entries;
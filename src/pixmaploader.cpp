@@ -28,6 +28,8 @@ public:
 PixmapLoader::PixmapLoader()
 : m_loader(NULL)
 , m_size(0)
+, m_receiver(NULL)
+, m_slot(NULL)
 {
 }
 
@@ -42,6 +44,9 @@ PixmapLoader::ThemeLoadersCache& PixmapLoader::loaders() {
 
 void PixmapLoader::flush() {
   if (m_loader) {
+    if (m_receiver)
+      QObject::disconnect(m_loader, SIGNAL(rendered()), m_receiver, m_slot);
+
     /* unref the size */
     if(m_size)
       m_loader->unrefSize(m_size);
@@ -97,6 +102,20 @@ void PixmapLoader::initialize() {
     m_loader->refSize(m_size);
 
   m_loader->refSize(0);
+
+  if (m_receiver)
+    QObject::connect(m_loader, SIGNAL(rendered()), m_receiver, m_slot);
+}
+
+void PixmapLoader::setRenderedNotifier(QObject* receiver, const char* slot) {
+  if (m_loader && m_receiver)
+    QObject::disconnect(m_loader, SIGNAL(rendered()), m_receiver, m_slot);
+
+  m_receiver = receiver;
+  m_slot = slot;
+
+  if (m_loader && m_receiver)
+    QObject::connect(m_loader, SIGNAL(rendered()), m_receiver, m_slot);
 }
 
 QPixmap PixmapLoader::getPixmap(const QString& id) {
@@ -112,6 +131,25 @@ QPixmap PixmapLoader::piecePixmap(const QString& id, bool flipped) {
 //   return getValue<QPixmap>(id);
 }
 
+QPixmap PixmapLoader::piecePixmapAsync(const QString& id, bool flipped, bool* exact) {
+  if (exact)
+    *exact = true;
+  if (!m_size || !m_theme)
+    return QPixmap();
+
+  if (!m_loader)
+    initialize();
+
+  ::LuaApi::LuaValueMap args;
+  if (flipped)
+    args["flipped"] = 0.0;
+
+  Loader::PixmapOrMap p = m_loader->getPixmapAsync(id, m_size, &args, exact);
+  if (QPixmap *px = boost::get<QPixmap>(&p))
+    return *px;
+  return QPixmap();
+}
+
 template<typename T>
 T PixmapLoader::getValue(const QString& id, const ::LuaApi::LuaValueMap* args, bool allow_nil) {
   if (!m_size || !m_theme)
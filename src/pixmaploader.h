@@ -44,6 +44,10 @@ private:
   /** the current theme */
   ThemeInfo m_theme;
 
+  /** the slot called when pixmaps rendered in the background are ready */
+  QObject* m_receiver;
+  const char* m_slot;
+
   /** internal, clears references to the currently used loader, if any. */
   void flush();
 
@@ -71,6 +75,15 @@ public:
   
   QPixmap piecePixmap(const QString& id, bool flipped = false);
 
+  /** like piecePixmap, but if the piece is not cached for the current size, a pixmap
+    * of another size is returned scaled, while the exact one is rendered in the background.
+    * @param exact Set to whether the returned pixmap is the exact one.
+    */
+  QPixmap piecePixmapAsync(const QString& id, bool flipped = false, bool* exact = NULL);
+
+  /** call @a slot of @a receiver whenever pixmaps rendered in the background become available */
+  void setRenderedNotifier(QObject* receiver, const char* slot);
+
   /** returns a value */
   template<typename T>
   T getValue(const QString& id, const ::LuaApi::LuaValueMap* args = NULL, bool allow_nil = false);
@@ -16,51 +16,83 @@
 
 using namespace boost;
 
+namespace {
+
 // Style 12 was designed by Daniel Sleator (sleator+@cs.cmu.edu) Darooha@ICC
-QRegExp PositionInfo::pattern(
-                                "^<12>\\s+"                          //header
-                                "([qkbnrpQKBNRP-]{8})\\s+"           //chessboard
-                                "([qkbnrpQKBNRP-]{8})\\s+"           //chessboard
-                                "([qkbnrpQKBNRP-]{8})\\s+"           //chessboard
-                                "([qkbnrpQKBNRP-]{8})\\s+"           //chessboard
-                                "([qkbnrpQKBNRP-]{8})\\s+"           //chessboard
-                                "([qkbnrpQKBNRP-]{8})\\s+"           //chessboard
-                                "([qkbnrpQKBNRP-]{8})\\s+"           //chessboard
-                                "([qkbnrpQKBNRP-]{8})\\s+"           //chessboard
-                                "([BW])\\s+"                         //black/white
-                                "(-1|[0-7])\\s+"                     //passing pawn
-                                "([01])\\s+"                         //castle rights
-                                "([01])\\s+"                         //castle rights
-                                "([01])\\s+"                         //castle rights
-                                "([01])\\s+"                         //castle rights
-                                "(-?\\d+)\\s+"                       //50 moves made
-                                "(\\d+)\\s+"                         //game num
-                                "(\\S+)\\s+"                         //white name
-                                "(\\S+)\\s+"                         //black name
-                                "(-[1-4]|[0-2])\\s+"                 //status
-                                "(\\d+)\\s+"                         //time
-                                "(\\d+)\\s+"                         //inc
-                                "(\\d+)\\s+"                         //w material
-                                "(\\d+)\\s+"                         //b material
-                                "(-?\\d+)\\s+"                       //w time
-                                "(-?\\d+)\\s+"                       //b time
-                                "(\\d+)\\s+"                         //move made
-                                "(\\S+)\\s+"                         //coordmove
-                                "(\\S+)\\s+"                         //time used
-                                "(\\S+)\\s+"                         //algmove
-                                "([0-1])"                            //flip
-
-);
-
-PositionInfo::PositionRow::PositionRow(const ICSAPIPtr& icsapi, const QString& str) {
-  Q_ASSERT(str.length() == 8);
-
-  row.resize(str.length());
-  for (int i = 0; i < str.length(); ++i) {
-    QChar c = str[i];
-    
-    row[i] = icsapi->createPiece(c);
+
+/** a field of a style12 line, pointing into the line itself */
+struct Field {
+  const QChar* data;
+  int length;
+
+  QString toString() const { return QString(data, length); }
+  bool is(char c) const { return length == 1 && data[0] == c; }
+  bool contains(char c) const {
+    for (int i = 0; i < length; i++)
+      if (data[i] == c) return true;
+    return false;
   }
+};
+
+/**
+  * Split @a str in whitespace separated fields.
+  * \return The number of fields found, at most @a max.
+  */
+int split(const QString& str, Field* fields, int max) {
+  const QChar* p = str.constData();
+  const QChar* end = p + str.length();
+  int n = 0;
+  while (n < max) {
+    while (p < end && p->isSpace()) p++;
+    if (p == end) break;
+    fields[n].data = p;
+    while (p < end && !p->isSpace()) p++;
+    fields[n].length = p - fields[n].data;
+    n++;
+  }
+  return n;
+}
+
+/**
+  * Parse a decimal number, with an optional minus sign if @a sign is true.
+  * \return Whether the whole field is a number.
+  */
+bool toInt(const Field& f, int& res, bool sign = false) {
+  int i = 0;
+  bool negative = sign && f.length > 0 && f.data[0] == '-';
+  if (negative) i++;
+  if (i == f.length) return false;
+
+  res = 0;
+  for (; i < f.length; i++) {
+    ushort c = f.data[i].unicode();
+    if (c < '0' || c > '9') return false;
+    res = res * 10 + (c - '0');
+  }
+  if (negative) res = -res;
+  return true;
+}
+
+/** \return Whether @a f is a row of a style12 board */
+bool isBoardRow(const Field& f) {
+  if (f.length != 8) return false;
+  for (int i = 0; i < 8; i++) {
+    switch (f.data[i].unicode()) {
+    case 'q': case 'k': case 'b': case 'n': case 'r': case 'p':
+    case 'Q': case 'K': case 'B': case 'N': case 'R': case 'P':
+    case '-':
+      break;
+    default:
+      return false;
+    }
+  }
+  return true;
+}
+
+bool isFlag(const Field& f) {
+  return f.is('0') || f.is('1');
+}
+
 }
 
 /**
@@ -76,15 +108,42 @@ PositionInfo::PositionInfo()
 : valid(false) { }
 
 bool PositionInfo::load(std::map<int, ICSGameData>& games, const QString& str) {
-  if (pattern.indexIn(str) != 0) {
-    valid = false;
+  typedef CaptureIndexes F;
+
+  // fields are checked as strictly as the old regular expression did,
+  // but nothing is copied until the whole line is known to be valid
+  Field f[F::Count];
+  valid = false;
+  if (!str.startsWith("<12>") || split(str, f, F::Count) < F::Count || f[0].length != 4)
+    return true;
+
+  for (int i = 0; i < 8; i++)
+    if (!isBoardRow(f[F::ChessboardStart + i]))
+      return true;
+
+  int ep, reversible, gn, rel, time, inc, wmat, bmat, wtime, btime, move;
+  if (!(f[F::Turn].is('W') || f[F::Turn].is('B'))
+      || !toInt(f[F::EnPassant], ep, true)
+      || !(ep == -1 || (f[F::EnPassant].length == 1 && ep <= 7))
+      || !isFlag(f[F::WhiteKingCastle]) || !isFlag(f[F::WhiteQueenCastle])
+      || !isFlag(f[F::BlackKingCastle]) || !isFlag(f[F::BlackQueenCastle])
+      || !toInt(f[F::ReversibleMoves], reversible, true)
+      || !toInt(f[F::GameNumber], gn)
+      || !toInt(f[F::Relation], rel, true)
+      || !(f[F::Relation].length == 1 ? rel <= 2 : (rel >= -4 && rel <= -1))
+      || !toInt(f[F::StartingTime], time)
+      || !toInt(f[F::StartingIncrement], inc)
+      || !toInt(f[F::WhiteMaterial], wmat)
+      || !toInt(f[F::BlackMaterial], bmat)
+      || !toInt(f[F::WhiteTime], wtime, true)
+      || !toInt(f[F::BlackTime], btime, true)
+      || !toInt(f[F::MoveOrdinal], move)
+      || !(f[F::Flip].data[0] == '0' || f[F::Flip].data[0] == '1'))
     return true;
-  }
 
   bool new_game = false;
   
   valid = true;
-  int gn = pattern.cap(CaptureIndexes::GameNumber).toInt();
   std::map<int, ICSGameData>::iterator gi = games.find(gn);
   ICSAPIPtr icsapi;
   
@@ -97,46 +156,43 @@ bool PositionInfo::load(std::map<int, ICSGameData>& games, const QString& str) {
   
   icsapi = gi->second.icsapi;
 
-  std::vector<PositionRow> rows;
-  for (uint i = 0; i < 8; ++i)
-    rows.push_back(PositionRow(icsapi, pattern.cap(CaptureIndexes::ChessboardStart + i)));
-
-  gameNumber = pattern.cap(CaptureIndexes::GameNumber).toInt();
-  moveIndex = pattern.cap(CaptureIndexes::MoveOrdinal).toInt();
-  whitePlayer = pattern.cap(CaptureIndexes::WhitePlayer);
-  blackPlayer = pattern.cap(CaptureIndexes::BlackPlayer);
-  turn = pattern.cap(CaptureIndexes::Turn) == "W"? 0 : 1;
+  gameNumber = gn;
+  moveIndex = move;
+  whitePlayer = f[F::WhitePlayer].toString();
+  blackPlayer = f[F::BlackPlayer].toString();
+  turn = f[F::Turn].is('W') ? 0 : 1;
 
-  int ep = pattern.cap(CaptureIndexes::EnPassant).toInt();
   if (ep == -1)
     enPassantSquare = Point::invalid();
   else
     enPassantSquare = Point(ep, turn == 0? 2 : 5);
 
-  bool wkCastle = pattern.cap(CaptureIndexes::WhiteKingCastle).toInt() == 1;
-  bool wqCastle = pattern.cap(CaptureIndexes::WhiteQueenCastle).toInt() == 1;
-  bool bkCastle = pattern.cap(CaptureIndexes::BlackKingCastle).toInt() == 1;
-  bool bqCastle = pattern.cap(CaptureIndexes::BlackQueenCastle).toInt() == 1;
-
-  position = icsapi->createChessboard(turn, wkCastle, wqCastle, bkCastle, bqCastle, enPassantSquare);
-  for (uint i = 0; i < 8; ++i) {
-    for (uint j = 0; j < rows[i].row.size(); ++j) {
-      position->set(Point(j,i), rows[i].row[j]);
-    }
+  QChar board[64];
+  for (int i = 0; i < 8; i++) {
+    const Field& row = f[F::ChessboardStart + i];
+    for (int j = 0; j < 8; j++)
+      board[i * 8 + j] = row.data[j];
   }
 
-  relation = static_cast<Relation>(pattern.cap(CaptureIndexes::Relation).toInt());
+  position = icsapi->createChessboard(turn,
+                                      f[F::WhiteKingCastle].is('1'),
+                                      f[F::WhiteQueenCastle].is('1'),
+                                      f[F::BlackKingCastle].is('1'),
+                                      f[F::BlackQueenCastle].is('1'),
+                                      enPassantSquare, board);
+
+  relation = static_cast<Relation>(rel);
 
-  whiteTime = pattern.cap(CaptureIndexes::WhiteTime).toInt();
-  blackTime = pattern.cap(CaptureIndexes::BlackTime).toInt();
-  if (pattern.cap(CaptureIndexes::TimeUsed).indexOf('.') == -1) {
+  whiteTime = wtime;
+  blackTime = btime;
+  if (!f[F::TimeUsed].contains('.')) {
     // time is in seconds
     whiteTime *= 1000;
     blackTime *= 1000;
   }
 
-  lastMoveSAN = pattern.cap(CaptureIndexes::LastMove);
-  lastMove = pattern.cap(CaptureIndexes::LastMoveVerbose);
+  lastMoveSAN = f[F::LastMove].toString();
+  lastMove = f[F::LastMoveVerbose].toString();
   
   return new_game;
 }
@@ -33,6 +33,7 @@ public:
     UnknownRelation   = -255
   };
 
+  /** indexes of the fields of a style12 line, the <12> header being the field 0 */
   class CaptureIndexes {
   public:
     enum {
@@ -50,24 +51,19 @@ public:
       Relation          = 19,
       StartingTime      = 20,
       StartingIncrement = 21,
+      WhiteMaterial     = 22,
+      BlackMaterial     = 23,
       WhiteTime         = 24,
       BlackTime         = 25,
       MoveOrdinal       = 26,
       LastMoveVerbose   = 27,
       TimeUsed          = 28,
       LastMove          = 29,
-      Flip              = 30
+      Flip              = 30,
+      Count             = 31
     };
   };
 
-  class PositionRow {
-  public:
-    std::vector<AbstractPiece::Ptr> row;
-    explicit PositionRow(const ICSAPIPtr& icsapi, const QString& str);
-  };
-
-  static QRegExp pattern;
-
   bool valid;
   PositionInfo();
   
@@ -94,6 +90,9 @@ public:
   QString lastMove;
   int whiteTime;
   int blackTime;
+
+  /** the premove already sent in reply to this position, if any */
+  AbstractMove::Ptr sentPremove;
 };
 
 #endif // POSITIONINFO_H
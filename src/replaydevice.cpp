@@ -0,0 +1,114 @@
+/*
+  Copyright (c) 2006 Paolo Capriotti <p.capriotti@gmail.com>
+            (c) 2006 Maurizio Monge <maurizio.monge@kdemail.net>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#include "replaydevice.h"
+#include <string.h>
+#include <QFile>
+#include <QTimer>
+#include <KDebug>
+
+ReplayDevice::ReplayDevice(Speed speed, QObject* parent)
+: QIODevice(parent)
+, m_next(0)
+, m_speed(speed) {
+}
+
+bool ReplayDevice::load(const QString& file_name) {
+  QFile file(file_name);
+  if (!file.open(QIODevice::ReadOnly)) {
+    kError() << "Cannot open connection log" << file_name;
+    return false;
+  }
+
+  m_chunks.clear();
+  bool timed = false;
+  while (!file.atEnd()) {
+    QByteArray line = file.readLine();
+    if (line.startsWith("@ ")) {
+      // data received after this many milliseconds
+      Chunk chunk;
+      chunk.time = line.mid(2).trimmed().toInt();
+      m_chunks.push_back(chunk);
+      timed = true;
+    }
+    else if (line.startsWith("< ")) {
+      line.remove(0, 2);
+      if (!line.endsWith('\n'))
+        line += '\n';
+
+      if (!timed || m_chunks.empty()) {
+        Chunk chunk;
+        chunk.time = m_chunks.empty() ? 0 : m_chunks.back().time;
+        m_chunks.push_back(chunk);
+      }
+      m_chunks.back().data += line;
+    }
+  }
+
+  return open(QIODevice::ReadWrite | QIODevice::Unbuffered);
+}
+
+void ReplayDevice::start() {
+  m_next = 0;
+  m_buffer.clear();
+  m_clock.start();
+  scheduleNext();
+}
+
+void ReplayDevice::scheduleNext() {
+  if (m_next >= m_chunks.size())
+    return;
+
+  int delay = 0;
+  if (m_speed == RecordedSpeed)
+    delay = qMax(0, m_chunks[m_next].time - m_clock.elapsed());
+  QTimer::singleShot(delay, this, SLOT(deliver()));
+}
+
+void ReplayDevice::deliver() {
+  if (m_next >= m_chunks.size())
+    return;
+
+  // at recorded speed, deliver whatever should have arrived by now at once
+  do {
+    m_buffer += m_chunks[m_next++].data;
+  } while (m_speed == RecordedSpeed && m_next < m_chunks.size()
+           && m_chunks[m_next].time <= m_clock.elapsed());
+
+  readyRead();
+  scheduleNext();
+
+  if (finished())
+    replayFinished();
+}
+
+bool ReplayDevice::finished() const {
+  return m_next >= m_chunks.size() && m_buffer.isEmpty();
+}
+
+qint64 ReplayDevice::bytesAvailable() const {
+  return m_buffer.size() + QIODevice::bytesAvailable();
+}
+
+bool ReplayDevice::canReadLine() const {
+  return m_buffer.contains('\n') || QIODevice::canReadLine();
+}
+
+qint64 ReplayDevice::readData(char* data, qint64 max_size) {
+  int size = qMin<qint64>(max_size, m_buffer.size());
+  memcpy(data, m_buffer.constData(), size);
+  m_buffer.remove(0, size);
+  return size;
+}
+
+qint64 ReplayDevice::writeData(const char* data, qint64 size) {
+  m_sent.append(data, size);
+  return size;
+}
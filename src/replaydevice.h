@@ -0,0 +1,88 @@
+/*
+  Copyright (c) 2006 Paolo Capriotti <p.capriotti@gmail.com>
+            (c) 2006 Maurizio Monge <maurizio.monge@kdemail.net>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#ifndef REPLAYDEVICE_H
+#define REPLAYDEVICE_H
+
+#include <vector>
+#include <QByteArray>
+#include <QIODevice>
+#include <QTime>
+
+/**
+  * @class ReplayDevice <replaydevice.h>
+  * @brief Plays back a recorded connection log, in place of a server.
+  *
+  * The data received in the log (lines starting with "< ") is made
+  * available for reading, either at the pace it was recorded with, or
+  * as fast as it is read. Data written to the device is collected, and
+  * can be checked with @ref sent.
+  * Logs without timing information are played one line at a time.
+  */
+class ReplayDevice : public QIODevice {
+Q_OBJECT
+public:
+  enum Speed {
+    RecordedSpeed,
+    MaximumSpeed
+  };
+
+private:
+  /** data received at @a time milliseconds from the start of the log */
+  struct Chunk {
+    int time;
+    QByteArray data;
+  };
+
+  std::vector<Chunk> m_chunks;
+  unsigned int m_next;
+  Speed m_speed;
+  QTime m_clock;
+
+  /** delivered data not read yet */
+  QByteArray m_buffer;
+  QByteArray m_sent;
+
+  void scheduleNext();
+public:
+  ReplayDevice(Speed speed, QObject* parent = 0);
+
+  /**
+    * Read the log @a file_name, and open the device.
+    * \return Whether the log could be read.
+    */
+  bool load(const QString& file_name);
+
+  /** Start playing, from the beginning */
+  void start();
+
+  /** \return Whether all the data has been delivered and read */
+  bool finished() const;
+
+  /** \return Everything written to the device so far */
+  const QByteArray& sent() const { return m_sent; }
+
+  virtual bool isSequential() const { return true; }
+  virtual qint64 bytesAvailable() const;
+  virtual bool canReadLine() const;
+
+protected:
+  virtual qint64 readData(char* data, qint64 max_size);
+  virtual qint64 writeData(const char* data, qint64 size);
+
+private Q_SLOTS:
+  void deliver();
+
+Q_SIGNALS:
+  /** All the data has been delivered and read */
+  void replayFinished();
+};
+
+#endif // REPLAYDEVICE_H
@@ -0,0 +1,120 @@
+/*
+  Copyright (c) 2007 Paolo Capriotti <p.capriotti@gmail.com>
+            (c) 2007 Maurizio Monge <maurizio.monge@kdemail.net>
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+*/
+
+#ifndef SMALLVECTOR_H
+#define SMALLVECTOR_H
+
+#include <QtGlobal>
+
+/**
+  * @class SmallVector <smallvector.h>
+  * @brief A vector keeping up to N elements inline.
+  *
+  * Only vectors growing past N elements allocate memory.
+  * T has to be default constructible and assignable.
+  */
+template <typename T, int N>
+class SmallVector {
+  T m_inline[N];
+  T* m_data;
+  int m_size;
+  int m_capacity;
+
+  void grow(int capacity);
+public:
+  SmallVector()
+  : m_data(m_inline), m_size(0), m_capacity(N) { }
+  SmallVector(const SmallVector& other);
+  ~SmallVector();
+
+  SmallVector& operator=(const SmallVector& other);
+
+  int size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+
+  T& operator[](int i) { Q_ASSERT(i >= 0 && i < m_size); return m_data[i]; }
+  const T& operator[](int i) const { Q_ASSERT(i >= 0 && i < m_size); return m_data[i]; }
+
+  T& back() { Q_ASSERT(m_size > 0); return m_data[m_size - 1]; }
+  const T& back() const { Q_ASSERT(m_size > 0); return m_data[m_size - 1]; }
+  T& last() { return back(); }
+  const T& last() const { return back(); }
+
+  void push_back(const T& value);
+  void pop_back() { Q_ASSERT(m_size > 0); m_size--; }
+  void clear() { m_size = 0; }
+
+  bool operator==(const SmallVector& other) const;
+  bool operator!=(const SmallVector& other) const { return !(*this == other); }
+};
+
+// IMPLEMENTATION
+
+template <typename T, int N>
+SmallVector<T, N>::SmallVector(const SmallVector& other)
+: m_data(m_inline), m_size(0), m_capacity(N) {
+  *this = other;
+}
+
+template <typename T, int N>
+SmallVector<T, N>::~SmallVector() {
+  if (m_data != m_inline)
+    delete[] m_data;
+}
+
+template <typename T, int N>
+void SmallVector<T, N>::grow(int capacity) {
+  T* data = new T[capacity];
+  for (int i = 0; i < m_size; i++)
+    data[i] = m_data[i];
+  if (m_data != m_inline)
+    delete[] m_data;
+  m_data = data;
+  m_capacity = capacity;
+}
+
+template <typename T, int N>
+SmallVector<T, N>& SmallVector<T, N>::operator=(const SmallVector& other) {
+  if (this == &other)
+    return *this;
+
+  m_size = 0;
+  if (m_capacity < other.m_size)
+    grow(other.m_size);
+  for (int i = 0; i < other.m_size; i++)
+    m_data[i] = other.m_data[i];
+  m_size = other.m_size;
+  return *this;
+}
+
+template <typename T, int N>
+void SmallVector<T, N>::push_back(const T& value) {
+  if (m_size == m_capacity) {
+    // value could live in the buffer being replaced
+    T copy = value;
+    grow(m_capacity * 2);
+    m_data[m_size++] = copy;
+  }
+  else
+    m_data[m_size++] = value;
+}
+
+template <typename T, int N>
+bool SmallVector<T, N>::operator==(const SmallVector& other) const {
+  if (m_size != other.m_size)
+    return false;
+  for (int i = 0; i < m_size; i++) {
+    if (m_data[i] != other.m_data[i])
+      return false;
+  }
+  return true;
+}
+
+#endif // SMALLVECTOR_H
@@ -12,6 +12,7 @@
 #define LOWLEVEL_H
 
 #include <map>
+#include <vector>
 #include <boost/shared_ptr.hpp>
 #include <QString>
 #include <QStringList>
@@ -243,6 +244,15 @@ public:
     */
   virtual bool testMove(const MovePtr& m) const = 0;
 
+  /**
+    * Collect all legal moves of the player in turn, moves of pieces
+    * on the board in @a moves and drops in @a drops.
+    * \return false if the variant cannot enumerate its moves, in which
+    *         case they can only be checked one at a time with testMove.
+    */
+  virtual bool legalMoves(std::vector<NormalUserMove>& moves,
+                          std::vector<DropUserMove>& drops) const = 0;
+
   /**
     * Execute move \a m. Assume that \a m is legal and tested.
     */
@@ -263,6 +273,13 @@ public:
     */
   virtual bool equals(const PositionPtr& p) const = 0;
 
+  /**
+    * \return A 64 bit key identifying the position, suitable for
+    *         transposition tables and repetition detection.
+    *         Equal positions have equal keys.
+    */
+  virtual quint64 hash() const = 0;
+
   /**
     * Return a move from an algebraic notation, or a null pointer.
     */
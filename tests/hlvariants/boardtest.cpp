@@ -1,6 +1,7 @@
 #include "boardtest.h"
 #include "point.h"
 #include "hlvariant/board.h"
+#include "hlvariant/crazyhouse/piece.h"
 
 CPPUNIT_TEST_SUITE_REGISTRATION(BoardTest);
 
@@ -133,7 +134,45 @@ void BoardTest::test_find() {
   CPPUNIT_ASSERT(m_board->find(32) == Point(3, 4));
 }
 
+void BoardTest::test_hash() {
+  CPPUNIT_ASSERT_EQUAL(quint64(0), m_board->hash());
+  
+  m_board->set(Point(3, 4), 32);
+  m_board->set(Point(5, 6), 22);
+  quint64 hash = m_board->hash();
+  CPPUNIT_ASSERT(hash != 0);
+  
+  HLVariant::Board<int> other(m_board->size());
+  other.set(Point(5, 6), 22);
+  other.set(Point(3, 4), 32);
+  CPPUNIT_ASSERT_EQUAL(hash, other.hash());
+  
+  // swapping two pieces changes the key
+  other.set(Point(5, 6), 32);
+  other.set(Point(3, 4), 22);
+  CPPUNIT_ASSERT(hash != other.hash());
+  
+  m_board->set(Point(3, 4), 0);
+  m_board->set(Point(5, 6), 0);
+  CPPUNIT_ASSERT_EQUAL(quint64(0), m_board->hash());
+}
 
-
-
-
+void BoardTest::test_compare_promoted() {
+  using HLVariant::Crazyhouse::Piece;
+  HLVariant::Board<Piece> board(Point(8, 8));
+  HLVariant::Board<Piece> other(Point(8, 8));
+  
+  // servers do not tell promoted pieces apart from the others
+  Piece queen(Piece::WHITE, Piece::QUEEN);
+  Piece promoted(queen);
+  promoted.setPromoted();
+  board.set(Point(3, 0), promoted);
+  other.set(Point(3, 0), queen);
+  
+  CPPUNIT_ASSERT(board == other);
+  CPPUNIT_ASSERT_EQUAL(board.hash(), other.hash());
+  CPPUNIT_ASSERT(board.get(Point(3, 0)).promoted());
+  
+  other.set(Point(3, 0), Piece(Piece::WHITE, Piece::ROOK));
+  CPPUNIT_ASSERT(board != other);
+}
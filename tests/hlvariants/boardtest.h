@@ -21,6 +21,8 @@ class BoardTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(test_compare);
   CPPUNIT_TEST(test_clone);
   CPPUNIT_TEST(test_find);
+  CPPUNIT_TEST(test_hash);
+  CPPUNIT_TEST(test_compare_promoted);
   
   CPPUNIT_TEST(test_pathinfo_h);
   CPPUNIT_TEST(test_pathinfo_v);
@@ -43,6 +45,8 @@ public:
   void test_compare();
   void test_clone();
   void test_find();
+  void test_hash();
+  void test_compare_promoted();
   
   // path info
   void test_pathinfo_h();
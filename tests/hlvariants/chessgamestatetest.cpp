@@ -102,3 +102,90 @@ void ChessGameStateTest::test_promotion() {
 }
 
 
+
+void ChessGameStateTest::test_unmove() {
+  m_state->move(ChessMove(Point(4, 6), Point(4, 4))); // e4
+  m_state->move(ChessMove(Point(3, 1), Point(3, 3))); // d5
+  
+  ChessGameState ref(*m_state);
+  ChessMove exd5(Point(4, 4), Point(3, 3));
+  ChessGameState::UndoInfo undo = m_state->undoInfo(exd5);
+  m_state->move(exd5);
+  m_state->unmove(exd5, undo);
+  
+  CPPUNIT_ASSERT(*m_state == ref);
+  CPPUNIT_ASSERT_EQUAL(ChessPiece::WHITE, m_state->turn());
+  CPPUNIT_ASSERT(m_state->board().get(Point(3, 3)) ==
+    ChessPiece(ChessPiece::BLACK, ChessPiece::PAWN));
+}
+
+void ChessGameStateTest::test_unmove_castling() {
+  m_state->board().set(Point(1, 7), ChessPiece());
+  m_state->board().set(Point(2, 7), ChessPiece());
+  m_state->board().set(Point(3, 7), ChessPiece());
+  
+  ChessGameState ref(*m_state);
+  ChessMove ooo(Point(4, 7), Point(2, 7));
+  ooo.setType(ChessMove::QUEEN_SIDE_CASTLING);
+  ChessGameState::UndoInfo undo = m_state->undoInfo(ooo);
+  m_state->move(ooo);
+  m_state->unmove(ooo, undo);
+  
+  CPPUNIT_ASSERT(*m_state == ref);
+  CPPUNIT_ASSERT(m_state->kingCastling(ChessPiece::WHITE));
+  CPPUNIT_ASSERT(m_state->queenCastling(ChessPiece::WHITE));
+  CPPUNIT_ASSERT(m_state->board().get(Point(0, 7)) ==
+    ChessPiece(ChessPiece::WHITE, ChessPiece::ROOK));
+}
+
+void ChessGameStateTest::test_unmove_en_passant() {
+  m_state->move(ChessMove(Point(4, 6), Point(4, 4))); // e4
+  m_state->move(ChessMove(Point(7, 1), Point(7, 2))); // h6
+  m_state->move(ChessMove(Point(4, 4), Point(4, 3))); // e5
+  
+  ChessMove d5(Point(3, 1), Point(3, 3));
+  d5.setType(ChessMove::EN_PASSANT_TRIGGER);
+  m_state->move(d5);
+  
+  ChessGameState ref(*m_state);
+  ChessMove exd6(Point(4, 3), Point(3, 2));
+  exd6.setType(ChessMove::EN_PASSANT_CAPTURE);
+  ChessGameState::UndoInfo undo = m_state->undoInfo(exd6);
+  m_state->move(exd6);
+  m_state->unmove(exd6, undo);
+  
+  CPPUNIT_ASSERT(*m_state == ref);
+  CPPUNIT_ASSERT(m_state->enPassant() == Point(3, 2));
+  CPPUNIT_ASSERT(m_state->board().get(Point(3, 3)) ==
+    ChessPiece(ChessPiece::BLACK, ChessPiece::PAWN));
+}
+
+void ChessGameStateTest::test_hash() {
+  ChessGameState other(*m_state);
+  CPPUNIT_ASSERT_EQUAL(m_state->hash(), other.hash());
+  
+  // transposition
+  m_state->move(ChessMove(Point(6, 7), Point(5, 5))); // Nf3
+  m_state->move(ChessMove(Point(6, 0), Point(5, 2))); // Nf6
+  m_state->move(ChessMove(Point(1, 7), Point(2, 5))); // Nc3
+  other.move(ChessMove(Point(1, 7), Point(2, 5))); // Nc3
+  other.move(ChessMove(Point(6, 0), Point(5, 2))); // Nf6
+  other.move(ChessMove(Point(6, 7), Point(5, 5))); // Nf3
+  CPPUNIT_ASSERT_EQUAL(m_state->hash(), other.hash());
+  
+  // same board, different turn
+  other.switchTurn();
+  CPPUNIT_ASSERT(m_state->hash() != other.hash());
+  other.switchTurn();
+  
+  // en passant square
+  ChessMove e5(Point(4, 1), Point(4, 3));
+  e5.setType(ChessMove::EN_PASSANT_TRIGGER);
+  ChessGameState::UndoInfo undo = m_state->undoInfo(e5);
+  m_state->move(e5);
+  quint64 hash = m_state->hash();
+  m_state->unmove(e5, undo);
+  CPPUNIT_ASSERT_EQUAL(other.hash(), m_state->hash());
+  m_state->move(ChessMove(Point(4, 1), Point(4, 3)));
+  CPPUNIT_ASSERT(m_state->hash() != hash);
+}
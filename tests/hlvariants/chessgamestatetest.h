@@ -34,6 +34,10 @@ class ChessGameStateTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(test_kingside_castling);
   CPPUNIT_TEST(test_queenside_castling);
   CPPUNIT_TEST(test_promotion);
+  CPPUNIT_TEST(test_unmove);
+  CPPUNIT_TEST(test_unmove_castling);
+  CPPUNIT_TEST(test_unmove_en_passant);
+  CPPUNIT_TEST(test_hash);
   CPPUNIT_TEST_SUITE_END();
 private:
   ChessGameState* m_state;
@@ -48,6 +52,10 @@ public:
   void test_kingside_castling();
   void test_queenside_castling();
   void test_promotion();
+  void test_unmove();
+  void test_unmove_castling();
+  void test_unmove_en_passant();
+  void test_hash();
 };
 
 #endif // CHESSGAMESTATETEST_H
@@ -169,3 +169,65 @@ void ChessLegalityTest::test_attack4() {
   CPPUNIT_ASSERT(!m_legality_check->attacks(ChessPiece::BLACK, Point(4, 7)));
 }
 
+void ChessLegalityTest::test_attack_table() {
+  Point d3(3, 5);
+  Point e2(4, 6);
+  ChessPiece friendly(ChessPiece::WHITE, ChessPiece::KNIGHT);
+  
+  // the d pawn can move to d3, but a white piece there cannot be captured
+  CPPUNIT_ASSERT(m_legality_check->attacks(ChessPiece::WHITE, d3));
+  CPPUNIT_ASSERT(!m_legality_check->attacks(ChessPiece::WHITE, d3, friendly));
+  CPPUNIT_ASSERT(m_legality_check->attacks(ChessPiece::WHITE, d3));
+  CPPUNIT_ASSERT(!m_legality_check->attacks(ChessPiece::WHITE, e2));
+  
+  // after e4, the square left by the pawn is reachable
+  m_state->move(ChessMove(Point(4, 6), Point(4, 4)));
+  CPPUNIT_ASSERT(m_legality_check->attacks(ChessPiece::WHITE, e2));
+  CPPUNIT_ASSERT(m_legality_check->kingPosition(ChessPiece::WHITE) == Point(4, 7));
+
+  // playing a move and taking it back keeps the map of the position
+  HLVariant::AttackTable& table = m_state->attackTable();
+  HLVariant::AttackTable::Map* map = &table.map(m_state->hash(), m_state->board().size());
+  CPPUNIT_ASSERT(map->filled());
+  ChessMove e5(Point(4, 1), Point(4, 3));
+  ChessGameState::UndoInfo undo = m_state->undoInfo(e5);
+  m_state->move(e5);
+  CPPUNIT_ASSERT(m_legality_check->kingPosition(ChessPiece::BLACK) == Point(4, 0));
+  m_state->unmove(e5, undo);
+  CPPUNIT_ASSERT(&table.map(m_state->hash(), m_state->board().size()) == map);
+  CPPUNIT_ASSERT(map->filled());
+
+  // copies start with a table of their own
+  ChessGameState copy(*m_state);
+  CPPUNIT_ASSERT(&copy.attackTable() != &table);
+  CPPUNIT_ASSERT(!copy.attackTable().map(copy.hash(), copy.board().size()).filled());
+
+  m_state->board().set(Point(4, 7), ChessPiece());
+  CPPUNIT_ASSERT(!m_legality_check->kingPosition(ChessPiece::WHITE).valid());
+}
+
+void ChessLegalityTest::test_legal_const() {
+  const ChessGameState state(*m_state);
+  ChessLegalityCheck check(state);
+  quint64 hash = state.hash();
+  
+  ChessMove e4(Point(4, 6), Point(4, 4));
+  CPPUNIT_ASSERT(check.legal(e4));
+  ChessMove Ke2(Point(4, 7), Point(4, 6));
+  CPPUNIT_ASSERT(!check.legal(Ke2));
+  
+  // trying moves leaves the state alone
+  CPPUNIT_ASSERT_EQUAL(hash, state.hash());
+  CPPUNIT_ASSERT(state == *m_state);
+  
+  // a check keeps up with moves played on its state
+  CPPUNIT_ASSERT(m_legality_check->legal(e4));
+  m_state->move(e4);
+  ChessMove Ke7(Point(4, 0), Point(4, 1));
+  CPPUNIT_ASSERT(!m_legality_check->legal(Ke7));
+  ChessMove e5(Point(4, 1), Point(4, 3));
+  CPPUNIT_ASSERT(m_legality_check->legal(e5));
+  m_state->move(e5);
+  ChessMove Ke2_(Point(4, 7), Point(4, 6));
+  CPPUNIT_ASSERT(m_legality_check->legal(Ke2_));
+}
@@ -39,6 +39,8 @@ class ChessLegalityTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(test_attack2);
   CPPUNIT_TEST(test_attack3);
   CPPUNIT_TEST(test_attack4);
+  CPPUNIT_TEST(test_attack_table);
+  CPPUNIT_TEST(test_legal_const);
   CPPUNIT_TEST_SUITE_END();
 private:
   ChessGameState* m_state;
@@ -57,6 +59,8 @@ public:
   void test_attack2();
   void test_attack3();
   void test_attack4();
+  void test_attack_table();
+  void test_legal_const();
 };
 
 #endif // CHESSGAMESTATETEST_H
@@ -0,0 +1,141 @@
+#include "chessmovegeneratortest.h"
+#include "hlvariant/chess/bitboardmovegenerator.h"
+
+#include <set>
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ChessMoveGeneratorTest);
+
+using namespace HLVariant::Chess;
+
+typedef LegalityCheck<ChessGameState> ChessLegalityCheck;
+typedef MoveGenerator<ChessLegalityCheck> SlowGenerator;
+typedef BitboardMoveGenerator<ChessLegalityCheck> FastGenerator;
+
+namespace {
+
+class CollectMoves : public SlowGenerator::MoveCallback {
+public:
+  std::set<std::pair<int, int> > moves;
+  
+  virtual bool operator()(const ChessMove& m) {
+    int from = m.from().x + m.from().y * 8;
+    int to = m.to().x + m.to().y * 8;
+    moves.insert(std::make_pair(from * 64 + to, m.promoteTo()));
+    return true;
+  }
+};
+
+std::set<std::pair<int, int> > fastMoves(const ChessGameState& state) {
+  CollectMoves collect;
+  FastGenerator(state).generate(collect);
+  return collect.moves;
+}
+
+std::set<std::pair<int, int> > slowMoves(const ChessGameState& state) {
+  CollectMoves collect;
+  SlowGenerator(state).generate(collect);
+  return collect.moves;
+}
+
+}
+
+void ChessMoveGeneratorTest::setUp() {
+  m_state = new ChessGameState;
+}
+
+void ChessMoveGeneratorTest::tearDown() {
+  delete m_state;
+}
+
+void ChessMoveGeneratorTest::test_attacks() {
+  int d4 = Bitboards::square(Point(3, 4));
+  CPPUNIT_ASSERT_EQUAL(8, Bitboards::count(Bitboards::knightAttacks(d4)));
+  CPPUNIT_ASSERT_EQUAL(14, Bitboards::count(Bitboards::rookAttacks(d4, 0)));
+  CPPUNIT_ASSERT_EQUAL(13, Bitboards::count(Bitboards::bishopAttacks(d4, 0)));
+  
+  // a blocker on d6 stops the rook there
+  Bitboard d6 = Bitboards::bit(Bitboards::square(Point(3, 2)));
+  Bitboard attacks = Bitboards::rookAttacks(d4, d6);
+  CPPUNIT_ASSERT(attacks & d6);
+  CPPUNIT_ASSERT(!(attacks & Bitboards::bit(Bitboards::square(Point(3, 1)))));
+  
+  CPPUNIT_ASSERT_EQUAL(1, Bitboards::count(
+    Bitboards::between(d4, Bitboards::square(Point(3, 2)))));
+  CPPUNIT_ASSERT_EQUAL(Bitboard(0), 
+    Bitboards::between(d4, Bitboards::square(Point(4, 2))));
+}
+
+void ChessMoveGeneratorTest::test_initial() {
+  m_state->setup();
+  CPPUNIT_ASSERT_EQUAL(20, (int)fastMoves(*m_state).size());
+  CPPUNIT_ASSERT(fastMoves(*m_state) == slowMoves(*m_state));
+}
+
+void ChessMoveGeneratorTest::test_same_moves() {
+  m_state->setup();
+  m_state->move(ChessMove(Point(4, 6), Point(4, 4)));
+  m_state->move(ChessMove(Point(3, 1), Point(3, 3)));
+  m_state->move(ChessMove(Point(4, 4), Point(3, 3)));
+  m_state->move(ChessMove(Point(3, 0), Point(3, 3)));
+  m_state->move(ChessMove(Point(1, 7), Point(2, 5)));
+  
+  CPPUNIT_ASSERT(fastMoves(*m_state) == slowMoves(*m_state));
+}
+
+void ChessMoveGeneratorTest::test_pin() {
+  m_state->board().set(Point(4, 7), ChessPiece(ChessPiece::WHITE, ChessPiece::KING));
+  m_state->board().set(Point(4, 5), ChessPiece(ChessPiece::WHITE, ChessPiece::ROOK));
+  m_state->board().set(Point(4, 0), ChessPiece(ChessPiece::BLACK, ChessPiece::ROOK));
+  m_state->board().set(Point(0, 0), ChessPiece(ChessPiece::BLACK, ChessPiece::KING));
+  
+  // the rook can only move along the e file
+  std::set<std::pair<int, int> > moves = fastMoves(*m_state);
+  CPPUNIT_ASSERT(moves == slowMoves(*m_state));
+  CPPUNIT_ASSERT_EQUAL(6 + 5, (int)moves.size());
+}
+
+void ChessMoveGeneratorTest::test_double_check() {
+  m_state->board().set(Point(4, 7), ChessPiece(ChessPiece::WHITE, ChessPiece::KING));
+  m_state->board().set(Point(0, 7), ChessPiece(ChessPiece::WHITE, ChessPiece::ROOK));
+  m_state->board().set(Point(4, 0), ChessPiece(ChessPiece::BLACK, ChessPiece::ROOK));
+  m_state->board().set(Point(3, 5), ChessPiece(ChessPiece::BLACK, ChessPiece::KNIGHT));
+  m_state->board().set(Point(0, 0), ChessPiece(ChessPiece::BLACK, ChessPiece::KING));
+  
+  std::set<std::pair<int, int> > moves = fastMoves(*m_state);
+  CPPUNIT_ASSERT(moves == slowMoves(*m_state));
+  CPPUNIT_ASSERT(FastGenerator(*m_state).check(ChessPiece::WHITE));
+}
+
+void ChessMoveGeneratorTest::test_en_passant_pin() {
+  m_state->board().set(Point(0, 3), ChessPiece(ChessPiece::WHITE, ChessPiece::KING));
+  m_state->board().set(Point(4, 3), ChessPiece(ChessPiece::WHITE, ChessPiece::PAWN));
+  m_state->board().set(Point(3, 1), ChessPiece(ChessPiece::BLACK, ChessPiece::PAWN));
+  m_state->board().set(Point(7, 3), ChessPiece(ChessPiece::BLACK, ChessPiece::ROOK));
+  m_state->board().set(Point(7, 0), ChessPiece(ChessPiece::BLACK, ChessPiece::KING));
+  m_state->switchTurn();
+  m_state->move(ChessMove(Point(3, 1), Point(3, 3)));
+  
+  // exd6 would expose the king along the fifth rank
+  std::set<std::pair<int, int> > moves = fastMoves(*m_state);
+  CPPUNIT_ASSERT(moves == slowMoves(*m_state));
+  int exd6 = (4 + 3 * 8) * 64 + (3 + 2 * 8);
+  CPPUNIT_ASSERT(moves.find(std::make_pair(exd6, -1)) == moves.end());
+}
+
+void ChessMoveGeneratorTest::test_castling() {
+  m_state->setup();
+  m_state->board().set(Point(5, 7), ChessPiece());
+  m_state->board().set(Point(6, 7), ChessPiece());
+  m_state->board().set(Point(2, 7), ChessPiece());
+  m_state->board().set(Point(3, 7), ChessPiece());
+  
+  // O-O is generated, O-O-O is blocked by the knight on b1
+  std::set<std::pair<int, int> > moves = fastMoves(*m_state);
+  int e1 = 4 + 7 * 8;
+  CPPUNIT_ASSERT(moves.find(std::make_pair(e1 * 64 + e1 + 2, -1)) != moves.end());
+  CPPUNIT_ASSERT(moves.find(std::make_pair(e1 * 64 + e1 - 2, -1)) == moves.end());
+  
+  m_state->board().set(Point(1, 7), ChessPiece());
+  moves = fastMoves(*m_state);
+  CPPUNIT_ASSERT(moves.find(std::make_pair(e1 * 64 + e1 - 2, -1)) != moves.end());
+}
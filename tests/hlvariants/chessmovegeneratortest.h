@@ -0,0 +1,51 @@
+#ifndef CHESSMOVEGENERATORTEST_H
+#define CHESSMOVEGENERATORTEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+
+#include "hlvariant/customboard.h"
+
+// forward decl
+namespace HLVariant {
+  namespace Chess {
+    template <typename Board, typename Move> class GameState;
+    class Move;
+    class Piece;
+  }
+}
+
+typedef HLVariant::Chess::Move ChessMove;
+typedef HLVariant::Chess::Piece ChessPiece;
+typedef HLVariant::CustomBoard<8, 8, ChessPiece> Chessboard;
+typedef HLVariant::Chess::GameState<Chessboard, ChessMove> ChessGameState;
+
+class ChessMoveGeneratorTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(ChessMoveGeneratorTest);
+  CPPUNIT_TEST(test_attacks);
+  CPPUNIT_TEST(test_initial);
+  CPPUNIT_TEST(test_same_moves);
+  CPPUNIT_TEST(test_pin);
+  CPPUNIT_TEST(test_double_check);
+  CPPUNIT_TEST(test_en_passant_pin);
+  CPPUNIT_TEST(test_castling);
+  CPPUNIT_TEST_SUITE_END();
+private:
+  ChessGameState* m_state;
+public:
+  void setUp();
+  void tearDown();
+  
+  void test_attacks();
+  void test_initial();
+  void test_same_moves();
+  void test_pin();
+  void test_double_check();
+  void test_en_passant_pin();
+  void test_castling();
+};
+
+#endif // CHESSMOVEGENERATORTEST_H
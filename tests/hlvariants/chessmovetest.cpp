@@ -36,3 +36,18 @@ void ChessMoveTest::test_promotion() {
   CPPUNIT_ASSERT_EQUAL((int)ChessPiece::ROOK, m.promoteTo());
 }
 
+void ChessMoveTest::test_packed() {
+  CPPUNIT_ASSERT_EQUAL(4, (int)sizeof(ChessMove));
+  
+  ChessMove invalid;
+  CPPUNIT_ASSERT(!invalid.valid());
+  CPPUNIT_ASSERT(invalid.from() == Point::invalid());
+  CPPUNIT_ASSERT(invalid.to() == Point::invalid());
+  
+  // generators produce targets out of the board
+  ChessMove m(Point(0, 7), Point(-2, 8), ChessPiece::QUEEN);
+  CPPUNIT_ASSERT(m.from() == Point(0, 7));
+  CPPUNIT_ASSERT(m.to() == Point(-2, 8));
+  m.setType(ChessMove::PROMOTION);
+  CPPUNIT_ASSERT_EQUAL((int)ChessPiece::QUEEN, m.promoteTo());
+}
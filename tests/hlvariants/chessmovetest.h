@@ -21,6 +21,7 @@ class ChessMoveTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(test_capture_square);
   CPPUNIT_TEST(test_en_passant_trigger);
   CPPUNIT_TEST(test_promotion);
+  CPPUNIT_TEST(test_packed);
   CPPUNIT_TEST_SUITE_END();
 public:
   void setUp();
@@ -29,6 +30,7 @@ public:
   void test_capture_square();
   void test_en_passant_trigger();
   void test_promotion();
+  void test_packed();
 };
 
 #endif // CHESSMOVETEST_H
@@ -34,3 +34,20 @@ void ChessPieceTest::test_compare() {
   CPPUNIT_ASSERT(a == a);
 }
 
+void ChessPieceTest::test_packed() {
+  CPPUNIT_ASSERT_EQUAL(1, (int)sizeof(ChessPiece));
+  
+  ChessPiece invalid;
+  CPPUNIT_ASSERT_EQUAL(ChessPiece::INVALID_COLOR, invalid.color());
+  CPPUNIT_ASSERT_EQUAL(ChessPiece::INVALID_TYPE, invalid.type());
+  CPPUNIT_ASSERT_EQUAL(0, invalid.hashCode());
+  
+  for (int c = ChessPiece::WHITE; c <= ChessPiece::BLACK; c++) {
+    for (int t = ChessPiece::PAWN; t <= ChessPiece::KING; t++) {
+      ChessPiece p(static_cast<ChessPiece::Color>(c), static_cast<ChessPiece::Type>(t));
+      CPPUNIT_ASSERT_EQUAL(c, (int)p.color());
+      CPPUNIT_ASSERT_EQUAL(t, (int)p.type());
+      CPPUNIT_ASSERT(p != invalid);
+    }
+  }
+}
@@ -14,6 +14,7 @@ class ChessPieceTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(test_basic);
   CPPUNIT_TEST(test_names);
   CPPUNIT_TEST(test_compare);
+  CPPUNIT_TEST(test_packed);
   CPPUNIT_TEST_SUITE_END();
 public:
   void setUp();
@@ -22,6 +23,7 @@ public:
   void test_basic();
   void test_names();
   void test_compare();
+  void test_packed();
 };
 
 #endif // CHESSPIECETEST_H
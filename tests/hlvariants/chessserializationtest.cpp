@@ -19,10 +19,10 @@ void ChessSerializationTest::test_pawn() {
   ChessMove move(Point(4, 6), Point(4, 4));
   CPPUNIT_ASSERT(m_check->legal(move));
   
-  ChessSerializer san(ChessSerializer::COMPACT);
+  ChessSerializer san("compact");
   CPPUNIT_ASSERT_EQUAL(QString("e4"), san.serialize(move, *m_state));
     
-  ChessSerializer simple(ChessSerializer::SIMPLE);
+  ChessSerializer simple("simple");
   CPPUNIT_ASSERT_EQUAL(QString("e2e4"), simple.serialize(move, *m_state));
 }
 
@@ -34,13 +34,13 @@ void ChessSerializationTest::test_check() {
   ChessMove move(Point(3, 5), Point(4, 4));
   CPPUNIT_ASSERT(m_check->legal(move));
   
-  ChessSerializer san(ChessSerializer::COMPACT);
+  ChessSerializer san("compact");
   CPPUNIT_ASSERT_EQUAL(QString("Be4+"), san.serialize(move, *m_state));
   
-  ChessSerializer simple(ChessSerializer::SIMPLE);
+  ChessSerializer simple("simple");
   CPPUNIT_ASSERT_EQUAL(QString("d3e4"), simple.serialize(move, *m_state));
   
-  ChessSerializer dec(ChessSerializer::DECORATED);
+  ChessSerializer dec("decorated");
   CPPUNIT_ASSERT_EQUAL(QString("{bishop}e4+"), dec.serialize(move, *m_state));
 }
 
@@ -53,13 +53,13 @@ void ChessSerializationTest::test_check_capture() {
   ChessMove move(Point(3, 5), Point(4, 4));
   CPPUNIT_ASSERT(m_check->legal(move));
   
-  ChessSerializer san(ChessSerializer::COMPACT);
+  ChessSerializer san("compact");
   CPPUNIT_ASSERT_EQUAL(QString("Bxe4+"), san.serialize(move, *m_state));
   
-  ChessSerializer simple(ChessSerializer::SIMPLE);
+  ChessSerializer simple("simple");
   CPPUNIT_ASSERT_EQUAL(QString("d3e4"), simple.serialize(move, *m_state));
   
-  ChessSerializer dec(ChessSerializer::DECORATED);
+  ChessSerializer dec("decorated");
   CPPUNIT_ASSERT_EQUAL(QString("{bishop}xe4+"), dec.serialize(move, *m_state));
 }
 
@@ -71,13 +71,13 @@ void ChessSerializationTest::test_promotion() {
   ChessMove move(Point(7, 1), Point(7, 0), ChessPiece::ROOK);
   CPPUNIT_ASSERT(m_check->legal(move));
   
-  ChessSerializer san(ChessSerializer::COMPACT);
+  ChessSerializer san("compact");
   CPPUNIT_ASSERT_EQUAL(QString("h8=R"), san.serialize(move, *m_state));
   
-  ChessSerializer simple(ChessSerializer::SIMPLE);
+  ChessSerializer simple("simple");
   CPPUNIT_ASSERT_EQUAL(QString("h7h8=R"), simple.serialize(move, *m_state));
   
-  ChessSerializer dec(ChessSerializer::DECORATED);
+  ChessSerializer dec("decorated");
   CPPUNIT_ASSERT_EQUAL(QString("h8={rook}"), dec.serialize(move, *m_state));
 }
 
@@ -90,13 +90,13 @@ void ChessSerializationTest::test_promotion_capture() {
   ChessMove move(Point(7, 1), Point(6, 0), ChessPiece::ROOK);
   CPPUNIT_ASSERT(m_check->legal(move));
   
-  ChessSerializer san(ChessSerializer::COMPACT);
+  ChessSerializer san("compact");
   CPPUNIT_ASSERT_EQUAL(QString("hxg8=R"), san.serialize(move, *m_state));
   
-  ChessSerializer simple(ChessSerializer::SIMPLE);
+  ChessSerializer simple("simple");
   CPPUNIT_ASSERT_EQUAL(QString("h7g8=R"), simple.serialize(move, *m_state));
   
-  ChessSerializer dec(ChessSerializer::DECORATED);
+  ChessSerializer dec("decorated");
   CPPUNIT_ASSERT_EQUAL(QString("hxg8={rook}"), dec.serialize(move, *m_state));
 }
 
@@ -108,13 +108,13 @@ void ChessSerializationTest::test_promotion_check() {
   ChessMove move(Point(7, 1), Point(7, 0), ChessPiece::ROOK);
   CPPUNIT_ASSERT(m_check->legal(move));
   
-  ChessSerializer san(ChessSerializer::COMPACT);
+  ChessSerializer san("compact");
   CPPUNIT_ASSERT_EQUAL(QString("h8=R+"), san.serialize(move, *m_state));
   
-  ChessSerializer simple(ChessSerializer::SIMPLE);
+  ChessSerializer simple("simple");
   CPPUNIT_ASSERT_EQUAL(QString("h7h8=R"), simple.serialize(move, *m_state));
   
-  ChessSerializer dec(ChessSerializer::DECORATED);
+  ChessSerializer dec("decorated");
   CPPUNIT_ASSERT_EQUAL(QString("h8={rook}+"), dec.serialize(move, *m_state));
 }
 
@@ -127,13 +127,13 @@ void ChessSerializationTest::test_promotion_capture_check() {
   ChessMove move(Point(7, 1), Point(6, 0), ChessPiece::ROOK);
   CPPUNIT_ASSERT(m_check->legal(move));
   
-  ChessSerializer san(ChessSerializer::COMPACT);
+  ChessSerializer san("compact");
   CPPUNIT_ASSERT_EQUAL(QString("hxg8=R+"), san.serialize(move, *m_state));
   
-  ChessSerializer simple(ChessSerializer::SIMPLE);
+  ChessSerializer simple("simple");
   CPPUNIT_ASSERT_EQUAL(QString("h7g8=R"), simple.serialize(move, *m_state));
   
-  ChessSerializer dec(ChessSerializer::DECORATED);
+  ChessSerializer dec("decorated");
   CPPUNIT_ASSERT_EQUAL(QString("hxg8={rook}+"), dec.serialize(move, *m_state));
 }
 
@@ -146,13 +146,13 @@ void ChessSerializationTest::test_castling_k() {
   ChessMove move(Point(4, 7), Point(6, 7));
   CPPUNIT_ASSERT(m_check->legal(move));
   
-  ChessSerializer san(ChessSerializer::COMPACT);
+  ChessSerializer san("compact");
   CPPUNIT_ASSERT_EQUAL(QString("O-O"), san.serialize(move, *m_state));
   
-  ChessSerializer simple(ChessSerializer::SIMPLE);
+  ChessSerializer simple("simple");
   CPPUNIT_ASSERT_EQUAL(QString("e1g1"), simple.serialize(move, *m_state));
   
-  ChessSerializer dec(ChessSerializer::DECORATED);
+  ChessSerializer dec("decorated");
   CPPUNIT_ASSERT_EQUAL(QString("O-O"), dec.serialize(move, *m_state));
 }
 
@@ -166,29 +166,97 @@ void ChessSerializationTest::test_castling_q() {
   ChessMove move(Point(4, 7), Point(2, 7));
   CPPUNIT_ASSERT(m_check->legal(move));
   
-  ChessSerializer san(ChessSerializer::COMPACT);
+  ChessSerializer san("compact");
   CPPUNIT_ASSERT_EQUAL(QString("O-O-O"), san.serialize(move, *m_state));
   
-  ChessSerializer simple(ChessSerializer::SIMPLE);
+  ChessSerializer simple("simple");
   CPPUNIT_ASSERT_EQUAL(QString("e1c1"), simple.serialize(move, *m_state));
   
-  ChessSerializer dec(ChessSerializer::DECORATED);
+  ChessSerializer dec("decorated");
   CPPUNIT_ASSERT_EQUAL(QString("O-O-O"), dec.serialize(move, *m_state));
 }
 
+void ChessSerializationTest::test_games() {
+  // each move is read back from its notation, and written the same way
+  const char* games[][15] = {
+    { "d4", "d5", "Nf3", "Nf6", "Nbd2", "Nbd7", "e4", "dxe4", 
+      "Nxe4", "Nxe4", "Bd3", "Ndf6", "O-O", "e6", 0 },
+    { "e4", "e5", "Bc4", "Nc6", "Qh5", "Nf6", "Qxf7#", 0 }
+  };
+  
+  // moves are resolved the same way by testing them, and from a move list
+  ChessMoveList list;
+  ChessSerializer san("compact");
+  ChessSerializer listed("compact", &list);
+  for (unsigned int i = 0; i < sizeof(games) / sizeof(games[0]); i++) {
+    ChessGameState state;
+    state.setup();
+    ChessCheck check(state);
+    for (const char** str = games[i]; *str; str++) {
+      ChessMove move = san.deserialize(*str, state);
+      CPPUNIT_ASSERT(check.legal(move));
+      CPPUNIT_ASSERT(listed.deserialize(*str, state) == move);
+      CPPUNIT_ASSERT_EQUAL(QString(*str), san.serialize(move, state));
+      CPPUNIT_ASSERT_EQUAL(QString(*str), listed.serialize(move, state));
+      state.move(move);
+    }
+  }
+}
+
 void ChessSerializationTest::regression_knight_king() {
   m_state->setup();
   
   ChessMove move(Point(6, 7), Point(5, 5));
   CPPUNIT_ASSERT(m_check->legal(move));
 
-  ChessSerializer san(ChessSerializer::COMPACT);
+  ChessSerializer san("compact");
   CPPUNIT_ASSERT_EQUAL(QString("Nf3"), san.serialize(move, *m_state));
   
-  ChessSerializer simple(ChessSerializer::SIMPLE);
+  ChessSerializer simple("simple");
   CPPUNIT_ASSERT_EQUAL(QString("g1f3"), simple.serialize(move, *m_state));
   
-  ChessSerializer dec(ChessSerializer::DECORATED);
+  ChessSerializer dec("decorated");
   CPPUNIT_ASSERT_EQUAL(QString("{knight}f3"), dec.serialize(move, *m_state));
 }
 
+void ChessSerializationTest::regression_ics_verbose_promotion() {
+  m_state->board().set(Point(4, 7), ChessPiece(ChessPiece::BLACK, ChessPiece::KING));
+  m_state->board().set(Point(0, 0), ChessPiece(ChessPiece::WHITE, ChessPiece::KING));
+  m_state->board().set(Point(7, 1), ChessPiece(ChessPiece::WHITE, ChessPiece::PAWN));
+  m_state->board().set(Point(6, 0), ChessPiece(ChessPiece::BLACK, ChessPiece::BISHOP));
+  
+  ChessSerializer verbose("ics-verbose");
+  
+  ChessMove move = verbose.deserialize("P/h7-h8=R", *m_state);
+  CPPUNIT_ASSERT(move.from() == Point(7, 1));
+  CPPUNIT_ASSERT(move.to() == Point(7, 0));
+  CPPUNIT_ASSERT(m_check->legal(move));
+  CPPUNIT_ASSERT_EQUAL((int)ChessPiece::ROOK, move.promoteTo());
+  
+  move = verbose.deserialize("P/h7-g8=N", *m_state);
+  CPPUNIT_ASSERT(move.to() == Point(6, 0));
+  CPPUNIT_ASSERT(m_check->legal(move));
+  CPPUNIT_ASSERT_EQUAL((int)ChessPiece::KNIGHT, move.promoteTo());
+  
+  move = verbose.deserialize("K/a8-b8", *m_state);
+  CPPUNIT_ASSERT(m_check->legal(move));
+  CPPUNIT_ASSERT_EQUAL(-1, move.promoteTo());
+}
+
+void ChessSerializationTest::regression_out_of_range() {
+  m_state->setup();
+  
+  // squares too far away for a move must not wrap onto the board
+  ChessSerializer san("compact");
+  CPPUNIT_ASSERT(!san.deserialize("e40", *m_state).valid());
+  CPPUNIT_ASSERT(!san.deserialize("e100", *m_state).valid());
+  CPPUNIT_ASSERT(san.deserialize("e4", *m_state).valid());
+  
+  const char* moves[] = { "e4", "e5", "Ke2", "Ke7", 0 };
+  for (const char** str = moves; *str; str++)
+    m_state->move(san.deserialize(*str, *m_state));
+  CPPUNIT_ASSERT(!san.deserialize("Ke33", *m_state).valid());
+  CPPUNIT_ASSERT(san.deserialize("Ke1", *m_state).valid());
+  
+  CPPUNIT_ASSERT(!ChessMove(Point(4, 6), Point(4, -92)).valid());
+}
@@ -16,6 +16,7 @@ typedef VariantData<Chess>::GameState ChessGameState;
 typedef VariantData<Chess>::Serializer ChessSerializer;
 typedef VariantData<Chess>::Piece ChessPiece;
 typedef VariantData<Chess>::Move ChessMove;
+typedef HLVariant::MoveList<VariantData<Chess>::MoveGenerator> ChessMoveList;
 
 class ChessSerializationTest : public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(ChessSerializationTest);
@@ -28,8 +29,11 @@ class ChessSerializationTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(test_promotion_capture_check);
   CPPUNIT_TEST(test_castling_k);
   CPPUNIT_TEST(test_castling_q);
+  CPPUNIT_TEST(test_games);
   
   CPPUNIT_TEST(regression_knight_king);
+  CPPUNIT_TEST(regression_ics_verbose_promotion);
+  CPPUNIT_TEST(regression_out_of_range);
   CPPUNIT_TEST_SUITE_END();
 private:
   ChessGameState* m_state;
@@ -47,8 +51,11 @@ public:
   void test_promotion_capture_check();
   void test_castling_k();
   void test_castling_q();
+  void test_games();
   
   void regression_knight_king();
+  void regression_ics_verbose_promotion();
+  void regression_out_of_range();
 };
 
 #endif // CHESSSERIALIZATIONTEST_H
@@ -0,0 +1,102 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <QTime>
+
+#include "perft.h"
+#include "hlvariant/chess/variant.h"
+#include "hlvariant/crazyhouse/variant.h"
+#include "hlvariant/minichess5/variant.h"
+#include "hlvariant/shogi/variant.h"
+#include "hlvariant/minishogi/variant.h"
+#include "hlvariant/sho-shogi/variant.h"
+#include "hlvariant/tori-shogi/variant.h"
+
+using namespace HLVariant;
+
+// Known node counts from the initial position, indexed by depth - 1.
+// Chess, shogi and minishogi counts are the published ones, the others
+// are regression values for the rules implemented here.
+static const quint64 chessCounts[] = {
+  20, 400, 8902, 197281, 4865609 };
+static const quint64 crazyhouseCounts[] = {
+  20, 400, 8902, 197281, 4888832 };
+static const quint64 minichess5Counts[] = {
+  7, 53, 517, 4949, 55763, 622189 };
+static const quint64 shogiCounts[] = {
+  30, 900, 25470, 719731 };
+static const quint64 minishogiCounts[] = {
+  14, 181, 2512, 35401, 533203 };
+static const quint64 shoShogiCounts[] = {
+  26, 676, 17368, 445372 };
+static const quint64 toriShogiCounts[] = {
+  17, 288, 5445, 104381, 2208077 };
+
+/**
+  * Run perft on the initial position of @a Variant up to @a maxDepth,
+  * printing node counts and speed. Only the first @a knownDepth
+  * entries of @a counts are checked.
+  * \return The number of depths whose count does not match.
+  */
+template <typename Variant>
+int run(const char* name, const quint64* counts, int knownDepth, int maxDepth) {
+  typename Variant::GameState state;
+  state.setup();
+  
+  int failures = 0;
+  for (int depth = 1; depth <= maxDepth; depth++) {
+    QTime time;
+    time.start();
+    quint64 nodes = Perft<typename Variant::MoveGenerator>::count(state, depth);
+    int elapsed = time.elapsed();
+    
+    std::cout << name << " depth " << depth << ": " << nodes << " nodes, "
+              << elapsed << " ms";
+    if (elapsed > 0)
+      std::cout << ", " << nodes * 1000 / elapsed << " nodes/s";
+    
+    if (depth <= knownDepth && counts[depth - 1] != nodes) {
+      std::cout << " MISMATCH (expected " << counts[depth - 1] << ")";
+      failures++;
+    }
+    std::cout << std::endl;
+  }
+  
+  return failures;
+}
+
+int main(int argc, char** argv) {
+  const char* variant = argc > 1 ? argv[1] : "all";
+  int depth = argc > 2 ? atoi(argv[2]) : 4;
+  bool all = !strcmp(variant, "all");
+  
+  if (depth <= 0) {
+    std::cerr << "usage: " << argv[0] << " [variant|all] [depth]" << std::endl;
+    return 2;
+  }
+  
+  int failures = 0;
+  if (all || !strcmp(variant, "chess"))
+    failures += run<Chess::Variant>("chess", chessCounts,
+      sizeof(chessCounts) / sizeof(quint64), depth);
+  if (all || !strcmp(variant, "crazyhouse"))
+    failures += run<Crazyhouse::Variant>("crazyhouse", crazyhouseCounts,
+      sizeof(crazyhouseCounts) / sizeof(quint64), depth);
+  if (all || !strcmp(variant, "minichess5"))
+    failures += run<Minichess5::Variant>("minichess5", minichess5Counts,
+      sizeof(minichess5Counts) / sizeof(quint64), depth);
+  if (all || !strcmp(variant, "shogi"))
+    failures += run<Shogi::Variant>("shogi", shogiCounts,
+      sizeof(shogiCounts) / sizeof(quint64), depth);
+  if (all || !strcmp(variant, "minishogi"))
+    failures += run<MiniShogi::Variant>("minishogi", minishogiCounts,
+      sizeof(minishogiCounts) / sizeof(quint64), depth);
+  if (all || !strcmp(variant, "sho-shogi"))
+    failures += run<ShoShogi::Variant>("sho-shogi", shoShogiCounts,
+      sizeof(shoShogiCounts) / sizeof(quint64), depth);
+  if (all || !strcmp(variant, "tori-shogi"))
+    failures += run<ToriShogi::Variant>("tori-shogi", toriShogiCounts,
+      sizeof(toriShogiCounts) / sizeof(quint64), depth);
+  
+  return failures == 0 ? 0 : 1;
+}
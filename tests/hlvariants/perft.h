@@ -0,0 +1,48 @@
+#ifndef PERFT_H
+#define PERFT_H
+
+#include <vector>
+#include <QtGlobal>
+
+/**
+  * Count the leaf nodes of the legal move tree of a game state,
+  * playing and taking back moves in place.
+  */
+template <typename MoveGenerator>
+class Perft {
+  typedef typename MoveGenerator::GameState GameState;
+  typedef typename MoveGenerator::Move Move;
+
+  class CollectMoves : public MoveGenerator::MoveCallback {
+  public:
+    std::vector<Move> moves;
+
+    virtual bool operator()(const Move& m) {
+      moves.push_back(m);
+      return true;
+    }
+  };
+public:
+  static quint64 count(GameState& state, int depth) {
+    if (depth <= 0)
+      return 1;
+
+    CollectMoves collect;
+    MoveGenerator(state).generate(collect);
+    if (depth == 1)
+      return collect.moves.size();
+
+    quint64 res = 0;
+    for (unsigned int i = 0; i < collect.moves.size(); i++) {
+      const Move& move = collect.moves[i];
+      typename GameState::UndoInfo undo = state.undoInfo(move);
+      state.move(move);
+      res += count(state, depth - 1);
+      state.unmove(move, undo);
+    }
+
+    return res;
+  }
+};
+
+#endif // PERFT_H
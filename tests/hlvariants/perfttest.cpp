@@ -0,0 +1,89 @@
+#include "perfttest.h"
+#include "perft.h"
+
+#include "hlvariant/chess/variant.h"
+#include "hlvariant/crazyhouse/variant.h"
+#include "hlvariant/minichess5/variant.h"
+#include "hlvariant/shogi/variant.h"
+#include "hlvariant/minishogi/variant.h"
+#include "hlvariant/sho-shogi/variant.h"
+#include "hlvariant/tori-shogi/variant.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PerftTest);
+
+using namespace HLVariant;
+
+namespace {
+
+template <typename Variant>
+quint64 perft(int depth) {
+  typename Variant::GameState state;
+  state.setup();
+  return Perft<typename Variant::MoveGenerator>::count(state, depth);
+}
+
+}
+
+void PerftTest::setUp() { }
+
+void PerftTest::tearDown() { }
+
+void PerftTest::test_chess() {
+  CPPUNIT_ASSERT_EQUAL(Q_UINT64_C(20), perft<Chess::Variant>(1));
+  CPPUNIT_ASSERT_EQUAL(Q_UINT64_C(400), perft<Chess::Variant>(2));
+  CPPUNIT_ASSERT_EQUAL(Q_UINT64_C(8902), perft<Chess::Variant>(3));
+}
+
+void PerftTest::test_crazyhouse() {
+  // no captures, hence no drops, in the first three plies
+  CPPUNIT_ASSERT_EQUAL(Q_UINT64_C(8902), perft<Crazyhouse::Variant>(3));
+}
+
+void PerftTest::test_minichess5() {
+  CPPUNIT_ASSERT_EQUAL(Q_UINT64_C(7), perft<Minichess5::Variant>(1));
+  CPPUNIT_ASSERT_EQUAL(Q_UINT64_C(517), perft<Minichess5::Variant>(3));
+}
+
+void PerftTest::test_shogi() {
+  CPPUNIT_ASSERT_EQUAL(Q_UINT64_C(30), perft<Shogi::Variant>(1));
+  CPPUNIT_ASSERT_EQUAL(Q_UINT64_C(900), perft<Shogi::Variant>(2));
+  CPPUNIT_ASSERT_EQUAL(Q_UINT64_C(25470), perft<Shogi::Variant>(3));
+}
+
+void PerftTest::test_minishogi() {
+  CPPUNIT_ASSERT_EQUAL(Q_UINT64_C(14), perft<MiniShogi::Variant>(1));
+  CPPUNIT_ASSERT_EQUAL(Q_UINT64_C(181), perft<MiniShogi::Variant>(2));
+  CPPUNIT_ASSERT_EQUAL(Q_UINT64_C(2512), perft<MiniShogi::Variant>(3));
+  CPPUNIT_ASSERT_EQUAL(Q_UINT64_C(35401), perft<MiniShogi::Variant>(4));
+}
+
+void PerftTest::test_sho_shogi() {
+  CPPUNIT_ASSERT_EQUAL(Q_UINT64_C(26), perft<ShoShogi::Variant>(1));
+  CPPUNIT_ASSERT_EQUAL(Q_UINT64_C(17368), perft<ShoShogi::Variant>(3));
+}
+
+void PerftTest::test_tori_shogi() {
+  CPPUNIT_ASSERT_EQUAL(Q_UINT64_C(17), perft<ToriShogi::Variant>(1));
+  CPPUNIT_ASSERT_EQUAL(Q_UINT64_C(5445), perft<ToriShogi::Variant>(3));
+}
+
+void PerftTest::test_forced_promotion() {
+  typedef MiniShogi::Variant::GameState GameState;
+  typedef GameState::Move Move;
+  typedef GameState::Board::Piece Piece;
+  
+  GameState state;
+  state.board().set(Point(2, 4), Piece(Piece::BLACK, Piece::KING));
+  state.board().set(Point(0, 0), Piece(Piece::WHITE, Piece::KING));
+  state.board().set(Point(3, 1), Piece(Piece::BLACK, Piece::PAWN));
+  
+  // a pawn on the last rank could not move any more
+  Move move(Point(3, 1), Point(3, 0));
+  MiniShogi::Variant::LegalityCheck check(state);
+  CPPUNIT_ASSERT(check.legal(move));
+  CPPUNIT_ASSERT(move.promoteTo() != -1);
+  
+  // the pawn move is generated only once
+  CPPUNIT_ASSERT_EQUAL(Q_UINT64_C(1 + 5), 
+    Perft<MiniShogi::Variant::MoveGenerator>::count(state, 1));
+}
@@ -0,0 +1,35 @@
+#ifndef PERFTTEST_H
+#define PERFTTEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+
+class PerftTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(PerftTest);
+  CPPUNIT_TEST(test_chess);
+  CPPUNIT_TEST(test_crazyhouse);
+  CPPUNIT_TEST(test_minichess5);
+  CPPUNIT_TEST(test_shogi);
+  CPPUNIT_TEST(test_minishogi);
+  CPPUNIT_TEST(test_sho_shogi);
+  CPPUNIT_TEST(test_tori_shogi);
+  CPPUNIT_TEST(test_forced_promotion);
+  CPPUNIT_TEST_SUITE_END();
+public:
+  void setUp();
+  void tearDown();
+  
+  void test_chess();
+  void test_crazyhouse();
+  void test_minichess5();
+  void test_shogi();
+  void test_minishogi();
+  void test_sho_shogi();
+  void test_tori_shogi();
+  void test_forced_promotion();
+};
+
+#endif // PERFTTEST_H
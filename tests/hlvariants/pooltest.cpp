@@ -102,3 +102,22 @@ void PoolTest::test_collection_equality() {
   CPPUNIT_ASSERT((*m_pools) == other);
 }
 
+void PoolTest::test_hash() {
+  CPPUNIT_ASSERT_EQUAL(quint64(0), m_pools->hash());
+  
+  m_pools->pool(ChessPiece::WHITE).add(ChessPiece::ROOK);
+  quint64 oneRook = m_pools->hash();
+  m_pools->pool(ChessPiece::WHITE).add(ChessPiece::ROOK);
+  CPPUNIT_ASSERT(m_pools->hash() != oneRook);
+  
+  m_pools->pool(ChessPiece::WHITE).remove(ChessPiece::ROOK);
+  CPPUNIT_ASSERT_EQUAL(oneRook, m_pools->hash());
+  
+  // the same piece in the other pool
+  ChessPoolCollection other;
+  other.pool(ChessPiece::BLACK).add(ChessPiece::ROOK);
+  CPPUNIT_ASSERT(other.hash() != oneRook);
+  
+  m_pools->pool(ChessPiece::WHITE).remove(ChessPiece::ROOK);
+  CPPUNIT_ASSERT_EQUAL(quint64(0), m_pools->hash());
+}
@@ -29,6 +29,7 @@ class PoolTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(test_empty_remove);
   CPPUNIT_TEST(test_pool_equality);
   CPPUNIT_TEST(test_collection_equality);
+  CPPUNIT_TEST(test_hash);
   CPPUNIT_TEST_SUITE_END();
 private:
   ChessPoolCollection* m_pools;
@@ -44,6 +45,7 @@ public:
   void test_empty_remove();
   void test_pool_equality();
   void test_collection_equality();
+  void test_hash();
 };
 
 #endif // POOLTEST_H
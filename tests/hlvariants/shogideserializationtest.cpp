@@ -10,8 +10,34 @@ void ShogiDeserializationTest::tearDown() {
   delete m_state;
 }
 
+void ShogiDeserializationTest::test_game() {
+  // each move is read back from its notation, and written the same way
+  const char* game[] = {
+    "P-7f", "P-3d", "G6i-5h", "G4a-5b", "Bx2b+", "Sx2b",
+    "B*5e", "P-1d", "Bx2b+", "P-9d", "S*3c", 0
+  };
+  
+  // moves are resolved the same way by testing them, and from the move
+  // list, which serializers use when someone has generated it
+  ShogiMoveList list;
+  ShogiSerializer s("compact");
+  ShogiSerializer listed("compact", &list);
+  m_state->setup();
+  for (const char** str = game; *str; str++) {
+    ShogiMove m = s.deserialize(*str, *m_state);
+    ShogiCheck check(*m_state);
+    CPPUNIT_ASSERT(check.legal(m));
+    CPPUNIT_ASSERT(!list.find(*m_state));
+    list.moves(*m_state);
+    CPPUNIT_ASSERT(listed.deserialize(*str, *m_state) == m);
+    CPPUNIT_ASSERT_EQUAL(QString(*str), s.serialize(m, *m_state));
+    CPPUNIT_ASSERT_EQUAL(QString(*str), listed.serialize(m, *m_state));
+    m_state->move(m);
+  }
+}
+
 void ShogiDeserializationTest::regression_P_drop_2c() {
-  ShogiSerializer s(ShogiSerializer::SIMPLE);
+  ShogiSerializer s("simple");
   
   m_state->pools().pool(ShogiPiece::BLACK).add(ShogiPiece::PAWN);
   
@@ -28,3 +54,18 @@ void ShogiDeserializationTest::regression_P_drop_2c() {
   CPPUNIT_ASSERT(m.to() == Point(7, 2));  
 }
 
+void ShogiDeserializationTest::regression_P_7f() {
+  ShogiSerializer s("simple");
+  
+  m_state->setup();
+  
+  // a single square is the destination
+  ShogiMove m = s.deserialize("P7f", *m_state);
+  CPPUNIT_ASSERT(m.from() == Point(2, 6));
+  CPPUNIT_ASSERT(m.to() == Point(2, 5));
+  
+  m_state->move(m);
+  m = s.deserialize("P3d", *m_state);
+  CPPUNIT_ASSERT(m.from() == Point(6, 2));
+  CPPUNIT_ASSERT(m.to() == Point(6, 3));
+}
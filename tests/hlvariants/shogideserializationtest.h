@@ -13,13 +13,17 @@
 using namespace HLVariant;
 
 typedef VariantData<Shogi::Variant>::GameState ShogiGameState;
+typedef VariantData<Shogi::Variant>::LegalityCheck ShogiCheck;
 typedef VariantData<Shogi::Variant>::Serializer ShogiSerializer;
 typedef VariantData<Shogi::Variant>::Piece ShogiPiece;
 typedef VariantData<Shogi::Variant>::Move ShogiMove;
+typedef MoveList<VariantData<Shogi::Variant>::MoveGenerator> ShogiMoveList;
 
 class ShogiDeserializationTest : public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(ShogiDeserializationTest);
+  CPPUNIT_TEST(test_game);
   CPPUNIT_TEST(regression_P_drop_2c);
+  CPPUNIT_TEST(regression_P_7f);
   CPPUNIT_TEST_SUITE_END();
 private:
   ShogiGameState* m_state;
@@ -27,7 +31,9 @@ public:
   void setUp();
   void tearDown();
   
+  void test_game();
   void regression_P_drop_2c();
+  void regression_P_7f();
 };
 
 #endif // SHOGIDESERIALIZATIONTEST_H
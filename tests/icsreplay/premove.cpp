@@ -0,0 +1,74 @@
+#include <iostream>
+#include <QCoreApplication>
+#include <QDir>
+#include <KComponentData>
+
+#include "icsconnection.h"
+#include "premove.h"
+#include "replaydevice.h"
+#include "usermove.h"
+#include "variants.h"
+
+/**
+  * Play @a log back into @a connection.
+  * \return The text sent by the connection while replaying.
+  */
+static QByteArray replay(QCoreApplication& app, ICSConnection& connection,
+                         const QString& log) {
+  ReplayDevice* device = new ReplayDevice(ReplayDevice::MaximumSpeed);
+  if (!device->load(log)) {
+    delete device;
+    std::cerr << "cannot load " << log.toLocal8Bit().constData() << std::endl;
+    return QByteArray();
+  }
+  // the connection keeps its games when switching device
+  connection.establish(device);
+  QObject::connect(device, SIGNAL(replayFinished()), &app, SLOT(quit()));
+  device->start();
+  app.exec();
+  return device->sent();
+}
+
+/**
+  * Start game 7 as white, play 1. e4 and premove 2. d4, then replay
+  * @a log, which continues the game.
+  * \return Whether the premove was sent to the server.
+  */
+static bool sendsPremove(QCoreApplication& app, const QDir& dir, const char* log) {
+  ICSConnection connection;
+  replay(app, connection, dir.filePath("premove_game.log"));
+
+  VariantPtr variant = Variants::instance().get("Chess");
+  AbstractMove::Ptr d4 = variant->createNormalMove(
+    NormalUserMove(Point(3, 6), Point(3, 4)));
+  connection.setPremove(7, boost::shared_ptr<Premove>(new Premove(d4)));
+
+  return replay(app, connection, dir.filePath(log)).contains("d2d4");
+}
+
+/**
+  * Check that a premove is sent as soon as the opponent replies, and
+  * that it is dropped when the move it answers is taken back.
+  */
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::cerr << "usage: " << argv[0] << " LOGDIR" << std::endl;
+    return 2;
+  }
+
+  KComponentData data("tagua");
+  QCoreApplication app(argc, argv);
+  QDir dir(QFile::decodeName(argv[1]));
+
+  int failures = 0;
+  if (!sendsPremove(app, dir, "premove_reply.log")) {
+    std::cout << "premove not sent after the opponent's move" << std::endl;
+    failures++;
+  }
+  if (sendsPremove(app, dir, "premove_takeback.log")) {
+    std::cout << "premove sent after a takeback" << std::endl;
+    failures++;
+  }
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,108 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <QCoreApplication>
+#include <QFile>
+#include <QTime>
+#include <KComponentData>
+
+#include "icsconnection.h"
+#include "latency.h"
+#include "replaydevice.h"
+
+/**
+  * Count the lines received from the server in a connection log.
+  */
+static int countLines(const char* file_name) {
+  QFile file(file_name);
+  if (!file.open(QIODevice::ReadOnly))
+    return 0;
+
+  int res = 0;
+  while (!file.atEnd()) {
+    if (file.readLine().startsWith("< "))
+      res++;
+  }
+  return res;
+}
+
+static int usage(const char* name) {
+  std::cerr << "usage: " << name << " [--recorded] [--max-latency USECS] LOG [repeat]" << std::endl;
+  return 2;
+}
+
+/**
+  * Play a recorded server log back into an ICS connection, as if it
+  * came from the server, and print how fast it is handled.
+  * With --max-latency, fail if the 99th percentile of any stage is
+  * above the given number of microseconds.
+  */
+int main(int argc, char** argv) {
+  ReplayDevice::Speed speed = ReplayDevice::MaximumSpeed;
+  qint64 max_latency = -1;
+  int i = 1;
+  for (; i < argc && argv[i][0] == '-'; i++) {
+    if (!strcmp(argv[i], "--recorded"))
+      speed = ReplayDevice::RecordedSpeed;
+    else if (!strcmp(argv[i], "--max-latency") && i + 1 < argc)
+      max_latency = atoi(argv[++i]);
+    else
+      return usage(argv[0]);
+  }
+  if (i >= argc)
+    return usage(argv[0]);
+  const char* log = argv[i];
+  int repeat = i + 1 < argc ? atoi(argv[i + 1]) : 100;
+  if (repeat <= 0)
+    return usage(argv[0]);
+
+  KComponentData data("tagua");
+  QCoreApplication app(argc, argv);
+
+  int lines = countLines(log);
+  if (lines == 0) {
+    std::cerr << "no received lines in " << log << std::endl;
+    return 1;
+  }
+
+  QTime time;
+  time.start();
+  for (int r = 0; r < repeat; r++) {
+    // a fresh connection for each pass, so that games start over
+    ICSConnection connection;
+    ReplayDevice* device = new ReplayDevice(speed);
+    if (!device->load(log)) {
+      delete device;
+      return 1;
+    }
+    connection.establish(device);
+    QObject::connect(device, SIGNAL(replayFinished()), &app, SLOT(quit()));
+    device->start();
+    app.exec();
+  }
+  int elapsed = time.elapsed();
+
+  qint64 total = qint64(lines) * repeat;
+  std::cout << total << " lines, " << elapsed << " ms";
+  if (elapsed > 0)
+    std::cout << ", " << total * 1000 / elapsed << " lines/s";
+  std::cout << std::endl;
+
+  const Latency& latency = Latency::instance();
+  std::cout << latency.report().toLocal8Bit().constData();
+
+  int failures = 0;
+  if (max_latency >= 0) {
+    for (int s = 0; s < Latency::StageCount; s++) {
+      Latency::Stage stage = static_cast<Latency::Stage>(s);
+      qint64 p99 = latency.histogram(stage).quantile(0.99);
+      if (p99 > max_latency) {
+        std::cout << Latency::stageName(stage) << ": p99 " << p99
+                  << " us is above " << max_latency << " us" << std::endl;
+        failures++;
+      }
+    }
+  }
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,59 @@
+#include <cstdlib>
+#include <iostream>
+#include <QThread>
+#include <QTime>
+
+#include "pgndatabase.h"
+#include "pgnimport.h"
+
+/**
+  * Import all games of a PGN file with @a threads workers,
+  * printing the speed and the number of games for each status.
+  * \return Whether all games could be imported.
+  */
+bool run(const PGNDatabase& db, int threads) {
+  PGNImport import(db);
+
+  QTime time;
+  time.start();
+  import.run(threads);
+  int elapsed = time.elapsed();
+
+  std::cout << threads << " threads: " << db.size() << " games in "
+            << elapsed << " ms";
+  if (elapsed > 0)
+    std::cout << ", " << qint64(db.size()) * 1000 / elapsed << " games/s";
+  std::cout << std::endl;
+
+  std::cout << "  imported: " << import.count(PGNImport::Imported)
+            << ", parse errors: " << import.count(PGNImport::ParseError)
+            << ", unknown variants: " << import.count(PGNImport::UnknownVariant)
+            << ", illegal moves: " << import.count(PGNImport::IllegalMove)
+            << std::endl;
+
+  return import.count(PGNImport::Imported) == db.size();
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::cerr << "usage: " << argv[0] << " file.pgn [threads]" << std::endl;
+    return 2;
+  }
+
+  PGNDatabase db(argv[1]);
+  if (!db.open()) {
+    std::cerr << "cannot open " << argv[1] << std::endl;
+    return 2;
+  }
+
+  bool ok;
+  if (argc > 2)
+    ok = run(db, atoi(argv[2]));
+  else {
+    // compare with a sequential import
+    ok = run(db, 1);
+    run(db, QThread::idealThreadCount());
+  }
+
+  return ok ? 0 : 1;
+}
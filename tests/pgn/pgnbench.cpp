@@ -0,0 +1,70 @@
+#include <cstdlib>
+#include <iostream>
+#include <QTime>
+
+#include "pgndatabase.h"
+#include "pgnparser.h"
+
+/**
+  * Parse every game of @a filename @a repeat times, printing the speed.
+  * \return Whether all games could be parsed.
+  */
+bool run(const char* filename, int repeat) {
+  PGNDatabase db(filename);
+  if (!db.open()) {
+    std::cerr << "cannot open " << filename << std::endl;
+    return false;
+  }
+
+  // decode games beforehand, only parsing is measured
+  std::vector<QString> games;
+  qint64 bytes = 0;
+  for (int i = 0; i < db.size(); i++) {
+    games.push_back(db.text(i));
+    bytes += db.entry(i).length;
+  }
+
+  bool ok = true;
+  quint64 entries = 0;
+  QTime time;
+  time.start();
+  for (int k = 0; k < repeat; k++) {
+    for (unsigned int i = 0; i < games.size(); i++) {
+      PGN pgn(games[i]);
+      ok = ok && pgn.valid();
+      entries += pgn.size();
+    }
+  }
+  int elapsed = time.elapsed();
+
+  std::cout << filename << ": " << games.size() << " games, "
+            << entries / repeat << " entries, "
+            << repeat << " runs in " << elapsed << " ms";
+  if (elapsed > 0)
+    std::cout << ", " << bytes * repeat / 1024 * 1000 / elapsed << " KB/s";
+  if (!ok)
+    std::cout << " PARSE ERROR";
+  std::cout << std::endl;
+
+  return ok;
+}
+
+int main(int argc, char** argv) {
+  int repeat = argc > 1 ? atoi(argv[1]) : 1000;
+  if (repeat <= 0) {
+    std::cerr << "usage: " << argv[0] << " [repeat] [file.pgn...]" << std::endl;
+    return 2;
+  }
+
+  bool ok = true;
+  if (argc > 2) {
+    for (int i = 2; i < argc; i++)
+      ok = run(argv[i], repeat) && ok;
+  }
+  else {
+    ok = run(PGN_DIR "/kovacevic_keene_1973.pgn", repeat) && ok;
+    ok = run(PGN_DIR "/test_pgn.pgn", repeat) && ok;
+  }
+
+  return ok ? 0 : 1;
+}
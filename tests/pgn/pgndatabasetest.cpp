@@ -0,0 +1,127 @@
+#include "pgndatabasetest.h"
+#include <cstdlib>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include "pgndatabase.h"
+#include "pgnparser.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PGNDatabaseTest);
+
+void PGNDatabaseTest::setUp() {
+  QFile::remove("tmp.idx");
+}
+
+void PGNDatabaseTest::tearDown() {
+  QFile::remove("tmp.idx");
+}
+
+void PGNDatabaseTest::test_single() {
+  PGNDatabase db(PGN_DIR "/kovacevic_keene_1973.pgn");
+  CPPUNIT_ASSERT(db.open());
+  CPPUNIT_ASSERT_EQUAL(1, db.size());
+
+  const PGNDatabase::Entry& e = db.entry(0);
+  CPPUNIT_ASSERT(e.offset == 0);
+  CPPUNIT_ASSERT(e.white == "Keene Raymond D");
+  CPPUNIT_ASSERT(e.black == "Kovacevic Vladimir");
+  CPPUNIT_ASSERT(e.event == "It");
+  CPPUNIT_ASSERT(e.date == "1973.??.??");
+  CPPUNIT_ASSERT(e.result == "1-0");
+  CPPUNIT_ASSERT(e.eco == "A06");
+}
+
+void PGNDatabaseTest::test_boundaries() {
+  PGNDatabase db(PGN_DIR "/test_pgn.pgn");
+  CPPUNIT_ASSERT(db.open());
+  CPPUNIT_ASSERT_EQUAL(13, db.size());
+
+  // every game starts with its tags, and games follow each other
+  for (int i = 0; i < db.size(); i++) {
+    CPPUNIT_ASSERT(db.text(i).startsWith("["));
+    if (i > 0)
+      CPPUNIT_ASSERT(db.entry(i).offset >= db.entry(i - 1).offset + db.entry(i - 1).length);
+  }
+}
+
+void PGNDatabaseTest::test_tags() {
+  PGNDatabase db(PGN_DIR "/test_pgn.pgn");
+  CPPUNIT_ASSERT(db.open());
+
+  CPPUNIT_ASSERT(db.entry(0).white == "White player");
+  CPPUNIT_ASSERT(db.entry(0).result == "*");
+  CPPUNIT_ASSERT(db.entry(0).eco == "C30");
+  CPPUNIT_ASSERT(db.entry(1).white == "Maurizio");
+  CPPUNIT_ASSERT(db.entry(1).black == "Rattatechess");
+  CPPUNIT_ASSERT(db.entry(4).event == "Convergence");
+  CPPUNIT_ASSERT(db.entry(9).event == "dfasdfadf ][] \"\"\" neally nasty tag");
+  CPPUNIT_ASSERT(db.entry(12).date == "2006.10.07");
+}
+
+void PGNDatabaseTest::test_text() {
+  PGNDatabase db(PGN_DIR "/test_pgn.pgn");
+  CPPUNIT_ASSERT(db.open());
+
+  boost::shared_ptr<PGN> game = db.game(6);
+  CPPUNIT_ASSERT(game->valid());
+  CPPUNIT_ASSERT(game->m_tags["Event"] == "Lo stesso bachetto");
+  CPPUNIT_ASSERT_EQUAL(9u, game->size());
+
+  game = db.game(12);
+  CPPUNIT_ASSERT(game->valid());
+  CPPUNIT_ASSERT(game->m_tags["Variant"] == "crazyhouse");
+}
+
+void PGNDatabaseTest::test_index() {
+  PGNDatabase db(PGN_DIR "/test_pgn.pgn", "tmp.idx");
+  CPPUNIT_ASSERT(db.open());
+  CPPUNIT_ASSERT(QFile::exists("tmp.idx"));
+
+  PGNDatabase cached(PGN_DIR "/test_pgn.pgn", "tmp.idx");
+  CPPUNIT_ASSERT(cached.open());
+  CPPUNIT_ASSERT_EQUAL(db.size(), cached.size());
+  for (int i = 0; i < db.size(); i++) {
+    CPPUNIT_ASSERT(db.entry(i).offset == cached.entry(i).offset);
+    CPPUNIT_ASSERT(db.entry(i).length == cached.entry(i).length);
+    CPPUNIT_ASSERT(db.entry(i).event == cached.entry(i).event);
+    CPPUNIT_ASSERT(db.text(i) == cached.text(i));
+  }
+
+  // an index of another file is not used
+  PGNDatabase other(PGN_DIR "/kovacevic_keene_1973.pgn", "tmp.idx");
+  CPPUNIT_ASSERT(other.open());
+  CPPUNIT_ASSERT_EQUAL(1, other.size());
+}
+
+void PGNDatabaseTest::test_corrupt_index() {
+  {
+    PGNDatabase db(PGN_DIR "/test_pgn.pgn", "tmp.idx");
+    CPPUNIT_ASSERT(db.open());
+  }
+
+  // claim many more games than there are, and cut the index after the count
+  QFile file("tmp.idx");
+  CPPUNIT_ASSERT(file.open(QIODevice::ReadWrite));
+  QDataStream stream(&file);
+  quint32 magic, version;
+  QString filename;
+  qint64 size;
+  QDateTime modified;
+  stream >> magic >> version >> filename >> size >> modified;
+  qint64 pos = file.pos();
+  CPPUNIT_ASSERT(file.resize(pos));
+  CPPUNIT_ASSERT(file.seek(pos));
+  stream << quint32(0xfffffff0);
+  file.close();
+
+  // the index is ignored, and the file scanned again
+  PGNDatabase db(PGN_DIR "/test_pgn.pgn", "tmp.idx");
+  CPPUNIT_ASSERT(db.open());
+  CPPUNIT_ASSERT_EQUAL(13, db.size());
+}
+
+void PGNDatabaseTest::test_missing() {
+  PGNDatabase db(PGN_DIR "/missing.pgn");
+  CPPUNIT_ASSERT(!db.open());
+  CPPUNIT_ASSERT_EQUAL(0, db.size());
+}
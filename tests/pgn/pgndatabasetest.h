@@ -0,0 +1,33 @@
+#ifndef PGNDATABASETEST_H
+#define PGNDATABASETEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+
+class PGNDatabaseTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(PGNDatabaseTest);
+  CPPUNIT_TEST(test_single);
+  CPPUNIT_TEST(test_boundaries);
+  CPPUNIT_TEST(test_tags);
+  CPPUNIT_TEST(test_text);
+  CPPUNIT_TEST(test_index);
+  CPPUNIT_TEST(test_corrupt_index);
+  CPPUNIT_TEST(test_missing);
+  CPPUNIT_TEST_SUITE_END();
+public:
+  void setUp();
+  void tearDown();
+
+  void test_single();
+  void test_boundaries();
+  void test_tags();
+  void test_text();
+  void test_index();
+  void test_corrupt_index();
+  void test_missing();
+};
+
+#endif // PGNDATABASETEST_H
@@ -0,0 +1,75 @@
+#include "pgnparsertest.h"
+#include "pgnparser.h"
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PGNParserTest);
+
+static const PGN::Move* move(const PGN& pgn, int index) {
+  return boost::get<PGN::Move>(pgn[index]);
+}
+
+static const QString* comment(const PGN& pgn, int index) {
+  return boost::get<QString>(pgn[index]);
+}
+
+void PGNParserTest::test_tags() {
+  PGN pgn("[White \"Keene Raymond D\"]\n[Event \"a \\\"quoted\\\" name\"]\n1. e4");
+  CPPUNIT_ASSERT(pgn.valid());
+  CPPUNIT_ASSERT(pgn.m_tags["White"] == "Keene Raymond D");
+  CPPUNIT_ASSERT(pgn.m_tags["Event"] == "a \"quoted\" name");
+  CPPUNIT_ASSERT_EQUAL(1u, pgn.size());
+}
+
+void PGNParserTest::test_numbers() {
+  PGN pgn("1. e4 e5 2.Nf3 7...Be7 8. ... O-O 9 0-0-0");
+  CPPUNIT_ASSERT(pgn.valid());
+  CPPUNIT_ASSERT_EQUAL(6u, pgn.size());
+  CPPUNIT_ASSERT_EQUAL(2, move(pgn, 0)->m_number);
+  CPPUNIT_ASSERT(move(pgn, 0)->m_move == "e4");
+  CPPUNIT_ASSERT_EQUAL(0, move(pgn, 1)->m_number);
+  CPPUNIT_ASSERT_EQUAL(4, move(pgn, 2)->m_number);
+  CPPUNIT_ASSERT(move(pgn, 2)->m_move == "Nf3");
+  CPPUNIT_ASSERT_EQUAL(15, move(pgn, 3)->m_number);
+  CPPUNIT_ASSERT_EQUAL(17, move(pgn, 4)->m_number);
+  CPPUNIT_ASSERT_EQUAL(18, move(pgn, 5)->m_number);
+  CPPUNIT_ASSERT(move(pgn, 5)->m_move == "0-0-0");
+}
+
+void PGNParserTest::test_variations() {
+  PGN pgn("1. e4 (1. d4 d5 (1... Nf6)) e5");
+  CPPUNIT_ASSERT(pgn.valid());
+  CPPUNIT_ASSERT_EQUAL(9u, pgn.size());
+  CPPUNIT_ASSERT(boost::get<PGN::BeginVariation>(pgn[1]));
+  CPPUNIT_ASSERT(boost::get<PGN::BeginVariation>(pgn[4]));
+  CPPUNIT_ASSERT_EQUAL(3, move(pgn, 5)->m_number);
+  CPPUNIT_ASSERT(boost::get<PGN::EndVariation>(pgn[6]));
+  CPPUNIT_ASSERT(boost::get<PGN::EndVariation>(pgn[7]));
+  CPPUNIT_ASSERT(move(pgn, 8)->m_move == "e5");
+}
+
+void PGNParserTest::test_comments() {
+  PGN pgn("1. e4 {A good\nmove,\r\n the best} e5 ; ignored {\n2. Nf3");
+  CPPUNIT_ASSERT(pgn.valid());
+  CPPUNIT_ASSERT_EQUAL(4u, pgn.size());
+  CPPUNIT_ASSERT(*comment(pgn, 1) == "A good move, the best");
+  CPPUNIT_ASSERT(move(pgn, 2)->m_move == "e5");
+  CPPUNIT_ASSERT(move(pgn, 3)->m_move == "Nf3");
+}
+
+void PGNParserTest::test_annotations() {
+  PGN pgn("1. e4 $1 e5 (0:01.5) 2. Nf3 $14");
+  CPPUNIT_ASSERT(pgn.valid());
+  CPPUNIT_ASSERT_EQUAL(3u, pgn.size());
+  CPPUNIT_ASSERT(move(pgn, 1)->m_move == "e5");
+  CPPUNIT_ASSERT(move(pgn, 2)->m_move == "Nf3");
+}
+
+void PGNParserTest::test_result() {
+  PGN pgn("1. e4 e5 1/2-1/2 2. Nf3");
+  CPPUNIT_ASSERT(pgn.valid());
+  CPPUNIT_ASSERT_EQUAL(2u, pgn.size());
+}
+
+void PGNParserTest::test_error() {
+  CPPUNIT_ASSERT(!PGN("1. e4 {unterminated").valid());
+  CPPUNIT_ASSERT(!PGN("[White \"unterminated]").valid());
+}
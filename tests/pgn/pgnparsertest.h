@@ -0,0 +1,33 @@
+#ifndef PGNPARSERTEST_H
+#define PGNPARSERTEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestResult.h>
+#include <cppunit/TestFixture.h>
+#include <cppunit/TestAssert.h>
+
+class PGNParserTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(PGNParserTest);
+  CPPUNIT_TEST(test_tags);
+  CPPUNIT_TEST(test_numbers);
+  CPPUNIT_TEST(test_variations);
+  CPPUNIT_TEST(test_comments);
+  CPPUNIT_TEST(test_annotations);
+  CPPUNIT_TEST(test_result);
+  CPPUNIT_TEST(test_error);
+  CPPUNIT_TEST_SUITE_END();
+public:
+  void setUp() { }
+  void tearDown() { }
+
+  void test_tags();
+  void test_numbers();
+  void test_variations();
+  void test_comments();
+  void test_annotations();
+  void test_result();
+  void test_error();
+};
+
+#endif // PGNPARSERTEST_H